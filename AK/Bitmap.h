@@ -159,6 +159,21 @@ public:
         return {};
     }
 
+    // Like find_first_unset(), but only looks at the bits from the given index onwards.
+    Optional<size_t> find_next_unset(size_t start) const
+    {
+        for (size_t j = start; j < m_size;) {
+            if (j % 8 == 0 && j + 8 <= m_size && m_data[j / 8] == 0xff) {
+                j += 8;
+                continue;
+            }
+            if (!get(j))
+                return j;
+            ++j;
+        }
+        return {};
+    }
+
     Optional<size_t> find_longest_range_of_unset_bits(size_t max_length, size_t& found_range_size) const
     {
         auto first_index = find_first_unset();
@@ -27,17 +27,18 @@
 #pragma once
 
 #include <AK/Assertions.h>
-#include <AK/SinglyLinkedList.h>
 #include <AK/StdLibExtras.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Traits.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
 
 namespace AK {
 
 template<typename T, typename>
 class HashTable;
 
-template<typename HashTableType, typename ElementType, typename BucketIteratorType>
+template<typename HashTableType, typename ElementType>
 class HashTableIterator {
 public:
     bool operator!=(const HashTableIterator& other) const
@@ -46,12 +47,11 @@ public:
             return false;
         return &m_table != &other.m_table
             || m_is_end != other.m_is_end
-            || m_bucket_index != other.m_bucket_index
-            || m_bucket_iterator != other.m_bucket_iterator;
+            || m_bucket_index != other.m_bucket_index;
     }
     bool operator==(const HashTableIterator& other) const { return !(*this != other); }
-    ElementType& operator*() { return *m_bucket_iterator; }
-    ElementType* operator->() { return m_bucket_iterator.operator->(); }
+    ElementType& operator*() { return *m_table.slot(m_bucket_index); }
+    ElementType* operator->() { return m_table.slot(m_bucket_index); }
     HashTableIterator& operator++()
     {
         skip_to_next();
@@ -61,17 +61,12 @@ public:
     void skip_to_next()
     {
         while (!m_is_end) {
-            if (m_bucket_iterator.is_end()) {
-                ++m_bucket_index;
-                if (m_bucket_index >= m_table.capacity()) {
-                    m_is_end = true;
-                    return;
-                }
-                m_bucket_iterator = m_table.bucket(m_bucket_index).begin();
-            } else {
-                ++m_bucket_iterator;
+            ++m_bucket_index;
+            if (m_bucket_index >= m_table.capacity()) {
+                m_is_end = true;
+                return;
             }
-            if (!m_bucket_iterator.is_end())
+            if (m_table.is_used(m_bucket_index))
                 return;
         }
     }
@@ -79,35 +74,51 @@ public:
 private:
     friend HashTableType;
 
-    explicit HashTableIterator(HashTableType& table, bool is_end, BucketIteratorType bucket_iterator = {}, size_t bucket_index = 0)
+    explicit HashTableIterator(HashTableType& table, bool is_end, size_t bucket_index = 0)
         : m_table(table)
         , m_bucket_index(bucket_index)
         , m_is_end(is_end)
-        , m_bucket_iterator(bucket_iterator)
     {
         ASSERT(!table.m_clearing);
         ASSERT(!table.m_rehashing);
-        if (!is_end && !m_table.is_empty() && m_bucket_iterator.is_end()) {
-            m_bucket_iterator = m_table.bucket(0).begin();
-            if (m_bucket_iterator.is_end())
-                skip_to_next();
-        }
+        if (!is_end && !m_table.is_used(m_bucket_index))
+            skip_to_next();
     }
 
     HashTableType& m_table;
     size_t m_bucket_index { 0 };
     bool m_is_end { false };
-    BucketIteratorType m_bucket_iterator;
 };
 
+// HashTable is an open-addressing hash table using Robin Hood hashing.
+//
+// Entries are stored inline in a power-of-two sized bucket array. Next to it
+// we keep one metadata byte per bucket: 0 means the bucket is free, otherwise
+// it's 1 + the distance of the entry from its home bucket (saturating, see
+// probe_distance()). Lookups can stop as soon as they see an entry that is
+// closer to its home than the probe, and removal shifts the following entries
+// back one step instead of leaving tombstones behind.
+//
+// NOTE: Unlike the old chained implementation, inserting or removing entries
+//       may move other entries around, so pointers/references into the table
+//       don't survive mutation.
 template<typename T, typename TraitsForT>
 class HashTable {
 private:
-    using Bucket = SinglyLinkedList<T>;
+    struct Bucket {
+        alignas(T) u8 storage[sizeof(T)];
+    };
+
+    static constexpr u8 free_bucket = 0;
+    static constexpr u8 saturated_distance = 0xff;
+    static constexpr size_t minimum_capacity = 8;
 
 public:
+    static constexpr size_t default_max_load_factor_percent = 80;
+
     HashTable() {}
     HashTable(const HashTable& other)
+        : m_max_load_factor_percent(other.m_max_load_factor_percent)
     {
         ensure_capacity(other.size());
         for (auto& it : other)
@@ -117,6 +128,7 @@ public:
     {
         if (this != &other) {
             clear();
+            m_max_load_factor_percent = other.m_max_load_factor_percent;
             ensure_capacity(other.size());
             for (auto& it : other)
                 set(it);
@@ -125,23 +137,29 @@ public:
     }
     HashTable(HashTable&& other)
         : m_buckets(other.m_buckets)
+        , m_metadata(other.m_metadata)
         , m_size(other.m_size)
         , m_capacity(other.m_capacity)
+        , m_max_load_factor_percent(other.m_max_load_factor_percent)
     {
         other.m_size = 0;
         other.m_capacity = 0;
         other.m_buckets = nullptr;
+        other.m_metadata = nullptr;
     }
     HashTable& operator=(HashTable&& other)
     {
         if (this != &other) {
             clear();
             m_buckets = other.m_buckets;
+            m_metadata = other.m_metadata;
             m_size = other.m_size;
             m_capacity = other.m_capacity;
+            m_max_load_factor_percent = other.m_max_load_factor_percent;
             other.m_size = 0;
             other.m_capacity = 0;
             other.m_buckets = nullptr;
+            other.m_metadata = nullptr;
         }
         return *this;
     }
@@ -151,10 +169,20 @@ public:
     size_t size() const { return m_size; }
     size_t capacity() const { return m_capacity; }
 
+    size_t max_load_factor_percent() const { return m_max_load_factor_percent; }
+    void set_max_load_factor_percent(size_t percent)
+    {
+        ASSERT(percent >= 10 && percent <= 95);
+        m_max_load_factor_percent = percent;
+        if (needs_to_grow_for(m_size))
+            rehash(m_size);
+    }
+
     void ensure_capacity(size_t capacity)
     {
         ASSERT(capacity >= size());
-        rehash(capacity);
+        if (needs_to_grow_for(capacity))
+            rehash(capacity);
     }
 
     void set(const T&);
@@ -162,12 +190,12 @@ public:
     bool contains(const T&) const;
     void clear();
 
-    using Iterator = HashTableIterator<HashTable, T, typename Bucket::Iterator>;
+    using Iterator = HashTableIterator<HashTable, T>;
     friend Iterator;
     Iterator begin() { return Iterator(*this, is_empty()); }
     Iterator end() { return Iterator(*this, true); }
 
-    using ConstIterator = HashTableIterator<const HashTable, const T, typename Bucket::ConstIterator>;
+    using ConstIterator = HashTableIterator<const HashTable, const T>;
     friend ConstIterator;
     ConstIterator begin() const { return ConstIterator(*this, is_empty()); }
     ConstIterator end() const { return ConstIterator(*this, true); }
@@ -175,27 +203,19 @@ public:
     template<typename Finder>
     Iterator find(unsigned hash, Finder finder)
     {
-        if (is_empty())
+        auto bucket_index = lookup_with_hash(hash, finder);
+        if (bucket_index == m_capacity)
             return end();
-        size_t bucket_index;
-        auto& bucket = lookup_with_hash(hash, &bucket_index);
-        auto bucket_iterator = bucket.find(finder);
-        if (bucket_iterator != bucket.end())
-            return Iterator(*this, false, bucket_iterator, bucket_index);
-        return end();
+        return Iterator(*this, false, bucket_index);
     }
 
     template<typename Finder>
     ConstIterator find(unsigned hash, Finder finder) const
     {
-        if (is_empty())
+        auto bucket_index = lookup_with_hash(hash, finder);
+        if (bucket_index == m_capacity)
             return end();
-        size_t bucket_index;
-        auto& bucket = lookup_with_hash(hash, &bucket_index);
-        auto bucket_iterator = bucket.find(finder);
-        if (bucket_iterator != bucket.end())
-            return ConstIterator(*this, false, bucket_iterator, bucket_index);
-        return end();
+        return ConstIterator(*this, false, bucket_index);
     }
 
     Iterator find(const T& value)
@@ -218,34 +238,61 @@ public:
     void remove(Iterator);
 
 private:
-    Bucket& lookup(const T&, size_t* bucket_index = nullptr);
-    const Bucket& lookup(const T&, size_t* bucket_index = nullptr) const;
+    T* slot(size_t index) { return reinterpret_cast<T*>(m_buckets[index].storage); }
+    const T* slot(size_t index) const { return reinterpret_cast<const T*>(m_buckets[index].storage); }
+    bool is_used(size_t index) const { return index < m_capacity && m_metadata[index] != free_bucket; }
+
+    size_t home_index(unsigned hash) const { return hash & (m_capacity - 1); }
+
+    bool needs_to_grow_for(size_t entry_count) const
+    {
+        return entry_count * 100 > m_capacity * m_max_load_factor_percent;
+    }
 
-    Bucket& lookup_with_hash(unsigned hash, size_t* bucket_index)
+    static u8 metadata_for_distance(size_t distance)
     {
-        if (bucket_index)
-            *bucket_index = hash % m_capacity;
-        return m_buckets[hash % m_capacity];
+        if (distance + 1 >= saturated_distance)
+            return saturated_distance;
+        return distance + 1;
     }
 
-    const Bucket& lookup_with_hash(unsigned hash, size_t* bucket_index) const
+    // Distances too large to fit in the metadata byte are recomputed from the hash.
+    size_t probe_distance(size_t index) const
     {
-        if (bucket_index)
-            *bucket_index = hash % m_capacity;
-        return m_buckets[hash % m_capacity];
+        u8 metadata = m_metadata[index];
+        ASSERT(metadata != free_bucket);
+        if (metadata != saturated_distance)
+            return metadata - 1;
+        return (index - home_index(TraitsForT::hash(*slot(index)))) & (m_capacity - 1);
+    }
+
+    template<typename Finder>
+    size_t lookup_with_hash(unsigned hash, Finder& finder) const
+    {
+        if (is_empty())
+            return m_capacity;
+        size_t index = home_index(hash);
+        for (size_t distance = 0; distance < m_capacity; ++distance) {
+            if (m_metadata[index] == free_bucket)
+                return m_capacity;
+            if (probe_distance(index) < distance)
+                return m_capacity;
+            if (finder(*slot(index)))
+                return index;
+            index = (index + 1) & (m_capacity - 1);
+        }
+        return m_capacity;
     }
 
     void rehash(size_t capacity);
-    void insert(const T&);
     void insert(T&&);
 
-    Bucket& bucket(size_t index) { return m_buckets[index]; }
-    const Bucket& bucket(size_t index) const { return m_buckets[index]; }
-
     Bucket* m_buckets { nullptr };
+    u8* m_metadata { nullptr };
 
     size_t m_size { 0 };
     size_t m_capacity { 0 };
+    size_t m_max_load_factor_percent { default_max_load_factor_percent };
     bool m_clearing { false };
     bool m_rehashing { false };
 };
@@ -253,63 +300,59 @@ private:
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::set(T&& value)
 {
-    if (!m_capacity)
-        rehash(1);
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value)) {
-            e = move(value);
-            return;
-        }
-    }
-    if (size() >= capacity()) {
-        rehash(size() + 1);
-        insert(move(value));
-    } else {
-        bucket.append(move(value));
+    auto it = find(value);
+    if (it != end()) {
+        *it = move(value);
+        return;
     }
+    if (needs_to_grow_for(m_size + 1))
+        rehash(m_size + 1);
+    insert(move(value));
     m_size++;
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::set(const T& value)
 {
-    if (!m_capacity)
-        rehash(1);
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value)) {
-            e = value;
-            return;
-        }
-    }
-    if (size() >= capacity()) {
-        rehash(size() + 1);
-        insert(value);
-    } else {
-        bucket.append(value);
+    auto it = find(value);
+    if (it != end()) {
+        *it = value;
+        return;
     }
+    if (needs_to_grow_for(m_size + 1))
+        rehash(m_size + 1);
+    T copy(value);
+    insert(move(copy));
     m_size++;
 }
 
 template<typename T, typename TraitsForT>
-void HashTable<T, TraitsForT>::rehash(size_t new_capacity)
+void HashTable<T, TraitsForT>::rehash(size_t capacity)
 {
     TemporaryChange<bool> change(m_rehashing, true);
-    new_capacity *= 2;
-    auto* new_buckets = new Bucket[new_capacity];
+    size_t new_capacity = minimum_capacity;
+    while (capacity * 100 > new_capacity * m_max_load_factor_percent)
+        new_capacity *= 2;
+
     auto* old_buckets = m_buckets;
+    auto* old_metadata = m_metadata;
     size_t old_capacity = m_capacity;
-    m_buckets = new_buckets;
+
+    // The buckets and their metadata bytes share a single allocation.
+    m_buckets = (Bucket*)kmalloc(new_capacity * (sizeof(Bucket) + 1));
+    m_metadata = reinterpret_cast<u8*>(m_buckets + new_capacity);
+    __builtin_memset(m_metadata, free_bucket, new_capacity);
     m_capacity = new_capacity;
 
     for (size_t i = 0; i < old_capacity; ++i) {
-        for (auto& value : old_buckets[i]) {
-            insert(move(value));
-        }
+        if (old_metadata[i] == free_bucket)
+            continue;
+        auto* value = reinterpret_cast<T*>(old_buckets[i].storage);
+        insert(move(*value));
+        value->~T();
     }
 
-    delete[] old_buckets;
+    kfree(old_buckets);
 }
 
 template<typename T, typename TraitsForT>
@@ -317,8 +360,13 @@ void HashTable<T, TraitsForT>::clear()
 {
     TemporaryChange<bool> change(m_clearing, true);
     if (m_buckets) {
-        delete[] m_buckets;
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_metadata[i] != free_bucket)
+                slot(i)->~T();
+        }
+        kfree(m_buckets);
         m_buckets = nullptr;
+        m_metadata = nullptr;
     }
     m_capacity = 0;
     m_size = 0;
@@ -327,54 +375,57 @@ void HashTable<T, TraitsForT>::clear()
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::insert(T&& value)
 {
-    auto& bucket = lookup(value);
-    bucket.append(move(value));
-}
-
-template<typename T, typename TraitsForT>
-void HashTable<T, TraitsForT>::insert(const T& value)
-{
-    auto& bucket = lookup(value);
-    bucket.append(value);
+    // Walk forward from the home bucket, and whenever we meet an entry that is
+    // closer to its own home than we are to ours, take its place and carry it on.
+    size_t index = home_index(TraitsForT::hash(value));
+    size_t distance = 0;
+    for (;;) {
+        if (m_metadata[index] == free_bucket) {
+            new (slot(index)) T(move(value));
+            m_metadata[index] = metadata_for_distance(distance);
+            return;
+        }
+        size_t existing_distance = probe_distance(index);
+        if (existing_distance < distance) {
+            swap(*slot(index), value);
+            m_metadata[index] = metadata_for_distance(distance);
+            distance = existing_distance;
+        }
+        index = (index + 1) & (m_capacity - 1);
+        ++distance;
+    }
 }
 
 template<typename T, typename TraitsForT>
 bool HashTable<T, TraitsForT>::contains(const T& value) const
 {
-    if (is_empty())
-        return false;
-    auto& bucket = lookup(value);
-    for (auto& e : bucket) {
-        if (TraitsForT::equals(e, value))
-            return true;
-    }
-    return false;
+    return find(value) != end();
 }
 
 template<typename T, typename TraitsForT>
 void HashTable<T, TraitsForT>::remove(Iterator it)
 {
     ASSERT(!is_empty());
-    m_buckets[it.m_bucket_index].remove(it.m_bucket_iterator);
-    --m_size;
-}
-
-template<typename T, typename TraitsForT>
-auto HashTable<T, TraitsForT>::lookup(const T& value, size_t* bucket_index) -> Bucket&
-{
-    unsigned hash = TraitsForT::hash(value);
-    if (bucket_index)
-        *bucket_index = hash % m_capacity;
-    return m_buckets[hash % m_capacity];
-}
+    size_t index = it.m_bucket_index;
+    ASSERT(is_used(index));
+    slot(index)->~T();
+    m_metadata[index] = free_bucket;
+
+    // Shift the following run of displaced entries one step back towards home.
+    size_t next_index = (index + 1) & (m_capacity - 1);
+    while (m_metadata[next_index] != free_bucket) {
+        size_t distance = probe_distance(next_index);
+        if (distance == 0)
+            break;
+        new (slot(index)) T(move(*slot(next_index)));
+        slot(next_index)->~T();
+        m_metadata[index] = metadata_for_distance(distance - 1);
+        m_metadata[next_index] = free_bucket;
+        index = next_index;
+        next_index = (next_index + 1) & (m_capacity - 1);
+    }
 
-template<typename T, typename TraitsForT>
-auto HashTable<T, TraitsForT>::lookup(const T& value, size_t* bucket_index) const -> const Bucket&
-{
-    unsigned hash = TraitsForT::hash(value);
-    if (bucket_index)
-        *bucket_index = hash % m_capacity;
-    return m_buckets[hash % m_capacity];
+    --m_size;
 }
 
 }
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NetworkOrdered.h>
+#include <AK/Platform.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// The internet checksum (RFC 1071), accumulated over any number of pieces, like a pseudo-header followed by the packet it covers.
+// The ones' complement sum doesn't care about byte order or word size, so the data is summed 32 bits at a time as it is in memory
+// (or 16 bytes at a time with SSE2), and the carries are only folded back in at the end.
+class InternetChecksum {
+public:
+    void add(const void* data, size_t size)
+    {
+        auto* bytes = (const u8*)data;
+        if (!size)
+            return;
+        if (m_odd) {
+            // The previous piece ended halfway through a word.
+            m_sum += (u32)(*bytes++ << 8);
+            --size;
+            m_odd = false;
+        }
+#if ARCH(I386) || ARCH(X86_64)
+        if (size >= sse2_threshold && has_sse2()) {
+            size_t blocks = size / sse2_block_size;
+            m_sum += sum_with_sse2(bytes, nullptr, blocks);
+            bytes += blocks * sse2_block_size;
+            size -= blocks * sse2_block_size;
+        }
+#endif
+        for (; size >= 16; bytes += 16, size -= 16)
+            m_sum += (u64)read_u32(bytes) + read_u32(bytes + 4) + read_u32(bytes + 8) + read_u32(bytes + 12);
+        for (; size >= 4; bytes += 4, size -= 4)
+            m_sum += read_u32(bytes);
+        add_tail(bytes, size);
+    }
+
+    // Copies the data and sums it in the same pass, so that data coming from userspace only has to be read once.
+    void add_while_copying(void* destination, const void* source, size_t size)
+    {
+        auto* out = (u8*)destination;
+        auto* in = (const u8*)source;
+        if (!size)
+            return;
+        if (m_odd) {
+            *out++ = *in;
+            m_sum += (u32)(*in++ << 8);
+            --size;
+            m_odd = false;
+        }
+#if ARCH(I386) || ARCH(X86_64)
+        if (size >= sse2_threshold && has_sse2()) {
+            size_t blocks = size / sse2_block_size;
+            m_sum += sum_with_sse2(in, out, blocks);
+            in += blocks * sse2_block_size;
+            out += blocks * sse2_block_size;
+            size -= blocks * sse2_block_size;
+        }
+#endif
+        for (; size >= 16; in += 16, out += 16, size -= 16) {
+            u32 words[4] = { read_u32(in), read_u32(in + 4), read_u32(in + 8), read_u32(in + 12) };
+            __builtin_memcpy(out, words, sizeof(words));
+            m_sum += (u64)words[0] + words[1] + words[2] + words[3];
+        }
+        for (; size >= 4; in += 4, out += 4, size -= 4) {
+            u32 word = read_u32(in);
+            __builtin_memcpy(out, &word, sizeof(word));
+            m_sum += word;
+        }
+        for (size_t i = 0; i < size; ++i)
+            out[i] = in[i];
+        add_tail(out, size);
+    }
+
+    NetworkOrdered<u16> finish() const
+    {
+        u64 sum = m_sum;
+        while (sum >> 16)
+            sum = (sum & 0xffff) + (sum >> 16);
+        return convert_between_host_and_network((u16)~sum);
+    }
+
+private:
+    static u32 read_u32(const u8* bytes)
+    {
+        u32 word;
+        __builtin_memcpy(&word, bytes, sizeof(word));
+        return word;
+    }
+
+    void add_tail(const u8* bytes, size_t size)
+    {
+        if (size >= 2) {
+            u16 word;
+            __builtin_memcpy(&word, bytes, sizeof(word));
+            m_sum += word;
+            bytes += 2;
+            size -= 2;
+        }
+        if (size) {
+            m_sum += *bytes;
+            m_odd = true;
+        }
+    }
+
+#if ARCH(I386) || ARCH(X86_64)
+    static constexpr size_t sse2_block_size = 32;
+    // Below this, saving and restoring the SSE registers costs more than it saves.
+    static constexpr size_t sse2_threshold = 256;
+
+    static bool has_sse2()
+    {
+        static int s_has_sse2 = -1;
+        if (s_has_sse2 < 0) {
+            u32 eax = 1, ebx, ecx = 0, edx;
+            asm volatile("cpuid"
+                         : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+            s_has_sse2 = (edx & (1 << 26)) != 0;
+        }
+        return s_has_sse2;
+    }
+
+    // Widens each 32-bit word to 64 bits and adds them up in two accumulators of two lanes each, copying the data on the way if asked to.
+    // The kernel is built without SSE and doesn't expect anyone to touch these registers (while userspace code
+    // around us may have live values in them), so the ones used here are saved and restored around the loop.
+    static u64 sum_with_sse2(const u8* data, u8* copy, size_t blocks)
+    {
+        // xmm0-xmm5, and then the two lanes of the result.
+        u64 scratch[14];
+        asm volatile(
+            "movdqu %%xmm0, 0(%[scratch])\n"
+            "movdqu %%xmm1, 16(%[scratch])\n"
+            "movdqu %%xmm2, 32(%[scratch])\n"
+            "movdqu %%xmm3, 48(%[scratch])\n"
+            "movdqu %%xmm4, 64(%[scratch])\n"
+            "movdqu %%xmm5, 80(%[scratch])\n"
+            "pxor %%xmm0, %%xmm0\n"
+            "pxor %%xmm1, %%xmm1\n"
+            "pxor %%xmm2, %%xmm2\n"
+            "1:\n"
+            "movdqu 0(%[data]), %%xmm3\n"
+            "movdqu 16(%[data]), %%xmm5\n"
+            "test %[copy], %[copy]\n"
+            "jz 2f\n"
+            "movdqu %%xmm3, 0(%[copy])\n"
+            "movdqu %%xmm5, 16(%[copy])\n"
+            "add $32, %[copy]\n"
+            "2:\n"
+            "movdqa %%xmm3, %%xmm4\n"
+            "punpckldq %%xmm2, %%xmm3\n"
+            "punpckhdq %%xmm2, %%xmm4\n"
+            "paddq %%xmm3, %%xmm0\n"
+            "paddq %%xmm4, %%xmm1\n"
+            "movdqa %%xmm5, %%xmm4\n"
+            "punpckldq %%xmm2, %%xmm5\n"
+            "punpckhdq %%xmm2, %%xmm4\n"
+            "paddq %%xmm5, %%xmm0\n"
+            "paddq %%xmm4, %%xmm1\n"
+            "add $32, %[data]\n"
+            "dec %[blocks]\n"
+            "jnz 1b\n"
+            "paddq %%xmm1, %%xmm0\n"
+            "movdqu %%xmm0, 96(%[scratch])\n"
+            "movdqu 0(%[scratch]), %%xmm0\n"
+            "movdqu 16(%[scratch]), %%xmm1\n"
+            "movdqu 32(%[scratch]), %%xmm2\n"
+            "movdqu 48(%[scratch]), %%xmm3\n"
+            "movdqu 64(%[scratch]), %%xmm4\n"
+            "movdqu 80(%[scratch]), %%xmm5\n"
+            : [data] "+r"(data), [copy] "+r"(copy), [blocks] "+r"(blocks)
+            : [scratch] "r"(scratch)
+            : "memory", "cc");
+        return scratch[12] + scratch[13];
+    }
+#endif
+
+    u64 m_sum { 0 };
+    bool m_odd { false };
+};
+
+}
+
+using AK::InternetChecksum;
@@ -29,6 +29,7 @@
 #include <AK/Forward.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringUtils.h>
+#include <AK/Traits.h>
 
 namespace AK {
 
@@ -148,6 +149,11 @@ private:
     size_t m_length { 0 };
 };
 
+template<>
+struct Traits<StringView> : public GenericTraits<StringView> {
+    static unsigned hash(const StringView& s) { return s.hash(); }
+};
+
 }
 
 using AK::StringView;
@@ -131,4 +131,40 @@ TEST_CASE(hashmap_of_nonnullownptr_get)
     EXPECT_EQ(objects.size(), 3u);
 }
 
+TEST_CASE(remove_and_reinsert)
+{
+    HashMap<int, String> number_to_string;
+    for (int i = 0; i < 1000; ++i)
+        number_to_string.set(i, String::number(i));
+    for (int i = 0; i < 1000; i += 3)
+        number_to_string.remove(i);
+    for (int i = 0; i < 1000; ++i) {
+        auto value = number_to_string.get(i);
+        EXPECT_EQ(value.has_value(), i % 3 != 0);
+        if (value.has_value())
+            EXPECT_EQ(value.value(), String::number(i));
+    }
+    for (int i = 0; i < 1000; i += 3)
+        number_to_string.set(i, String::number(i));
+    EXPECT_EQ(number_to_string.size(), 1000u);
+}
+
+BENCHMARK_CASE(hashmap_insert_lookup_strings)
+{
+    Vector<String> keys;
+    for (int i = 0; i < 50000; ++i)
+        keys.append(String::format("key%d", i));
+    for (int round = 0; round < 10; ++round) {
+        HashMap<String, int> map;
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.set(keys[i], i);
+        size_t found = 0;
+        for (auto& key : keys) {
+            if (map.contains(key))
+                ++found;
+        }
+        EXPECT_EQ(found, keys.size());
+    }
+}
+
 TEST_MAIN(HashMap)
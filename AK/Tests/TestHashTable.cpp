@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/HashTable.h>
+#include <AK/String.h>
+
+TEST_CASE(construct)
+{
+    typedef HashTable<int> IntTable;
+    EXPECT(IntTable().is_empty());
+    EXPECT_EQ(IntTable().size(), 0u);
+}
+
+TEST_CASE(populate)
+{
+    HashTable<String> strings;
+    strings.set("One");
+    strings.set("Two");
+    strings.set("Three");
+
+    EXPECT_EQ(strings.is_empty(), false);
+    EXPECT_EQ(strings.size(), 3u);
+}
+
+TEST_CASE(set_existing_does_not_grow)
+{
+    HashTable<String> strings;
+    strings.set("One");
+    strings.set("One");
+    EXPECT_EQ(strings.size(), 1u);
+}
+
+TEST_CASE(many_values)
+{
+    HashTable<int> ints;
+    for (int i = 0; i < 10000; ++i)
+        ints.set(i);
+    EXPECT_EQ(ints.size(), 10000u);
+    EXPECT(ints.size() * 100 <= ints.capacity() * ints.max_load_factor_percent());
+    for (int i = 0; i < 10000; ++i)
+        EXPECT(ints.contains(i));
+    EXPECT(!ints.contains(10000));
+
+    size_t iterated = 0;
+    for (auto& it : ints) {
+        EXPECT(it >= 0 && it < 10000);
+        ++iterated;
+    }
+    EXPECT_EQ(iterated, 10000u);
+}
+
+TEST_CASE(remove_keeps_collision_chains_intact)
+{
+    struct CollidingTraits : public GenericTraits<int> {
+        static unsigned hash(int) { return 7; }
+    };
+
+    HashTable<int, CollidingTraits> ints;
+    for (int i = 0; i < 300; ++i)
+        ints.set(i);
+    EXPECT_EQ(ints.size(), 300u);
+
+    for (int i = 0; i < 300; i += 2)
+        ints.remove(i);
+    EXPECT_EQ(ints.size(), 150u);
+
+    for (int i = 0; i < 300; ++i)
+        EXPECT_EQ(ints.contains(i), i % 2 == 1);
+}
+
+TEST_CASE(remove_all)
+{
+    HashTable<String> strings;
+    for (int i = 0; i < 1000; ++i)
+        strings.set(String::number(i));
+    for (int i = 0; i < 1000; ++i)
+        strings.remove(String::number(i));
+    EXPECT(strings.is_empty());
+    EXPECT(strings.begin() == strings.end());
+}
+
+TEST_CASE(max_load_factor)
+{
+    HashTable<int> ints;
+    ints.set_max_load_factor_percent(50);
+    for (int i = 0; i < 1000; ++i)
+        ints.set(i);
+    EXPECT(ints.capacity() >= 2000u);
+}
+
+TEST_CASE(copy_and_move)
+{
+    HashTable<String> strings;
+    strings.set("One");
+    strings.set("Two");
+
+    auto copy = strings;
+    EXPECT_EQ(copy.size(), 2u);
+    EXPECT(copy.contains("One"));
+
+    auto moved = move(strings);
+    EXPECT_EQ(moved.size(), 2u);
+    EXPECT(moved.contains("Two"));
+    EXPECT(strings.is_empty());
+}
+
+BENCHMARK_CASE(hashtable_insert)
+{
+    for (int round = 0; round < 10; ++round) {
+        HashTable<int> ints;
+        for (int i = 0; i < 100000; ++i)
+            ints.set(i);
+        EXPECT_EQ(ints.size(), 100000u);
+    }
+}
+
+BENCHMARK_CASE(hashtable_lookup)
+{
+    HashTable<int> ints;
+    for (int i = 0; i < 100000; ++i)
+        ints.set(i);
+    size_t found = 0;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 200000; ++i) {
+            if (ints.contains(i))
+                ++found;
+        }
+    }
+    EXPECT_EQ(found, 1000000u);
+}
+
+BENCHMARK_CASE(hashtable_iterate)
+{
+    HashTable<int> ints;
+    for (int i = 0; i < 100000; ++i)
+        ints.set(i);
+    u64 sum = 0;
+    for (int round = 0; round < 100; ++round) {
+        for (auto& it : ints)
+            sum += it;
+    }
+    EXPECT_EQ(sum, 100ull * (99999ull * 100000ull / 2));
+}
+
+BENCHMARK_CASE(hashtable_insert_remove_strings)
+{
+    Vector<String> strings;
+    for (int i = 0; i < 50000; ++i)
+        strings.append(String::format("string%d", i));
+    for (int round = 0; round < 10; ++round) {
+        HashTable<String> table;
+        for (auto& string : strings)
+            table.set(string);
+        for (auto& string : strings)
+            table.remove(string);
+        EXPECT(table.is_empty());
+    }
+}
+
+TEST_MAIN(HashTable)
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/InternetChecksum.h>
+#include <AK/Vector.h>
+
+static u16 reference_checksum(const u8* data, size_t size)
+{
+    u32 sum = 0;
+    for (size_t i = 0; i < size; i += 2) {
+        u16 word = data[i] << 8;
+        if (i + 1 < size)
+            word |= data[i + 1];
+        sum += word;
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return ~sum;
+}
+
+static Vector<u8> make_data(size_t size, u32 seed)
+{
+    Vector<u8> data;
+    data.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        data[i] = seed;
+    }
+    return data;
+}
+
+TEST_CASE(rfc1071_example)
+{
+    const u8 data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+    InternetChecksum checksum;
+    checksum.add(data, sizeof(data));
+    EXPECT_EQ((u16)checksum.finish(), 0x220d);
+}
+
+TEST_CASE(empty)
+{
+    InternetChecksum checksum;
+    checksum.add(nullptr, 0);
+    EXPECT_EQ((u16)checksum.finish(), 0xffff);
+}
+
+TEST_CASE(sizes_and_alignments)
+{
+    auto data = make_data(70000, 1);
+    size_t sizes[] = { 1, 2, 3, 4, 5, 15, 16, 17, 31, 32, 33, 255, 256, 257, 287, 288, 1500, 1501, 65535, 65536, 69996 };
+    for (size_t offset = 0; offset < 4; ++offset) {
+        for (auto size : sizes) {
+            InternetChecksum checksum;
+            checksum.add(data.data() + offset, size);
+            EXPECT_EQ((u16)checksum.finish(), reference_checksum(data.data() + offset, size));
+        }
+    }
+}
+
+TEST_CASE(all_ones)
+{
+    // Lots of carries.
+    Vector<u8> data;
+    data.resize(65536);
+    for (auto& byte : data)
+        byte = 0xff;
+    InternetChecksum checksum;
+    checksum.add(data.data(), data.size());
+    EXPECT_EQ((u16)checksum.finish(), reference_checksum(data.data(), data.size()));
+}
+
+TEST_CASE(pieces)
+{
+    auto data = make_data(4000, 2);
+    for (size_t first = 0; first < 300; first += 7) {
+        for (size_t second = 0; second < 700; second += 61) {
+            InternetChecksum checksum;
+            checksum.add(data.data(), first);
+            checksum.add(data.data() + first, second);
+            checksum.add(data.data() + first + second, data.size() - first - second);
+            EXPECT_EQ((u16)checksum.finish(), reference_checksum(data.data(), data.size()));
+        }
+    }
+}
+
+TEST_CASE(add_while_copying)
+{
+    auto data = make_data(3000, 3);
+    for (size_t split = 0; split < 40; ++split) {
+        Vector<u8> copy;
+        copy.resize(data.size());
+        InternetChecksum checksum;
+        checksum.add_while_copying(copy.data(), data.data(), split);
+        checksum.add(data.data() + split, 11);
+        memcpy(copy.data() + split, data.data() + split, 11);
+        checksum.add_while_copying(copy.data() + split + 11, data.data() + split + 11, data.size() - split - 11);
+        EXPECT_EQ((u16)checksum.finish(), reference_checksum(data.data(), data.size()));
+        EXPECT(!memcmp(copy.data(), data.data(), data.size()));
+    }
+}
+
+static void benchmark_checksum(size_t size, int iterations)
+{
+    auto data = make_data(size, 4);
+    u16 expected = reference_checksum(data.data(), data.size());
+    for (int i = 0; i < iterations; ++i) {
+        InternetChecksum checksum;
+        checksum.add(data.data(), data.size());
+        EXPECT_EQ((u16)checksum.finish(), expected);
+    }
+}
+
+static void benchmark_checksum_while_copying(size_t size, int iterations)
+{
+    auto data = make_data(size, 5);
+    Vector<u8> copy;
+    copy.resize(size);
+    u16 expected = reference_checksum(data.data(), data.size());
+    for (int i = 0; i < iterations; ++i) {
+        InternetChecksum checksum;
+        checksum.add_while_copying(copy.data(), data.data(), data.size());
+        EXPECT_EQ((u16)checksum.finish(), expected);
+    }
+}
+
+BENCHMARK_CASE(checksum_1500_bytes)
+{
+    benchmark_checksum(1500, 1000000);
+}
+
+BENCHMARK_CASE(checksum_64_kib)
+{
+    benchmark_checksum(64 * KB, 20000);
+}
+
+BENCHMARK_CASE(checksum_while_copying_1500_bytes)
+{
+    benchmark_checksum_while_copying(1500, 1000000);
+}
+
+BENCHMARK_CASE(checksum_while_copying_64_kib)
+{
+    benchmark_checksum_while_copying(64 * KB, 20000);
+}
+
+TEST_MAIN(InternetChecksum)
@@ -26,6 +26,7 @@
 
 #include <AK/TestSuite.h>
 
+#include <AK/HashMap.h>
 #include <AK/String.h>
 
 TEST_CASE(construct_empty)
@@ -111,4 +112,17 @@ TEST_CASE(lines)
     EXPECT_EQ(test_string_vector.at(2).is_empty(), true);
 }
 
+TEST_CASE(hash_map_key)
+{
+    HashMap<StringView, int> map;
+    map.set("let", 1);
+    map.set("const", 2);
+
+    String source = "let x = 1; const y = 2;";
+    EXPECT_EQ(map.get(source.substring_view(0, 3)).value_or(0), 1);
+    EXPECT_EQ(map.get(source.substring_view(11, 5)).value_or(0), 2);
+    EXPECT(!map.get(source.substring_view(4, 1)).has_value());
+    EXPECT_EQ(map.get(String("const")).value_or(0), 2);
+}
+
 TEST_MAIN(StringView)
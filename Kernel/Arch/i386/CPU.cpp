@@ -375,6 +375,11 @@ void gdt_init()
     write_raw_gdt_entry(0x0018, 0x0000ffff, 0x00cffa00);
     write_raw_gdt_entry(0x0020, 0x0000ffff, 0x00cff200);
 
+    gdt_load();
+}
+
+void gdt_load()
+{
     flush_gdt();
 
     asm volatile(
@@ -249,6 +249,7 @@ class GenericInterruptHandler;
 struct RegisterState;
 
 void gdt_init();
+void gdt_load();
 void idt_init();
 void sse_init();
 void register_interrupt_handler(u8 number, void (*f)());
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringView.h>
+#include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Arch/i386/Processor.h>
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+// NOTE: These have no constructors on purpose, since Processors are set up
+//       before the kernel's global constructors run.
+Processor* Processor::s_processors[max_count];
+size_t Processor::s_count;
+
+static constexpr size_t idle_stack_size = 16 * KB;
+
+Processor::Processor(u32 id, u8 apic_id)
+    : m_id(id)
+    , m_apic_id(apic_id)
+{
+}
+
+Processor::~Processor()
+{
+}
+
+void Processor::initialize_bsp()
+{
+    ASSERT(!s_count);
+    // The initial APIC ID, as assigned by the hardware at reset.
+    CPUID processor_info(0x1);
+    auto* processor = new Processor(0, processor_info.ebx() >> 24);
+    processor->m_online.store(true, AK::memory_order_release);
+    s_processors[s_count++] = processor;
+}
+
+Processor* Processor::create_ap(u8 apic_id)
+{
+    ASSERT(s_count);
+    if (s_count == max_count) {
+        klog() << "Processor: Ignoring CPU with APIC ID " << (u32)apic_id << ", at most " << max_count << " are supported";
+        return nullptr;
+    }
+    auto* processor = new Processor(s_count, apic_id);
+    processor->m_idle_stack = MM.allocate_kernel_region(idle_stack_size, "AP idle stack", Region::Access::Read | Region::Access::Write, false, true);
+    if (!processor->m_idle_stack) {
+        delete processor;
+        return nullptr;
+    }
+    s_processors[s_count++] = processor;
+    return processor;
+}
+
+Processor& Processor::current()
+{
+    if (s_count == 1)
+        return bsp();
+    u8 apic_id = APIC::current_id();
+    for (size_t i = 0; i < s_count; ++i) {
+        if (s_processors[i]->m_apic_id == apic_id)
+            return *s_processors[i];
+    }
+    ASSERT_NOT_REACHED();
+}
+
+size_t Processor::online_count()
+{
+    size_t count = 0;
+    for_each([&](const Processor& processor) {
+        if (processor.is_online())
+            ++count;
+    });
+    return count;
+}
+
+VirtualAddress Processor::idle_stack_top() const
+{
+    ASSERT(m_idle_stack);
+    return m_idle_stack->vaddr().offset(m_idle_stack->size());
+}
+
+void Processor::initialize_ap()
+{
+    ASSERT(!is_bsp());
+    ASSERT_INTERRUPTS_DISABLED();
+
+    // Switch from the startup code's temporary GDT to the kernel's, and share the IDT.
+    gdt_load();
+    flush_idt();
+
+    APIC::enable(m_id);
+    m_online.store(true, AK::memory_order_release);
+
+    idle_loop();
+}
+
+void Processor::idle_loop()
+{
+    // FIXME: The scheduler and most of the kernel still assume that nothing else runs
+    //        while interrupts are disabled on the BSP, so APs don't take interrupts or
+    //        run threads yet. They just stay parked here.
+    for (;;)
+        asm volatile("cli; hlt");
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <LibBareMetal/Memory/VirtualAddress.h>
+
+namespace Kernel {
+
+class Region;
+
+// Per-CPU data. There is one Processor for the bootstrap processor (BSP), plus one
+// for each application processor (AP) listed in the ACPI MADT when booting with smp=on.
+// APs only get as far as their idle loop: threads are still scheduled on the BSP alone,
+// since Thread::current, the TSS and the run queues are global and most of the kernel
+// relies on InterruptDisabler for mutual exclusion.
+class Processor {
+    AK_MAKE_NONCOPYABLE(Processor);
+    AK_MAKE_NONMOVABLE(Processor);
+
+public:
+    // The local APICs are set up in flat logical destination mode, which can only address 8 CPUs.
+    static constexpr size_t max_count = 8;
+
+    static void initialize_bsp();
+    static Processor* create_ap(u8 apic_id);
+
+    static Processor& current();
+    static Processor& bsp() { return *s_processors[0]; }
+    static Processor* by_id(u32 id) { return id < s_count ? s_processors[id] : nullptr; }
+    static size_t count() { return s_count; }
+    static size_t online_count();
+
+    template<typename Callback>
+    static void for_each(Callback callback)
+    {
+        for (size_t i = 0; i < s_count; ++i)
+            callback(*s_processors[i]);
+    }
+
+    ~Processor();
+
+    u32 id() const { return m_id; }
+    u8 apic_id() const { return m_apic_id; }
+    bool is_bsp() const { return m_id == 0; }
+    bool is_online() const { return m_online.load(AK::memory_order_acquire); }
+
+    // The stack an AP starts out on, and idles on once it's up.
+    VirtualAddress idle_stack_top() const;
+
+    // Called by an AP once it runs in the kernel's address space, to finish its own setup.
+    [[noreturn]] void initialize_ap();
+
+private:
+    Processor(u32 id, u8 apic_id);
+
+    [[noreturn]] void idle_loop();
+
+    static Processor* s_processors[max_count];
+    static size_t s_count;
+
+    u32 m_id { 0 };
+    u8 m_apic_id { 0 };
+    Atomic<bool> m_online { false };
+    OwnPtr<Region> m_idle_stack;
+};
+
+}
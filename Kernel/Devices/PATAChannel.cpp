@@ -165,8 +165,8 @@ void PATAChannel::initialize(bool force_pio)
     // Let's try to set up DMA transfers.
     PCI::enable_bus_mastering(pci_address());
     PCI::enable_interrupt_line(pci_address());
-    prdt().end_of_table = 0x8000;
-    m_dma_buffer_page = MM.allocate_supervisor_physical_page();
+    for (size_t i = 0; i < max_dma_buffer_pages; ++i)
+        m_dma_buffer_pages.append(MM.allocate_supervisor_physical_page().release_nonnull());
     klog() << "PATAChannel: Bus master IDE: " << m_bus_master_base;
 }
 
@@ -262,17 +262,28 @@ void PATAChannel::detect_disks()
     }
 }
 
+void PATAChannel::prepare_prdt(size_t byte_count)
+{
+    ASSERT(byte_count && byte_count <= max_dma_buffer_pages * PAGE_SIZE);
+    size_t entry_count = ceil_div(byte_count, (size_t)PAGE_SIZE);
+    for (size_t i = 0; i < entry_count; ++i) {
+        auto& entry = prdt()[i];
+        entry.offset = m_dma_buffer_pages[i].paddr();
+        entry.size = min(byte_count - i * PAGE_SIZE, (size_t)PAGE_SIZE);
+        entry.end_of_table = i == entry_count - 1 ? 0x8000 : 0;
+    }
+}
+
 bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool slave_request)
 {
+    ASSERT(count <= max_transfer_sectors);
     LOCKER(s_lock());
 #ifdef PATA_DEBUG
     dbg() << "PATAChannel::ata_read_sectors_with_dma (" << lba << " x" << count << ") -> " << outbuf;
 #endif
 
-    prdt().offset = m_dma_buffer_page->paddr();
-    prdt().size = 512 * count;
-
-    ASSERT(prdt().size <= PAGE_SIZE);
+    size_t byte_count = 512 * count;
+    prepare_prdt(byte_count);
 
     // Stop bus master
     m_bus_master_base.out<u8>(0);
@@ -299,12 +310,12 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
 
     m_io_base.offset(ATA_REG_FEATURES).out<u8>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(0);
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(MSB(count));
     m_io_base.offset(ATA_REG_LBA0).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA2).out<u8>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count);
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(LSB(count));
     m_io_base.offset(ATA_REG_LBA0).out<u8>((lba & 0x000000ff) >> 0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>((lba & 0x0000ff00) >> 8);
     m_io_base.offset(ATA_REG_LBA2).out<u8>((lba & 0x00ff0000) >> 16);
@@ -327,7 +338,8 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
     if (m_device_error)
         return false;
 
-    memcpy(outbuf, m_dma_buffer_page->paddr().offset(0xc0000000).as_ptr(), 512 * count);
+    for (size_t offset = 0; offset < byte_count; offset += PAGE_SIZE)
+        memcpy(outbuf + offset, dma_buffer(offset / PAGE_SIZE), min(byte_count - offset, (size_t)PAGE_SIZE));
 
     // I read somewhere that this may trigger a cache flush so let's do it.
     m_bus_master_base.offset(2).out<u8>(m_bus_master_base.offset(2).in<u8>() | 0x6);
@@ -336,17 +348,17 @@ bool PATAChannel::ata_read_sectors_with_dma(u32 lba, u16 count, u8* outbuf, bool
 
 bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf, bool slave_request)
 {
+    ASSERT(count <= max_transfer_sectors);
     LOCKER(s_lock());
 #ifdef PATA_DEBUG
     dbg() << "PATAChannel::ata_write_sectors_with_dma (" << lba << " x" << count << ") <- " << inbuf;
 #endif
 
-    prdt().offset = m_dma_buffer_page->paddr();
-    prdt().size = 512 * count;
-
-    memcpy(m_dma_buffer_page->paddr().offset(0xc0000000).as_ptr(), inbuf, 512 * count);
+    size_t byte_count = 512 * count;
+    prepare_prdt(byte_count);
 
-    ASSERT(prdt().size <= PAGE_SIZE);
+    for (size_t offset = 0; offset < byte_count; offset += PAGE_SIZE)
+        memcpy(dma_buffer(offset / PAGE_SIZE), inbuf + offset, min(byte_count - offset, (size_t)PAGE_SIZE));
 
     // Stop bus master
     m_bus_master_base.out<u8>(0);
@@ -370,12 +382,12 @@ bool PATAChannel::ata_write_sectors_with_dma(u32 lba, u16 count, const u8* inbuf
 
     m_io_base.offset(ATA_REG_FEATURES).out<u8>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(0);
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(MSB(count));
     m_io_base.offset(ATA_REG_LBA0).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>(0);
     m_io_base.offset(ATA_REG_LBA2).out<u8>(0);
 
-    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(count);
+    m_io_base.offset(ATA_REG_SECCOUNT0).out<u8>(LSB(count));
     m_io_base.offset(ATA_REG_LBA0).out<u8>((lba & 0x000000ff) >> 0);
     m_io_base.offset(ATA_REG_LBA1).out<u8>((lba & 0x0000ff00) >> 8);
     m_io_base.offset(ATA_REG_LBA2).out<u8>((lba & 0x00ff0000) >> 16);
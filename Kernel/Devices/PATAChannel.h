@@ -36,6 +36,7 @@
 //
 #pragma once
 
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <Kernel/Lock.h>
@@ -74,6 +75,11 @@ public:
 
     virtual const char* purpose() const override { return "PATA Channel"; }
 
+    // The largest single transfer we hand to the drive. DMA transfers are
+    // scattered over this many pages of bounce buffer, one PRD per page.
+    static constexpr size_t max_dma_buffer_pages = 16;
+    static constexpr u16 max_transfer_sectors = max_dma_buffer_pages * PAGE_SIZE / 512;
+
 private:
     //^ IRQHandler
     virtual void handle_irq(const RegisterState&) override;
@@ -88,6 +94,7 @@ private:
     bool ata_write_sectors(u32, u16, const u8*, bool);
 
     inline void prepare_for_irq();
+    void prepare_prdt(size_t byte_count);
 
     // Data members
     u8 m_channel_number { 0 }; // Channel number. 0 = master, 1 = slave
@@ -97,9 +104,10 @@ private:
 
     WaitQueue m_irq_queue;
 
-    PhysicalRegionDescriptor& prdt() { return *reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_page->paddr().offset(0xc0000000).as_ptr()); }
+    PhysicalRegionDescriptor* prdt() { return reinterpret_cast<PhysicalRegionDescriptor*>(m_prdt_page->paddr().offset(0xc0000000).as_ptr()); }
+    u8* dma_buffer(size_t page_index) { return m_dma_buffer_pages[page_index].paddr().offset(0xc0000000).as_ptr(); }
     RefPtr<PhysicalPage> m_prdt_page;
-    RefPtr<PhysicalPage> m_dma_buffer_page;
+    NonnullRefPtrVector<PhysicalPage> m_dma_buffer_pages;
     IOAddress m_bus_master_base;
     Lockable<bool> m_dma_enabled;
 
@@ -57,15 +57,32 @@ const char* PATADiskDevice::class_name() const
 
 bool PATADiskDevice::read_blocks(unsigned index, u16 count, u8* out)
 {
-    if (!m_channel.m_bus_master_base.is_null() && m_channel.m_dma_enabled.resource())
-        return read_sectors_with_dma(index, count, out);
-    return read_sectors(index, count, out);
+    bool use_dma = !m_channel.m_bus_master_base.is_null() && m_channel.m_dma_enabled.resource();
+    while (count) {
+        u16 transfer_count = min(count, PATAChannel::max_transfer_sectors);
+        bool success = use_dma ? read_sectors_with_dma(index, transfer_count, out) : read_sectors(index, transfer_count, out);
+        if (!success)
+            return false;
+        index += transfer_count;
+        count -= transfer_count;
+        out += transfer_count * block_size();
+    }
+    return true;
 }
 
 bool PATADiskDevice::write_blocks(unsigned index, u16 count, const u8* data)
 {
-    if (!m_channel.m_bus_master_base.is_null() && m_channel.m_dma_enabled.resource())
-        return write_sectors_with_dma(index, count, data);
+    if (!m_channel.m_bus_master_base.is_null() && m_channel.m_dma_enabled.resource()) {
+        while (count) {
+            u16 transfer_count = min(count, PATAChannel::max_transfer_sectors);
+            if (!write_sectors_with_dma(index, transfer_count, data))
+                return false;
+            index += transfer_count;
+            count -= transfer_count;
+            data += transfer_count * block_size();
+        }
+        return true;
+    }
     for (unsigned i = 0; i < count; ++i) {
         if (!write_sectors(index + i, 1, data + i * 512))
             return false;
@@ -83,15 +100,13 @@ void PATADiskDevice::set_drive_geometry(u16 cyls, u16 heads, u16 spt)
 ssize_t PATADiskDevice::read(FileDescription& fd, u8* outbuf, ssize_t len)
 {
     unsigned index = fd.offset() / block_size();
-    u16 whole_blocks = len / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // Hand the drive at most one maximum-sized transfer per call;
+    // callers that want more will come back for the rest.
+    if (whole_blocks >= PATAChannel::max_transfer_sectors) {
+        whole_blocks = PATAChannel::max_transfer_sectors;
         remaining = 0;
     }
 
@@ -124,15 +139,13 @@ bool PATADiskDevice::can_read(const FileDescription& fd) const
 ssize_t PATADiskDevice::write(FileDescription& fd, const u8* inbuf, ssize_t len)
 {
     unsigned index = fd.offset() / block_size();
-    u16 whole_blocks = len / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // Hand the drive at most one maximum-sized transfer per call;
+    // callers that want more will come back for the rest.
+    if (whole_blocks >= PATAChannel::max_transfer_sectors) {
+        whole_blocks = PATAChannel::max_transfer_sectors;
         remaining = 0;
     }
 
@@ -128,6 +128,7 @@ void PS2MouseDevice::handle_vmmouse_absolute_pointer()
     }
     packet.is_relative = false;
     m_queue.enqueue(packet);
+    evaluate_block_conditions();
 }
 
 void PS2MouseDevice::handle_irq(const RegisterState&)
@@ -216,6 +217,7 @@ void PS2MouseDevice::parse_data_packet()
     dbg() << "Mouse: X " << packet.x << ", Y " << packet.y << ", Z " << packet.z;
 #endif
     m_queue.enqueue(packet);
+    evaluate_block_conditions();
 }
 
 void PS2MouseDevice::wait_then_write(u8 port, u8 data)
@@ -45,6 +45,9 @@ public:
     virtual bool can_write(const FileDescription&) const override;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) override;
 
+    // Readiness comes straight from the line status register, so blocked threads have to poll it.
+    virtual bool signals_readiness_changes() const override { return false; }
+
     enum InterruptEnable {
         LowPowerMode = 0x01 << 5,
         SleepMode = 0x01 << 4,
@@ -69,6 +69,8 @@ ssize_t DoubleBuffer::write(const u8* data, ssize_t size)
     m_write_buffer->size += bytes_to_write;
     compute_lockfree_metadata();
     memcpy(write_ptr, data, bytes_to_write);
+    if (bytes_to_write && m_unblock_callback)
+        m_unblock_callback();
     return bytes_to_write;
 }
 
@@ -86,6 +88,8 @@ ssize_t DoubleBuffer::read(u8* data, ssize_t size)
     memcpy(data, m_read_buffer->data + m_read_buffer_index, nread);
     m_read_buffer_index += nread;
     compute_lockfree_metadata();
+    if (nread && m_unblock_callback)
+        m_unblock_callback();
     return nread;
 }
 
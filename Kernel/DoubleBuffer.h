@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/Types.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Lock.h>
@@ -41,8 +42,13 @@ public:
 
     bool is_empty() const { return m_empty; }
 
+    size_t capacity() const { return m_capacity; }
+
     size_t space_for_writing() const { return m_space_for_writing; }
 
+    // Called after every read or write that moved some data.
+    void set_unblock_callback(Function<void()> callback) { m_unblock_callback = move(callback); }
+
 private:
     void flip();
     void compute_lockfree_metadata();
@@ -63,6 +69,7 @@ private:
     size_t m_space_for_writing { 0 };
     bool m_empty { true };
     mutable Lock m_lock { "DoubleBuffer" };
+    Function<void()> m_unblock_callback;
 };
 
 }
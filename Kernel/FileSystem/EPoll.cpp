@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+//#define EPOLL_DEBUG
+
+namespace Kernel {
+
+NonnullRefPtr<EPoll> EPoll::create()
+{
+    return adopt(*new EPoll);
+}
+
+EPoll::EPoll()
+{
+}
+
+EPoll::~EPoll()
+{
+    InterruptDisabler disabler;
+    while (!m_interests.is_empty())
+        remove_interest(*m_interests.begin()->value);
+}
+
+KResult EPoll::add_interest(int fd, FileDescription& description, const epoll_event& event)
+{
+    auto& file = description.file();
+    if (file.is_epoll())
+        return KResult(-EINVAL);
+
+    InterruptDisabler disabler;
+    if (m_interests.contains({ &description, fd }))
+        return KResult(-EEXIST);
+    auto interest = make<EPollInterest>(*this, fd, description, event);
+    file.add_epoll_interest({}, *interest);
+    // We'd never hear about these becoming ready, so they get polled instead.
+    if (!file.signals_readiness_changes()) {
+        interest->m_is_polled = true;
+        ++m_polled_interest_count;
+    }
+    // The file may well be ready already, so check it on the next wait.
+    m_ready_list.append(*interest);
+    m_interests.set(interest->key(), move(interest));
+#ifdef EPOLL_DEBUG
+    dbg() << "EPoll{" << this << "}: added fd " << fd << " with events " << String::format("%x", event.events);
+#endif
+    evaluate_block_conditions();
+    return KSuccess;
+}
+
+KResult EPoll::modify_interest(int fd, FileDescription& description, const epoll_event& event)
+{
+    InterruptDisabler disabler;
+    auto it = m_interests.find({ &description, fd });
+    if (it == m_interests.end())
+        return KResult(-ENOENT);
+    auto& interest = *it->value;
+    interest.m_event = event;
+    if (!interest.m_ready_list_node.is_in_list())
+        m_ready_list.append(interest);
+    evaluate_block_conditions();
+    return KSuccess;
+}
+
+KResult EPoll::remove_interest(int fd, FileDescription& description)
+{
+    InterruptDisabler disabler;
+    auto it = m_interests.find({ &description, fd });
+    if (it == m_interests.end())
+        return KResult(-ENOENT);
+    remove_interest(*it->value);
+    return KSuccess;
+}
+
+void EPoll::remove_interest(EPollInterest& interest)
+{
+    InterruptDisabler disabler;
+#ifdef EPOLL_DEBUG
+    dbg() << "EPoll{" << this << "}: removing fd " << interest.fd();
+#endif
+    interest.description().file().remove_epoll_interest({}, interest);
+    if (interest.m_ready_list_node.is_in_list())
+        m_ready_list.remove(interest);
+    if (interest.m_is_polled)
+        --m_polled_interest_count;
+    m_interests.remove(interest.key());
+}
+
+void EPoll::interest_readiness_changed(Badge<File>, EPollInterest& interest)
+{
+    InterruptDisabler disabler;
+    if (interest.m_ready_list_node.is_in_list())
+        return;
+    m_ready_list.append(interest);
+    evaluate_block_conditions();
+}
+
+void EPoll::interest_description_destroyed(Badge<File>, EPollInterest& interest)
+{
+    remove_interest(interest);
+}
+
+u32 EPoll::ready_events_for(EPollInterest& interest)
+{
+    u32 ready_events = 0;
+    if ((interest.m_event.events & EPOLLIN) && interest.description().can_read())
+        ready_events |= EPOLLIN;
+    if ((interest.m_event.events & EPOLLOUT) && interest.description().can_write())
+        ready_events |= EPOLLOUT;
+    return ready_events;
+}
+
+bool EPoll::can_read(const FileDescription&) const
+{
+    InterruptDisabler disabler;
+    for (auto& interest : const_cast<EPoll&>(*this).m_ready_list) {
+        if (ready_events_for(interest))
+            return true;
+    }
+    return false;
+}
+
+int EPoll::collect_ready_events(epoll_event* events, int max_events)
+{
+    InterruptDisabler disabler;
+    // Level-triggered interests that were reported go to the back of the ready list,
+    // so that everyone gets a turn when there are more ready interests than max_events.
+    // Polled interests always go back, whether they were ready or not.
+    IntrusiveList<EPollInterest, &EPollInterest::m_ready_list_node> reported;
+    int event_count = 0;
+    while (event_count < max_events) {
+        auto* interest = m_ready_list.take_first();
+        if (!interest)
+            break;
+        u32 ready_events = ready_events_for(*interest);
+        if (!ready_events) {
+            // Not ready after all; wait for the file to tell us something changed.
+            if (interest->m_is_polled)
+                reported.append(*interest);
+            continue;
+        }
+        events[event_count].events = ready_events;
+        events[event_count].data = interest->m_event.data;
+        ++event_count;
+        if (interest->m_event.events & EPOLLONESHOT)
+            interest->m_event.events = 0;
+        else if (!(interest->m_event.events & EPOLLET) || interest->m_is_polled)
+            reported.append(*interest);
+    }
+    while (auto* interest = reported.take_first())
+        m_ready_list.append(*interest);
+    return event_count;
+}
+
+}
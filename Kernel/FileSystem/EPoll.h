@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// Like on Linux, an interest is identified by both the fd it was added with and the description that fd referred to.
+// That way, if the fd is closed while its description lives on (e.g. in a forked child), the number can be reused
+// and added again without running into the old interest.
+struct EPollInterestKey {
+    FileDescription* description { nullptr };
+    int fd { -1 };
+
+    bool operator==(const EPollInterestKey& other) const { return description == other.description && fd == other.fd; }
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<Kernel::EPollInterestKey> : public GenericTraits<Kernel::EPollInterestKey> {
+    static unsigned hash(const Kernel::EPollInterestKey& key) { return pair_int_hash(ptr_hash(key.description), key.fd); }
+};
+
+}
+
+namespace Kernel {
+
+// One file description an EPoll is interested in.
+// Interests don't keep their description alive; they are dropped when it goes away.
+class EPollInterest {
+public:
+    EPollInterest(EPoll& epoll, int fd, FileDescription& description, const epoll_event& event)
+        : m_epoll(epoll)
+        , m_fd(fd)
+        , m_description(description)
+        , m_event(event)
+    {
+    }
+
+    EPoll& epoll() { return m_epoll; }
+    int fd() const { return m_fd; }
+    FileDescription& description() { return m_description; }
+    EPollInterestKey key() { return { &m_description, m_fd }; }
+
+private:
+    friend class EPoll;
+
+    EPoll& m_epoll;
+    int m_fd { -1 };
+    FileDescription& m_description;
+    epoll_event m_event;
+    bool m_is_polled { false };
+    IntrusiveListNode m_ready_list_node;
+};
+
+// An EPoll holds a persistent set of interests and wakes up waiters when any of them may have become ready.
+// Interests whose File signals a readiness change are queued on the ready list, so waiting for events
+// only looks at files that have changed since the last wait, instead of at the whole set.
+// Files that can't signal readiness changes stay on the ready list and get polled on every wait (and the
+// EPoll itself gets polled by whoever blocks on it), which makes them level-triggered even with EPOLLET.
+class EPoll final : public File {
+public:
+    static NonnullRefPtr<EPoll> create();
+    virtual ~EPoll() override;
+
+    KResult add_interest(int fd, FileDescription&, const epoll_event&);
+    KResult modify_interest(int fd, FileDescription&, const epoll_event&);
+    KResult remove_interest(int fd, FileDescription&);
+
+    // Fills in up to max_events events for ready interests and returns how many there were.
+    int collect_ready_events(epoll_event* events, int max_events);
+
+    void interest_readiness_changed(Badge<File>, EPollInterest&);
+    void interest_description_destroyed(Badge<File>, EPollInterest&);
+
+    virtual bool can_read(const FileDescription&) const override;
+    virtual bool can_write(const FileDescription&) const override { return false; }
+    virtual bool signals_readiness_changes() const override { return !m_polled_interest_count; }
+    virtual ssize_t read(FileDescription&, u8*, ssize_t) override { return -EINVAL; }
+    virtual ssize_t write(FileDescription&, const u8*, ssize_t) override { return -EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "epoll"; }
+    virtual const char* class_name() const override { return "EPoll"; }
+    virtual bool is_epoll() const override { return true; }
+
+private:
+    EPoll();
+
+    static u32 ready_events_for(EPollInterest&);
+    void remove_interest(EPollInterest&);
+
+    HashMap<EPollInterestKey, NonnullOwnPtr<EPollInterest>> m_interests;
+    IntrusiveList<EPollInterest, &EPollInterest::m_ready_list_node> m_ready_list;
+    size_t m_polled_interest_count { 0 };
+};
+
+}
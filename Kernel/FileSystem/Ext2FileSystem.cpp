@@ -43,6 +43,7 @@ namespace Kernel {
 
 static const size_t max_link_count = 65535;
 static const size_t max_block_size = 4096;
+static const size_t max_read_run_size = 64 * KB;
 static const ssize_t max_inline_symlink_length = 60;
 
 static u8 to_ext2_file_type(mode_t mode)
@@ -516,22 +517,30 @@ void Ext2FS::flush_block_group_descriptor_table()
 void Ext2FS::flush_writes()
 {
     LOCKER(m_lock);
-    if (m_super_block_dirty) {
-        flush_super_block();
-        m_super_block_dirty = false;
-    }
-    if (m_block_group_descriptors_dirty) {
-        flush_block_group_descriptor_table();
-        m_block_group_descriptors_dirty = false;
-    }
-    for (auto& cached_bitmap : m_cached_bitmaps) {
-        if (cached_bitmap->dirty) {
-            write_block(cached_bitmap->bitmap_block_index, cached_bitmap->buffer.data());
-            cached_bitmap->dirty = false;
+    {
+        Locker inode_bitmap_locker(m_inode_bitmap_lock);
+        Locker block_bitmap_locker(m_block_bitmap_lock);
+        if (m_super_block_dirty) {
+            flush_super_block();
+            m_super_block_dirty = false;
+        }
+        if (m_block_group_descriptors_dirty) {
+            flush_block_group_descriptor_table();
+            m_block_group_descriptors_dirty = false;
+        }
+        auto flush_bitmaps = [&](auto& cached_bitmaps) {
+            for (auto& cached_bitmap : cached_bitmaps) {
+                if (cached_bitmap->dirty) {
+                    write_block(cached_bitmap->bitmap_block_index, cached_bitmap->buffer.data());
+                    cached_bitmap->dirty = false;
 #ifdef EXT2_DEBUG
-            dbg() << "Flushed bitmap block " << cached_bitmap->bitmap_block_index;
+                    dbg() << "Flushed bitmap block " << cached_bitmap->bitmap_block_index;
 #endif
-        }
+                }
+            }
+        };
+        flush_bitmaps(m_cached_inode_bitmaps);
+        flush_bitmaps(m_cached_block_bitmaps);
     }
 
     FileBackedFS::flush_writes();
@@ -567,7 +576,7 @@ Ext2FSInode::~Ext2FSInode()
 
 InodeMetadata Ext2FSInode::metadata() const
 {
-    LOCKER(m_lock);
+    Locker inode_locker(m_lock, Lock::Mode::Shared);
     InodeMetadata metadata;
     metadata.inode = identifier();
     metadata.size = m_raw_inode.i_size;
@@ -637,9 +646,16 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
     return new_inode;
 }
 
+void Ext2FSInode::populate_block_list() const
+{
+    LOCKER(m_lock);
+    if (m_block_list.is_empty())
+        m_block_list = fs().block_list_for_inode(m_raw_inode);
+}
+
 ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDescription* description) const
 {
-    Locker inode_locker(m_lock);
+    Locker inode_locker(m_lock, Lock::Mode::Shared);
     ASSERT(offset >= 0);
     if (m_raw_inode.i_size == 0)
         return 0;
@@ -653,10 +669,14 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
         return nread;
     }
 
-    Locker fs_locker(fs().m_lock);
-
-    if (m_block_list.is_empty())
-        m_block_list = fs().block_list_for_inode(m_raw_inode);
+    if (m_block_list.is_empty()) {
+        // Readers only share the inode lock, so they can't fill in the block list themselves.
+        inode_locker.unlock();
+        populate_block_list();
+        inode_locker.lock();
+        if (m_raw_inode.i_size == 0)
+            return 0;
+    }
 
     if (m_block_list.is_empty()) {
         klog() << "ext2fs: read_bytes: empty block list for inode " << index();
@@ -682,26 +702,91 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, u8* buffer, FileDes
 
     u8 block[max_block_size];
 
-    for (size_t bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; ++bi) {
+    // Runs of whole blocks are read into this and copied out afterwards if the caller's buffer is user memory,
+    // since faulting on it while the disk is busy would re-enter the file system. Kernel buffers are read into directly.
+    bool needs_run_buffer = is_user_address(VirtualAddress(buffer));
+    Optional<KBuffer> run_buffer;
+    size_t max_run_length = max_read_run_size / block_size;
+
+    for (size_t bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index;) {
         auto block_index = m_block_list[bi];
         ASSERT(block_index);
+        size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
+
+        if (offset_into_block == 0 && remaining_count >= (size_t)block_size) {
+            // Read the whole run of physically contiguous blocks with one request.
+            size_t run_length = 1;
+            while (run_length < max_run_length
+                && bi + run_length <= last_block_logical_index
+                && (run_length + 1) * block_size <= remaining_count
+                && m_block_list[bi + run_length] == block_index + run_length)
+                ++run_length;
+
+            if (needs_run_buffer && !run_buffer.has_value()) {
+                size_t run_buffer_size = min(remaining_count / block_size, max_run_length) * block_size;
+                run_buffer = KBuffer::create_with_size(run_buffer_size, Region::Access::Read | Region::Access::Write, "Ext2FS: read_bytes");
+            }
+
+            if (!fs().read_blocks(block_index, run_length, needs_run_buffer ? run_buffer.value().data() : out, description)) {
+                klog() << "ext2fs: read_bytes: read_blocks(" << block_index << ", " << run_length << ") failed (lbi: " << bi << ")";
+                return -EIO;
+            }
+
+            size_t num_bytes_read = run_length * block_size;
+            if (needs_run_buffer)
+                memcpy(out, run_buffer.value().data(), num_bytes_read);
+            remaining_count -= num_bytes_read;
+            nread += num_bytes_read;
+            out += num_bytes_read;
+            bi += run_length;
+            continue;
+        }
+
         bool success = fs().read_block(block_index, block, description);
         if (!success) {
             klog() << "ext2fs: read_bytes: read_block(" << block_index << ") failed (lbi: " << bi << ")";
             return -EIO;
         }
 
-        size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min(block_size - offset_into_block, remaining_count);
         memcpy(out, block + offset_into_block, num_bytes_to_copy);
         remaining_count -= num_bytes_to_copy;
         nread += num_bytes_to_copy;
         out += num_bytes_to_copy;
+        ++bi;
     }
 
     return nread;
 }
 
+size_t Ext2FSInode::read_ahead(off_t offset, size_t size) const
+{
+    Locker inode_locker(m_lock, Lock::Mode::Shared);
+    ASSERT(offset >= 0);
+    if (offset >= (off_t)this->size() || (is_symlink() && this->size() < max_inline_symlink_length))
+        return 0;
+    size = min(size, (size_t)(this->size() - offset));
+
+    // The read that triggered this has already filled in the block list.
+    if (m_block_list.is_empty())
+        return 0;
+
+    const size_t block_size = fs().block_size();
+    size_t first_block_logical_index = offset / block_size;
+    size_t last_block_logical_index = min((offset + size - 1) / block_size, m_block_list.size() - 1);
+
+    for (size_t bi = first_block_logical_index; bi <= last_block_logical_index;) {
+        auto block_index = m_block_list[bi];
+        size_t run_length = 1;
+        while (bi + run_length <= last_block_logical_index && m_block_list[bi + run_length] == block_index + run_length)
+            ++run_length;
+        if (block_index)
+            fs().read_ahead_blocks(block_index, run_length);
+        bi += run_length;
+    }
+    return size;
+}
+
 KResult Ext2FSInode::resize(u64 new_size)
 {
     u64 old_size = size();
@@ -758,7 +843,6 @@ ssize_t Ext2FSInode::write_bytes(off_t offset, ssize_t count, const u8* data, Fi
     ASSERT(count >= 0);
 
     Locker inode_locker(m_lock);
-    Locker fs_locker(fs().m_lock);
 
     if (is_symlink()) {
         ASSERT(offset == 0);
@@ -1052,7 +1136,7 @@ bool Ext2FS::write_ext2_inode(unsigned inode, const ext2_inode& e2inode)
 
 Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count)
 {
-    LOCKER(m_lock);
+    LOCKER(m_block_bitmap_lock);
 #ifdef EXT2_DEBUG
     dbg() << "Ext2FS: allocate_blocks(preferred group: " << preferred_group_index << ", count: " << count << ")";
 #endif
@@ -1089,7 +1173,7 @@ Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_in
 
         ASSERT(found_a_group);
         auto& bgd = group_descriptor(group_index);
-        auto& cached_bitmap = get_bitmap_block(bgd.bg_block_bitmap);
+        auto& cached_bitmap = get_block_bitmap(bgd.bg_block_bitmap);
 
         int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
         auto block_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), blocks_in_group);
@@ -1117,7 +1201,7 @@ Vector<Ext2FS::BlockIndex> Ext2FS::allocate_blocks(GroupIndex preferred_group_in
 
 unsigned Ext2FS::find_a_free_inode(GroupIndex preferred_group, off_t expected_size)
 {
-    LOCKER(m_lock);
+    LOCKER(m_inode_bitmap_lock);
 #ifdef EXT2_DEBUG
     dbg() << "Ext2FS: find_a_free_inode(preferred_group: " << preferred_group << ", expected_size: " << String::format("%ld", expected_size) << ")";
 #endif
@@ -1161,7 +1245,7 @@ unsigned Ext2FS::find_a_free_inode(GroupIndex preferred_group, off_t expected_si
 
     unsigned first_inode_in_group = (group_index - 1) * inodes_per_group() + 1;
 
-    auto& cached_bitmap = get_bitmap_block(bgd.bg_inode_bitmap);
+    auto& cached_bitmap = get_inode_bitmap(bgd.bg_inode_bitmap);
     auto inode_bitmap = Bitmap::wrap(cached_bitmap.buffer.data(), inodes_in_group);
     for (size_t i = 0; i < inode_bitmap.size(); ++i) {
         if (inode_bitmap.get(i))
@@ -1200,7 +1284,7 @@ unsigned Ext2FS::group_index_from_inode(unsigned inode) const
 
 bool Ext2FS::get_inode_allocation_state(InodeIndex index) const
 {
-    LOCKER(m_lock);
+    LOCKER(m_inode_bitmap_lock);
     if (index == 0)
         return true;
     unsigned group_index = group_index_from_inode(index);
@@ -1208,19 +1292,19 @@ bool Ext2FS::get_inode_allocation_state(InodeIndex index) const
     unsigned index_in_group = index - ((group_index - 1) * inodes_per_group());
     unsigned bit_index = (index_in_group - 1) % inodes_per_group();
 
-    auto& cached_bitmap = const_cast<Ext2FS&>(*this).get_bitmap_block(bgd.bg_inode_bitmap);
+    auto& cached_bitmap = const_cast<Ext2FS&>(*this).get_inode_bitmap(bgd.bg_inode_bitmap);
     return cached_bitmap.bitmap(inodes_per_group()).get(bit_index);
 }
 
 bool Ext2FS::set_inode_allocation_state(InodeIndex inode_index, bool new_state)
 {
-    LOCKER(m_lock);
+    LOCKER(m_inode_bitmap_lock);
     unsigned group_index = group_index_from_inode(inode_index);
     auto& bgd = group_descriptor(group_index);
     unsigned index_in_group = inode_index - ((group_index - 1) * inodes_per_group());
     unsigned bit_index = (index_in_group - 1) % inodes_per_group();
 
-    auto& cached_bitmap = get_bitmap_block(bgd.bg_inode_bitmap);
+    auto& cached_bitmap = get_inode_bitmap(bgd.bg_inode_bitmap);
 
     bool current_state = cached_bitmap.bitmap(inodes_per_group()).get(bit_index);
 #ifdef EXT2_DEBUG
@@ -1264,9 +1348,21 @@ Ext2FS::BlockIndex Ext2FS::first_block_index() const
     return block_size() == 1024 ? 1 : 0;
 }
 
-Ext2FS::CachedBitmap& Ext2FS::get_bitmap_block(BlockIndex bitmap_block_index)
+Ext2FS::CachedBitmap& Ext2FS::get_block_bitmap(BlockIndex bitmap_block_index)
 {
-    for (auto& cached_bitmap : m_cached_bitmaps) {
+    ASSERT(m_block_bitmap_lock.is_locked());
+    return get_bitmap_block(m_cached_block_bitmaps, bitmap_block_index);
+}
+
+Ext2FS::CachedBitmap& Ext2FS::get_inode_bitmap(BlockIndex bitmap_block_index)
+{
+    ASSERT(m_inode_bitmap_lock.is_locked());
+    return get_bitmap_block(m_cached_inode_bitmaps, bitmap_block_index);
+}
+
+Ext2FS::CachedBitmap& Ext2FS::get_bitmap_block(Vector<OwnPtr<CachedBitmap>>& cached_bitmaps, BlockIndex bitmap_block_index)
+{
+    for (auto& cached_bitmap : cached_bitmaps) {
         if (cached_bitmap->bitmap_block_index == bitmap_block_index)
             return *cached_bitmap;
     }
@@ -1274,14 +1370,14 @@ Ext2FS::CachedBitmap& Ext2FS::get_bitmap_block(BlockIndex bitmap_block_index)
     auto block = KBuffer::create_with_size(block_size(), Region::Access::Read | Region::Access::Write, "Ext2FS: Cached bitmap block");
     bool success = read_block(bitmap_block_index, block.data());
     ASSERT(success);
-    m_cached_bitmaps.append(make<CachedBitmap>(bitmap_block_index, move(block)));
-    return *m_cached_bitmaps.last();
+    cached_bitmaps.append(make<CachedBitmap>(bitmap_block_index, move(block)));
+    return *cached_bitmaps.last();
 }
 
 bool Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
 {
     ASSERT(block_index != 0);
-    LOCKER(m_lock);
+    LOCKER(m_block_bitmap_lock);
 #ifdef EXT2_DEBUG
     dbg() << "Ext2FS: set_block_allocation_state(block=" << block_index << ", state=" << String::format("%u", new_state) << ")";
 #endif
@@ -1291,7 +1387,7 @@ bool Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
     BlockIndex index_in_group = (block_index - first_block_index()) - ((group_index - 1) * blocks_per_group());
     unsigned bit_index = index_in_group % blocks_per_group();
 
-    auto& cached_bitmap = get_bitmap_block(bgd.bg_block_bitmap);
+    auto& cached_bitmap = get_block_bitmap(bgd.bg_block_bitmap);
 
     bool current_state = cached_bitmap.bitmap(blocks_per_group()).get(bit_index);
 #ifdef EXT2_DEBUG
@@ -58,6 +58,7 @@ public:
 private:
     // ^Inode
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const override;
+    virtual size_t read_ahead(off_t, size_t) const override;
     virtual InodeMetadata metadata() const override;
     virtual bool traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const override;
     virtual RefPtr<Inode> lookup(StringView name) override;
@@ -77,6 +78,7 @@ private:
 
     bool write_directory(const Vector<FS::DirectoryEntry>&);
     void populate_lookup_cache() const;
+    void populate_block_list() const;
     KResult resize(u64);
 
     Ext2FS& fs();
@@ -183,9 +185,18 @@ private:
         Bitmap bitmap(u32 blocks_per_group) { return Bitmap::wrap(buffer.data(), blocks_per_group); }
     };
 
-    CachedBitmap& get_bitmap_block(BlockIndex);
-
-    Vector<OwnPtr<CachedBitmap>> m_cached_bitmaps;
+    CachedBitmap& get_block_bitmap(BlockIndex);
+    CachedBitmap& get_inode_bitmap(BlockIndex);
+    CachedBitmap& get_bitmap_block(Vector<OwnPtr<CachedBitmap>>&, BlockIndex);
+
+    // The allocation bitmaps, and the free block/inode counts in the super block
+    // and group descriptors, are guarded by their own locks rather than m_lock,
+    // so allocating doesn't have to wait on unrelated file system operations.
+    // Lock order: m_lock, then m_inode_bitmap_lock, then m_block_bitmap_lock.
+    mutable Lock m_inode_bitmap_lock { "Ext2FS: Inode bitmap" };
+    mutable Lock m_block_bitmap_lock { "Ext2FS: Block bitmap" };
+    Vector<OwnPtr<CachedBitmap>> m_cached_inode_bitmaps;
+    Vector<OwnPtr<CachedBitmap>> m_cached_block_bitmaps;
 };
 
 inline Ext2FS& Ext2FSInode::fs()
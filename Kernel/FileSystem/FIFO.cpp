@@ -66,6 +66,10 @@ FIFO::FIFO(uid_t uid)
     LOCKER(all_fifos().lock());
     all_fifos().resource().set(this);
     m_fifo_id = ++s_next_fifo_id;
+
+    m_buffer.set_unblock_callback([this] {
+        evaluate_block_conditions();
+    });
 }
 
 FIFO::~FIFO()
@@ -87,6 +91,7 @@ void FIFO::attach(Direction direction)
         klog() << "open writer (" << m_writers << ")";
 #endif
     }
+    evaluate_block_conditions();
 }
 
 void FIFO::detach(Direction direction)
@@ -104,6 +109,7 @@ void FIFO::detach(Direction direction)
         ASSERT(m_writers);
         --m_writers;
     }
+    evaluate_block_conditions();
 }
 
 bool FIFO::can_read(const FileDescription&) const
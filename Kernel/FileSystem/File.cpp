@@ -25,6 +25,7 @@
  */
 
 #include <AK/StringView.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/FileSystem/FileDescription.h>
 
@@ -50,6 +51,40 @@ void File::close()
 {
 }
 
+void File::evaluate_block_conditions()
+{
+    InterruptDisabler disabler;
+    m_block_condition.notify_all();
+    for (auto* interest : m_epoll_interests)
+        interest->epoll().interest_readiness_changed({}, *interest);
+}
+
+void File::add_epoll_interest(Badge<EPoll>, EPollInterest& interest)
+{
+    InterruptDisabler disabler;
+    m_epoll_interests.append(&interest);
+}
+
+void File::remove_epoll_interest(Badge<EPoll>, EPollInterest& interest)
+{
+    InterruptDisabler disabler;
+    m_epoll_interests.remove_first_matching([&](auto* entry) { return entry == &interest; });
+}
+
+void File::drop_epoll_interests_for(Badge<FileDescription>, FileDescription& description)
+{
+    InterruptDisabler disabler;
+    for (size_t i = 0; i < m_epoll_interests.size();) {
+        auto* interest = m_epoll_interests[i];
+        if (&interest->description() != &description) {
+            ++i;
+            continue;
+        }
+        // This removes the interest from m_epoll_interests.
+        interest->epoll().interest_description_destroyed({}, *interest);
+    }
+}
+
 int File::ioctl(FileDescription&, unsigned, unsigned)
 {
     return -ENOTTY;
@@ -26,12 +26,15 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <Kernel/Forward.h>
 #include <Kernel/KResult.h>
+#include <Kernel/Thread.h>
 #include <Kernel/UnixTypes.h>
 #include <LibBareMetal/Memory/VirtualAddress.h>
 
@@ -51,6 +54,11 @@ namespace Kernel {
 //   - Return true if read() or write() would succeed, respectively.
 //   - Note that can_read() should return true in EOF conditions,
 //     and a subsequent call to read() should return 0.
+//   - Threads blocked on a File are only woken up through its block condition,
+//     so call evaluate_block_conditions() whenever either of them may have changed.
+//     Files that can't tell (e.g. because they read a hardware status register)
+//     should return false from signals_readiness_changes() to get polled instead.
+//     The same notification tells any EPoll interested in this File to look at it again.
 //
 // ioctl()
 //
@@ -74,6 +82,14 @@ public:
     virtual bool can_read(const FileDescription&) const = 0;
     virtual bool can_write(const FileDescription&) const = 0;
 
+    virtual bool signals_readiness_changes() const { return true; }
+    Thread::BlockCondition& block_condition() { return m_block_condition; }
+    void evaluate_block_conditions();
+
+    void add_epoll_interest(Badge<EPoll>, EPollInterest&);
+    void remove_epoll_interest(Badge<EPoll>, EPollInterest&);
+    void drop_epoll_interests_for(Badge<FileDescription>, FileDescription&);
+
     virtual ssize_t read(FileDescription&, u8*, ssize_t) = 0;
     virtual ssize_t write(FileDescription&, const u8*, ssize_t) = 0;
     virtual int ioctl(FileDescription&, unsigned request, unsigned arg);
@@ -97,9 +113,14 @@ public:
     virtual bool is_block_device() const { return false; }
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
+    virtual bool is_epoll() const { return false; }
 
 protected:
     File();
+
+private:
+    Thread::BlockCondition m_block_condition;
+    Vector<EPollInterest*, 1> m_epoll_interests;
 };
 
 }
@@ -24,94 +24,191 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/InlineLinkedList.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/KParams.h>
 #include <Kernel/Process.h>
+#include <Kernel/VM/MemoryManager.h>
 
 //#define FBFS_DEBUG
 
 namespace Kernel {
 
-struct CacheEntry {
-    time_t timestamp { 0 };
+struct CacheEntry : public InlineLinkedListNode<CacheEntry> {
     u32 block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
     bool is_dirty { false };
+    bool is_hashed { false };
+
+    // Chain of entries in the same hash bucket.
+    CacheEntry* next_in_bucket { nullptr };
+
+    // Either in the clean list (most recently used first) or the dirty list (oldest first).
+    CacheEntry* m_prev { nullptr };
+    CacheEntry* m_next { nullptr };
 };
 
 class DiskCache {
 public:
     explicit DiskCache(FileBackedFS& fs)
         : m_fs(fs)
+        , m_entry_count(entry_count_for_block_size(fs.block_size()))
         , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
         , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
     {
         for (size_t i = 0; i < m_entry_count; ++i) {
-            entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
+            auto* entry = new (&entries()[i]) CacheEntry;
+            entry->data = m_cached_block_data.data() + i * m_fs.block_size();
+            m_clean_list.append(entry);
         }
+
+        size_t bucket_count = 1;
+        while (bucket_count < m_entry_count)
+            bucket_count *= 2;
+        m_buckets.resize(bucket_count);
+        for (auto& bucket : m_buckets)
+            bucket = nullptr;
+
+        m_statistics.entry_count = m_entry_count;
     }
 
     ~DiskCache() {}
 
-    bool is_dirty() const { return m_dirty; }
-    void set_dirty(bool b) { m_dirty = b; }
+    bool is_dirty() const { return !m_dirty_list.is_empty(); }
 
-    CacheEntry& get(u32 block_index) const
+    CacheEntry* find(u32 block_index)
     {
-        auto now = kgettimeofday().tv_sec;
-
-        CacheEntry* oldest_clean_entry = nullptr;
-        for (size_t i = 0; i < m_entry_count; ++i) {
-            auto& entry = const_cast<CacheEntry&>(entries()[i]);
-            if (entry.block_index == block_index) {
-                entry.timestamp = now;
+        for (auto* entry = bucket_for(block_index); entry; entry = entry->next_in_bucket) {
+            if (entry->block_index == block_index)
                 return entry;
+        }
+        return nullptr;
+    }
+
+    CacheEntry& get(u32 block_index, bool is_read_ahead = false)
+    {
+        if (auto* entry = find(block_index)) {
+            if (!is_read_ahead)
+                ++m_statistics.hits;
+            if (!entry->is_dirty) {
+                m_clean_list.remove(entry);
+                m_clean_list.prepend(entry);
             }
-            if (!entry.is_dirty) {
-                if (!oldest_clean_entry)
-                    oldest_clean_entry = &entry;
-                else if (entry.timestamp < oldest_clean_entry->timestamp)
-                    oldest_clean_entry = &entry;
-            }
+            return *entry;
         }
-        if (!oldest_clean_entry) {
+        if (is_read_ahead)
+            ++m_statistics.read_ahead_blocks;
+        else
+            ++m_statistics.misses;
+
+        if (m_clean_list.is_empty()) {
             // Not a single clean entry! Flush writes and try again.
             // NOTE: We want to make sure we only call FileBackedFS flush here,
             //       not some FileBackedFS subclass flush!
             m_fs.flush_writes_impl();
-            return get(block_index);
+            ASSERT(!m_clean_list.is_empty());
         }
 
-        // Replace the oldest clean entry.
-        auto& new_entry = *oldest_clean_entry;
-        new_entry.timestamp = now;
+        // Replace the least recently used clean entry.
+        auto& new_entry = *m_clean_list.remove_tail();
+        if (new_entry.is_hashed) {
+            unhash(new_entry);
+            ++m_statistics.evictions;
+        }
         new_entry.block_index = block_index;
         new_entry.has_data = false;
-        new_entry.is_dirty = false;
+        hash(new_entry);
+        m_clean_list.prepend(&new_entry);
         return new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries.data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
+    void mark_dirty(CacheEntry& entry)
+    {
+        if (entry.is_dirty)
+            return;
+        entry.is_dirty = true;
+        m_clean_list.remove(&entry);
+        m_dirty_list.append(&entry);
+    }
+
+    void mark_clean(CacheEntry& entry)
+    {
+        ASSERT(entry.is_dirty);
+        entry.is_dirty = false;
+        m_dirty_list.remove(&entry);
+        m_clean_list.prepend(&entry);
+        ++m_statistics.writebacks;
+    }
 
     template<typename Callback>
-    void for_each_entry(Callback callback)
+    void for_each_dirty_entry(Callback callback)
     {
-        for (size_t i = 0; i < m_entry_count; ++i)
-            callback(entries()[i]);
+        for (auto* entry = m_dirty_list.head(); entry;) {
+            auto* next = entry->next();
+            callback(*entry);
+            entry = next;
+        }
     }
 
+    const FileBackedFS::CacheStatistics& statistics() const { return m_statistics; }
+
 private:
+    static size_t entry_count_for_block_size(size_t block_size)
+    {
+        // The cache size can be set with disk_cache_size=<KiB> on the kernel command line.
+        // By default it's an eighth of physical memory.
+        size_t cache_size = 0;
+        if (KParams::the().has("disk_cache_size")) {
+            bool ok;
+            cache_size = KParams::the().get("disk_cache_size").to_uint(ok) * KB;
+            if (!ok)
+                cache_size = 0;
+        }
+        if (!cache_size)
+            cache_size = (size_t)MM.user_physical_pages() * PAGE_SIZE / 8;
+        return max(cache_size / block_size, min_entry_count);
+    }
+
+    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
+
+    CacheEntry*& bucket_for(u32 block_index) { return m_buckets[int_hash(block_index) & (m_buckets.size() - 1)]; }
+
+    void hash(CacheEntry& entry)
+    {
+        ASSERT(!entry.is_hashed);
+        auto& bucket = bucket_for(entry.block_index);
+        entry.next_in_bucket = bucket;
+        bucket = &entry;
+        entry.is_hashed = true;
+    }
+
+    void unhash(CacheEntry& entry)
+    {
+        ASSERT(entry.is_hashed);
+        auto* link = &bucket_for(entry.block_index);
+        while (*link != &entry)
+            link = &(*link)->next_in_bucket;
+        *link = entry.next_in_bucket;
+        entry.next_in_bucket = nullptr;
+        entry.is_hashed = false;
+    }
+
+    static constexpr size_t min_entry_count = 256;
+
     FileBackedFS& m_fs;
-    size_t m_entry_count { 10000 };
+    size_t m_entry_count { 0 };
     KBuffer m_cached_block_data;
     KBuffer m_entries;
-    bool m_dirty { false };
+    Vector<CacheEntry*> m_buckets;
+    InlineLinkedList<CacheEntry> m_clean_list;
+    InlineLinkedList<CacheEntry> m_dirty_list;
+    FileBackedFS::CacheStatistics m_statistics;
 };
 
 FileBackedFS::FileBackedFS(FileDescription& file_description)
@@ -142,21 +239,20 @@ bool FileBackedFS::write_block(unsigned index, const u8* data, FileDescription*
     FileBackedFileSystem layer instead. */
     auto effective_block_size = use_logical_block_size ? m_logical_block_size : block_size();
 
+    LOCKER(m_cache_lock);
+
     if (!allow_cache) {
         flush_specific_block_if_needed(index);
         u32 base_offset = static_cast<u32>(index) * static_cast<u32>(effective_block_size);
-        m_file_description->seek(base_offset, SEEK_SET);
-        auto nwritten = m_file_description->write(data, effective_block_size);
+        auto nwritten = m_file_description->write_at(base_offset, data, effective_block_size);
         ASSERT((size_t)nwritten == effective_block_size);
         return true;
     }
 
     auto& entry = cache().get(index);
     memcpy(entry.data, data, effective_block_size);
-    entry.is_dirty = true;
     entry.has_data = true;
-
-    cache().set_dirty(true);
+    cache().mark_dirty(entry);
     return true;
 }
 
@@ -189,25 +285,30 @@ bool FileBackedFS::read_block(unsigned index, u8* buffer, FileDescription* descr
     FileBackedFileSystem layer instead. */
     auto effective_block_size = use_logical_block_size ? m_logical_block_size : block_size();
 
+    u32 base_offset = static_cast<u32>(index) * static_cast<u32>(effective_block_size);
+    auto& file_description = const_cast<FileDescription&>(*m_file_description);
+
     if (!allow_cache || cache_disabled) {
         if (!cache_disabled)
             const_cast<FileBackedFS*>(this)->flush_specific_block_if_needed(index);
-        u32 base_offset = static_cast<u32>(index) * static_cast<u32>(effective_block_size);
-        const_cast<FileDescription&>(*m_file_description).seek(base_offset, SEEK_SET);
-        auto nread = const_cast<FileDescription&>(*m_file_description).read(buffer, effective_block_size);
+        auto nread = file_description.read_at(base_offset, buffer, effective_block_size);
         ASSERT((size_t)nread == effective_block_size);
         return true;
     }
 
+    Locker locker(m_cache_lock);
     auto& entry = cache().get(index);
-    if (!entry.has_data) {
-        u32 base_offset = static_cast<u32>(index) * static_cast<u32>(effective_block_size);
-        const_cast<FileDescription&>(*m_file_description).seek(base_offset, SEEK_SET);
-        auto nread = const_cast<FileDescription&>(*m_file_description).read(entry.data, effective_block_size);
-        entry.has_data = true;
-        ASSERT((size_t)nread == effective_block_size);
+    if (entry.has_data) {
+        memcpy(buffer, entry.data, effective_block_size);
+        return true;
     }
-    memcpy(buffer, entry.data, effective_block_size);
+
+    // Don't make readers of cached blocks wait for the disk.
+    locker.unlock();
+    auto nread = file_description.read_at(base_offset, buffer, effective_block_size);
+    ASSERT((size_t)nread == effective_block_size);
+    locker.lock();
+    fill_cache_entry(index, buffer, effective_block_size);
     return true;
 }
 
@@ -218,48 +319,160 @@ bool FileBackedFS::read_blocks(unsigned index, unsigned count, u8* buffer, FileD
         return false;
     if (count == 1)
         return read_block(index, buffer, description, use_logical_block_size, cache_disabled);
-    u8* out = buffer;
+
+    if (use_logical_block_size) {
+        u8* out = buffer;
+        for (unsigned i = 0; i < count; ++i) {
+            if (!read_block(index + i, out, description, use_logical_block_size, cache_disabled))
+                return false;
+            out += block_size();
+        }
+        return true;
+    }
+
+#ifdef FBFS_DEBUG
+    klog() << "FileBackedFileSystem::read_blocks " << index << " x" << count;
+#endif
+
+    bool allow_cache = !description || !description->is_direct();
+
+    if (!allow_cache || cache_disabled) {
+        if (!cache_disabled) {
+            for (unsigned i = 0; i < count; ++i)
+                const_cast<FileBackedFS*>(this)->flush_specific_block_if_needed(index + i);
+        }
+        return read_blocks_from_file(index, count, buffer);
+    }
+
+    // Copy cached blocks out of the cache, and read each run of uncached
+    // blocks from the file with one request, straight into the buffer.
+    // The cache isn't locked while the run is read, so the cache entries
+    // are looked up again to be filled in afterwards.
+    Locker locker(m_cache_lock);
+    unsigned run_start = 0;
+    unsigned run_length = 0;
+    auto read_run = [&] {
+        if (!run_length)
+            return true;
+        u8* run_buffer = buffer + run_start * block_size();
+        locker.unlock();
+        bool success = read_blocks_from_file(index + run_start, run_length, run_buffer);
+        locker.lock();
+        if (!success)
+            return false;
+        for (unsigned i = 0; i < run_length; ++i)
+            fill_cache_entry(index + run_start + i, run_buffer + i * block_size(), block_size());
+        run_length = 0;
+        return true;
+    };
 
     for (unsigned i = 0; i < count; ++i) {
-        if (!read_block(index + i, out, description, use_logical_block_size, cache_disabled))
+        auto& entry = cache().get(index + i);
+        if (!entry.has_data) {
+            if (!run_length)
+                run_start = i;
+            ++run_length;
+            continue;
+        }
+        // Copy this block first, as the entry may be gone once read_run() has dropped the lock.
+        memcpy(buffer + i * block_size(), entry.data, block_size());
+        if (!read_run())
             return false;
-        out += block_size();
     }
+    return read_run();
+}
+
+void FileBackedFS::fill_cache_entry(unsigned index, u8* data, size_t size) const
+{
+    ASSERT(m_cache_lock.is_locked());
+    auto* entry = cache().find(index);
+    if (!entry)
+        return;
+    if (entry->has_data) {
+        // Someone wrote to (or read) the block while we were reading it from the file; theirs is newer.
+        memcpy(data, entry->data, size);
+        return;
+    }
+    memcpy(entry->data, data, size);
+    entry->has_data = true;
+}
 
+void FileBackedFS::read_ahead_blocks(unsigned index, unsigned count) const
+{
+    Locker locker(m_cache_lock);
+    auto is_cached = [&](unsigned block_index) {
+        auto* entry = cache().find(block_index);
+        return entry && entry->has_data;
+    };
+
+    for (unsigned i = 0; i < count;) {
+        if (is_cached(index + i)) {
+            ++i;
+            continue;
+        }
+        unsigned run_length = 1;
+        while (i + run_length < count && !is_cached(index + i + run_length))
+            ++run_length;
+
+        auto buffer = KBuffer::create_with_size(run_length * block_size());
+        locker.unlock();
+        bool success = read_blocks_from_file(index + i, run_length, buffer.data());
+        locker.lock();
+        if (!success)
+            return;
+        for (unsigned j = 0; j < run_length; ++j) {
+            auto& entry = cache().get(index + i + j, true);
+            if (entry.has_data)
+                continue;
+            memcpy(entry.data, buffer.data() + j * block_size(), block_size());
+            entry.has_data = true;
+        }
+        i += run_length;
+    }
+}
+
+bool FileBackedFS::read_blocks_from_file(unsigned index, unsigned count, u8* buffer) const
+{
+    auto& description = const_cast<FileDescription&>(*m_file_description);
+    u32 base_offset = static_cast<u32>(index) * static_cast<u32>(block_size());
+    size_t byte_count = count * block_size();
+
+    // The underlying device may hand us fewer bytes than asked for per read.
+    size_t nread = 0;
+    while (nread < byte_count) {
+        auto result = description.read_at(base_offset + nread, buffer + nread, byte_count - nread);
+        if (result <= 0)
+            return false;
+        nread += result;
+    }
     return true;
 }
 
 void FileBackedFS::flush_specific_block_if_needed(unsigned index)
 {
-    LOCKER(m_lock);
+    LOCKER(m_cache_lock);
     if (!cache().is_dirty())
         return;
-    cache().for_each_entry([&](CacheEntry& entry) {
-        if (entry.is_dirty && entry.block_index == index) {
-            u32 base_offset = static_cast<u32>(entry.block_index) * static_cast<u32>(block_size());
-            m_file_description->seek(base_offset, SEEK_SET);
-            m_file_description->write(entry.data, block_size());
-            entry.is_dirty = false;
-        }
-    });
+    auto* entry = cache().find(index);
+    if (!entry || !entry->is_dirty)
+        return;
+    u32 base_offset = static_cast<u32>(entry->block_index) * static_cast<u32>(block_size());
+    m_file_description->write_at(base_offset, entry->data, block_size());
+    cache().mark_clean(*entry);
 }
 
 void FileBackedFS::flush_writes_impl()
 {
-    LOCKER(m_lock);
+    LOCKER(m_cache_lock);
     if (!cache().is_dirty())
         return;
     u32 count = 0;
-    cache().for_each_entry([&](CacheEntry& entry) {
-        if (!entry.is_dirty)
-            return;
+    cache().for_each_dirty_entry([&](CacheEntry& entry) {
         u32 base_offset = static_cast<u32>(entry.block_index) * static_cast<u32>(block_size());
-        m_file_description->seek(base_offset, SEEK_SET);
-        m_file_description->write(entry.data, block_size());
+        m_file_description->write_at(base_offset, entry.data, block_size());
         ++count;
-        entry.is_dirty = false;
+        cache().mark_clean(entry);
     });
-    cache().set_dirty(false);
     dbg() << class_name() << ": Flushed " << count << " blocks to disk";
 }
 
@@ -268,6 +481,14 @@ void FileBackedFS::flush_writes()
     flush_writes_impl();
 }
 
+FileBackedFS::CacheStatistics FileBackedFS::cache_statistics() const
+{
+    LOCKER(m_cache_lock);
+    if (!m_cache)
+        return {};
+    return m_cache->statistics();
+}
+
 DiskCache& FileBackedFS::cache() const
 {
     if (!m_cache)
@@ -49,12 +49,24 @@ public:
 
     size_t logical_block_size() const { return m_logical_block_size; };
 
+    struct CacheStatistics {
+        size_t entry_count { 0 };
+        u64 hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+        u64 writebacks { 0 };
+        u64 read_ahead_blocks { 0 };
+    };
+    CacheStatistics cache_statistics() const;
+
 protected:
     explicit FileBackedFS(FileDescription&);
 
     bool read_block(unsigned index, u8* buffer, FileDescription* = nullptr, bool use_logical_block_size = false, bool cache_disabled = false) const;
     bool read_blocks(unsigned index, unsigned count, u8* buffer, FileDescription* = nullptr, bool use_logical_block_size = false, bool cache_disabled = false) const;
 
+    void read_ahead_blocks(unsigned index, unsigned count) const;
+
     bool write_block(unsigned index, const u8*, FileDescription* = nullptr, bool use_logical_block_size = false);
     bool write_blocks(unsigned index, unsigned count, const u8*, FileDescription* = nullptr, bool use_logical_block_size = false);
 
@@ -62,10 +74,17 @@ protected:
 
 private:
     DiskCache& cache() const;
+    bool read_blocks_from_file(unsigned index, unsigned count, u8* buffer) const;
+    void fill_cache_entry(unsigned index, u8* data, size_t) const;
     void flush_specific_block_if_needed(unsigned index);
 
     NonnullRefPtr<FileDescription> m_file_description;
     mutable OwnPtr<DiskCache> m_cache;
+
+    // Protects the block cache. Taken after any file system lock, and
+    // dropped while reading from the backing file so that cache hits
+    // don't have to wait for misses.
+    mutable Lock m_cache_lock { "DiskCache" };
 };
 
 }
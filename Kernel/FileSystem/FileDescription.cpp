@@ -66,6 +66,7 @@ FileDescription::FileDescription(File& file)
 
 FileDescription::~FileDescription()
 {
+    m_file->drop_epoll_interests_for({}, *this);
     if (is_socket())
         socket()->detach(*this);
     if (is_fifo())
@@ -130,9 +131,17 @@ ssize_t FileDescription::read(u8* buffer, ssize_t count)
     if ((m_current_offset + count) < 0)
         return -EOVERFLOW;
     SmapDisabler disabler;
+    off_t offset = m_current_offset;
     int nread = m_file->read(*this, buffer, count);
     if (nread > 0 && m_file->is_seekable())
         m_current_offset += nread;
+    if (nread > 0 && m_file->is_inode() && !m_direct) {
+        if (auto read_ahead_size = m_read_ahead_window.did_access(offset, nread)) {
+            auto nread_ahead = m_inode->read_ahead(m_current_offset, read_ahead_size);
+            if (nread_ahead < read_ahead_size)
+                m_read_ahead_window.did_read_ahead(nread_ahead);
+        }
+    }
     return nread;
 }
 
@@ -148,6 +157,35 @@ ssize_t FileDescription::write(const u8* data, ssize_t size)
     return nwritten;
 }
 
+ssize_t FileDescription::read_at(off_t offset, u8* buffer, ssize_t count)
+{
+    LOCKER(m_lock);
+    if (!m_file->is_seekable())
+        return -ESPIPE;
+    if (offset < 0 || (offset + count) < 0)
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    // Files read at the description's offset, so borrow it for the duration of the read.
+    auto saved_offset = exchange(m_current_offset, offset);
+    int nread = m_file->read(*this, buffer, count);
+    m_current_offset = saved_offset;
+    return nread;
+}
+
+ssize_t FileDescription::write_at(off_t offset, const u8* data, ssize_t size)
+{
+    LOCKER(m_lock);
+    if (!m_file->is_seekable())
+        return -ESPIPE;
+    if (offset < 0 || (offset + size) < 0)
+        return -EOVERFLOW;
+    SmapDisabler disabler;
+    auto saved_offset = exchange(m_current_offset, offset);
+    int nwritten = m_file->write(*this, data, size);
+    m_current_offset = saved_offset;
+    return nwritten;
+}
+
 bool FileDescription::can_write() const
 {
     return m_file->can_write(*this);
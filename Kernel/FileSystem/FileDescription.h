@@ -32,6 +32,7 @@
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
+#include <Kernel/FileSystem/ReadAheadWindow.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/KBuffer.h>
 #include <LibBareMetal/Memory/VirtualAddress.h>
@@ -70,6 +71,11 @@ public:
     off_t seek(off_t, int whence);
     ssize_t read(u8*, ssize_t);
     ssize_t write(const u8* data, ssize_t);
+
+    // Like read() and write(), but at the given offset, leaving the current offset alone.
+    ssize_t read_at(off_t, u8*, ssize_t);
+    ssize_t write_at(off_t, const u8* data, ssize_t);
+
     KResult fstat(stat&);
 
     KResult chmod(mode_t);
@@ -148,6 +154,7 @@ private:
     NonnullRefPtr<File> m_file;
 
     off_t m_current_offset { 0 };
+    ReadAheadWindow m_read_ahead_window;
 
     Optional<KBuffer> m_generator_cache;
 
@@ -69,6 +69,9 @@ public:
     ByteBuffer read_entire(FileDescription* = nullptr) const;
 
     virtual ssize_t read_bytes(off_t, ssize_t, u8* buffer, FileDescription*) const = 0;
+    // Brings the given range into the file system's cache ahead of a read, if the file system has one.
+    // Returns how many bytes of the range were in the file.
+    virtual size_t read_ahead(off_t, size_t) const { return 0; }
     virtual bool traverse_as_directory(Function<bool(const FS::DirectoryEntry&)>) const = 0;
     virtual RefPtr<Inode> lookup(StringView name) = 0;
     virtual ssize_t write_bytes(off_t, ssize_t, const u8* data, FileDescription*) = 0;
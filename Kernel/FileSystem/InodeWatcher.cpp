@@ -86,6 +86,12 @@ String InodeWatcher::absolute_path(const FileDescription&) const
 void InodeWatcher::notify_inode_event(Badge<Inode>, Event::Type event_type)
 {
     m_queue.enqueue({ event_type });
+    evaluate_block_conditions();
+}
+
+void InodeWatcher::notify_inode_destroyed(Badge<Inode>)
+{
+    evaluate_block_conditions();
 }
 
 }
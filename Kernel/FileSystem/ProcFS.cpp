@@ -33,6 +33,7 @@
 #include <AK/JsonObjectSerializer.h>
 #include <AK/JsonValue.h>
 #include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Arch/i386/Processor.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
@@ -80,6 +81,7 @@ enum ProcFileType {
     FI_Root_df,
     FI_Root_all,
     FI_Root_memstat,
+    FI_Root_kmalloc,
     FI_Root_cpuinfo,
     FI_Root_inodes,
     FI_Root_dmesg,
@@ -479,6 +481,7 @@ Optional<KBuffer> procfs$net_adapters(InodeIdentifier)
         obj.add("bytes_in", adapter.bytes_in());
         obj.add("packets_out", adapter.packets_out());
         obj.add("bytes_out", adapter.bytes_out());
+        obj.add("packets_dropped", adapter.packets_dropped());
         obj.add("link_up", adapter.link_up());
         obj.add("mtu", adapter.mtu());
     });
@@ -517,6 +520,9 @@ Optional<KBuffer> procfs$net_tcp(InodeIdentifier)
         obj.add("bytes_in", socket.bytes_in());
         obj.add("packets_out", socket.packets_out());
         obj.add("bytes_out", socket.bytes_out());
+        obj.add("congestion_window", socket.congestion_window());
+        obj.add("send_window", socket.send_window());
+        obj.add("retransmission_timeout", socket.retransmission_timeout());
     });
     array.finish();
     return builder.build();
@@ -746,9 +752,17 @@ Optional<KBuffer> procfs$df(InodeIdentifier)
         fs_object.add("readonly", fs.is_readonly());
         fs_object.add("mount_flags", mount.flags());
 
-        if (fs.is_file_backed())
-            fs_object.add("source", static_cast<const FileBackedFS&>(fs).file_description().absolute_path());
-        else
+        if (fs.is_file_backed()) {
+            auto& file_backed_fs = static_cast<const FileBackedFS&>(fs);
+            fs_object.add("source", file_backed_fs.file_description().absolute_path());
+            auto cache_statistics = file_backed_fs.cache_statistics();
+            fs_object.add("cache_entry_count", cache_statistics.entry_count);
+            fs_object.add("cache_hits", cache_statistics.hits);
+            fs_object.add("cache_misses", cache_statistics.misses);
+            fs_object.add("cache_evictions", cache_statistics.evictions);
+            fs_object.add("cache_writebacks", cache_statistics.writebacks);
+            fs_object.add("cache_read_ahead_blocks", cache_statistics.read_ahead_blocks);
+        } else
             fs_object.add("source", fs.class_name());
     });
     array.finish();
@@ -758,6 +772,10 @@ Optional<KBuffer> procfs$df(InodeIdentifier)
 Optional<KBuffer> procfs$cpuinfo(InodeIdentifier)
 {
     KBufferBuilder builder;
+    builder.appendf("processors: %zu (%zu online)\n", Processor::count(), Processor::online_count());
+    Processor::for_each([&](const Processor& processor) {
+        builder.appendf("cpu%u:      apic id %u, %s\n", processor.id(), processor.apic_id(), processor.is_online() ? "online" : "offline");
+    });
     {
         CPUID cpuid(0);
         builder.appendf("cpuid:     ");
@@ -832,6 +850,7 @@ Optional<KBuffer> procfs$memstat(InodeIdentifier)
     json.add("super_physical_available", MM.super_physical_pages() - MM.super_physical_pages_used());
     json.add("kmalloc_call_count", g_kmalloc_call_count);
     json.add("kfree_call_count", g_kfree_call_count);
+    json.add("inode_faults_avoided", MM.inode_faults_avoided());
     slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
         auto prefix = String::format("slab_%zu", slab_size);
         json.add(String::format("%s_num_allocated", prefix.characters()), (u32)num_allocated);
@@ -841,6 +860,45 @@ Optional<KBuffer> procfs$memstat(InodeIdentifier)
     return builder.build();
 }
 
+Optional<KBuffer> procfs$kmalloc(InodeIdentifier)
+{
+    KmallocStats stats;
+    kmalloc_get_stats(stats);
+
+    KBufferBuilder builder;
+    JsonObjectSerializer<KBufferBuilder> json { builder };
+    {
+        auto array = json.add_array("size_classes");
+        for (auto& size_class : stats.size_classes) {
+            size_t free_objects = size_class.free_count + size_class.cached_count;
+            auto obj = array.add_object();
+            obj.add("object_size", (u32)size_class.object_size);
+            obj.add("blocks", (u32)size_class.block_count);
+            obj.add("objects", (u32)size_class.object_count);
+            obj.add("allocated", (u32)(size_class.object_count - free_objects));
+            obj.add("free", (u32)size_class.free_count);
+            obj.add("cached", (u32)size_class.cached_count);
+            obj.add("free_bytes", (u32)(free_objects * size_class.object_size));
+            obj.finish();
+        }
+        array.finish();
+    }
+    {
+        auto pool = json.add_object("pool");
+        pool.add("size", (u32)stats.pool_size);
+        pool.add("allocated", (u32)stats.pool_allocated);
+        pool.add("free", (u32)stats.pool_free);
+        pool.add("largest_free_run", (u32)stats.pool_largest_free_run);
+        pool.add("free_runs", (u32)stats.pool_free_run_count);
+        pool.add("slab_blocks", (u32)stats.pool_slab_block_count);
+        pool.finish();
+    }
+    json.add("expanded_slab_blocks", (u32)stats.expanded_slab_block_count);
+    json.add("eternal_allocated", (u32)kmalloc_sum_eternal);
+    json.finish();
+    return builder.build();
+}
+
 Optional<KBuffer> procfs$all(InodeIdentifier)
 {
     InterruptDisabler disabler;
@@ -1619,6 +1677,7 @@ ProcFS::ProcFS()
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
+    m_entries[FI_Root_kmalloc] = { "kmalloc", FI_Root_kmalloc, false, procfs$kmalloc };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_inodes] = { "inodes", FI_Root_inodes, true, procfs$inodes };
     m_entries[FI_Root_dmesg] = { "dmesg", FI_Root_dmesg, true, procfs$dmesg };
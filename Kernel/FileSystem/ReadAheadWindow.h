@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// Detects sequential access to a file and tells the caller how much to read
+// ahead past each access. The window starts small, doubles with every access
+// that picks up where the previous one (or its read-ahead) ended, and
+// collapses as soon as the access pattern turns random.
+class ReadAheadWindow {
+public:
+    static constexpr size_t initial_size = 16 * KB;
+    static constexpr size_t max_size = 128 * KB;
+
+    // Returns the number of bytes following [offset, offset + size) to read ahead.
+    size_t did_access(off_t offset, size_t size)
+    {
+        bool is_sequential = offset == m_next_offset || offset == m_read_ahead_end;
+        if (!is_sequential)
+            m_size = 0;
+        else if (!m_size)
+            m_size = initial_size;
+        else
+            m_size = min(m_size * 2, max_size);
+
+        m_next_offset = offset + size;
+        m_read_ahead_end = m_next_offset + m_size;
+        return m_size;
+    }
+
+    // Lets the window know that read-ahead stopped short, e.g. at end of file.
+    void did_read_ahead(size_t size) { m_read_ahead_end = m_next_offset + size; }
+
+private:
+    off_t m_next_offset { 0 };
+    off_t m_read_ahead_end { 0 };
+    size_t m_size { 0 };
+};
+
+}
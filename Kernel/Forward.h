@@ -34,6 +34,8 @@ class Custody;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EPoll;
+class EPollInterest;
 class File;
 class FileDescription;
 class IPv4Socket;
@@ -25,17 +25,25 @@
  */
 
 /*
- * Really really *really* Q&D malloc() and free() implementations
- * just to get going. Don't ever let anyone see this shit. :^)
+ * Small allocations are served from power-of-two size classes. Each class hands out
+ * objects carved from naturally aligned slab blocks, so kfree() can find an object's
+ * block header by masking its address. Every CPU keeps a small magazine of free objects
+ * per class in front of the shared per-class free list (the "depot").
+ *
+ * Slab blocks come from the fixed kmalloc pool first, and from MemoryManager once
+ * the pool is exhausted. Larger allocations are served from the pool directly.
  */
 
 #include <AK/Assertions.h>
+#include <AK/StringView.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Arch/i386/Processor.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
 #include <Kernel/Scheduler.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <LibBareMetal/StdLib.h>
 
 #define SANITIZE_KMALLOC
@@ -52,7 +60,54 @@ struct AllocationHeader {
 #define ETERNAL_BASE_PHYSICAL (0xc0000000 + (2 * MB))
 #define ETERNAL_RANGE_SIZE (2 * MB)
 
+#define MIN_SIZE_CLASS_SHIFT 4
+#define MAX_SIZE_CLASS_SIZE (1u << (MIN_SIZE_CLASS_SHIFT + KMALLOC_SIZE_CLASS_COUNT - 1))
+
+#define SLAB_BLOCK_SIZE (32 * KB)
+#define SLAB_BLOCK_HEADER_SIZE 64
+#define SLAB_BLOCK_MAGIC 0x51ab0c4d
+
+// Once kmalloc can grow, slab blocks stop coming from the pool when this much of it is left,
+// since allocations too large for the size classes can only be served from the pool.
+#define POOL_RESERVE_FOR_LARGE_ALLOCATIONS (1 * MB)
+
+#define MAGAZINE_SIZE 16
+
+struct SlabBlockHeader {
+    u32 magic;
+    u32 size_class;
+};
+
+static_assert(sizeof(SlabBlockHeader) <= SLAB_BLOCK_HEADER_SIZE);
+static_assert(BASE_PHYSICAL % SLAB_BLOCK_SIZE == 0);
+static_assert(POOL_SIZE % SLAB_BLOCK_SIZE == 0);
+
+struct FreeObject {
+    FreeObject* next;
+};
+
+struct SizeClass {
+    FreeObject* free_list;
+    size_t free_count;
+    size_t block_count;
+    size_t object_count;
+};
+
+struct Magazine {
+    size_t count;
+    void* rounds[MAGAZINE_SIZE];
+};
+
 static u8 alloc_map[POOL_SIZE / CHUNK_SIZE / 8];
+static bool s_pool_slab_blocks[POOL_SIZE / SLAB_BLOCK_SIZE];
+
+static SizeClass s_size_classes[KMALLOC_SIZE_CLASS_COUNT];
+static Magazine s_magazines[Kernel::Processor::max_count][KMALLOC_SIZE_CLASS_COUNT];
+
+static size_t s_pool_free;
+static size_t s_expanded_slab_block_count;
+static bool s_expansion_enabled;
+static bool s_expanding;
 
 volatile size_t sum_alloc = 0;
 volatile size_t sum_free = POOL_SIZE;
@@ -68,16 +123,29 @@ static u8* s_end_of_eternal_range;
 void kmalloc_init()
 {
     memset(&alloc_map, 0, sizeof(alloc_map));
+    memset(&s_pool_slab_blocks, 0, sizeof(s_pool_slab_blocks));
+    memset(&s_size_classes, 0, sizeof(s_size_classes));
+    memset(&s_magazines, 0, sizeof(s_magazines));
     memset((void*)BASE_PHYSICAL, 0, POOL_SIZE);
 
     kmalloc_sum_eternal = 0;
     sum_alloc = 0;
     sum_free = POOL_SIZE;
 
+    s_pool_free = POOL_SIZE;
+    s_expanded_slab_block_count = 0;
+    s_expansion_enabled = false;
+    s_expanding = false;
+
     s_next_eternal_ptr = (u8*)ETERNAL_BASE_PHYSICAL;
     s_end_of_eternal_range = s_next_eternal_ptr + ETERNAL_RANGE_SIZE;
 }
 
+void kmalloc_enable_expansion()
+{
+    s_expansion_enabled = true;
+}
+
 void* kmalloc_eternal(size_t size)
 {
     void* ptr = s_next_eternal_ptr;
@@ -109,24 +177,22 @@ void* kmalloc_page_aligned(size_t size)
     return ptr;
 }
 
-void* kmalloc_impl(size_t size)
+static void mark_pool_chunks(size_t first_chunk, size_t chunk_count, bool in_use)
 {
-    Kernel::InterruptDisabler disabler;
-    ++g_kmalloc_call_count;
-
-    if (g_dump_kmalloc_stacks && Kernel::ksyms_ready) {
-        dbg() << "kmalloc(" << size << ")";
-        Kernel::dump_backtrace();
+    for (size_t k = first_chunk; k < first_chunk + chunk_count; ++k) {
+        if (in_use)
+            alloc_map[k / 8] |= 1 << (k % 8);
+        else
+            alloc_map[k / 8] &= ~(1 << (k % 8));
     }
+}
 
+static void* allocate_from_pool(size_t size)
+{
     // We need space for the AllocationHeader at the head of the block.
     size_t real_size = size + sizeof(AllocationHeader);
-
-    if (sum_free < real_size) {
-        Kernel::dump_backtrace();
-        klog() << "kmalloc(): PANIC! Out of memory (sucks, dude)\nsum_free=" << sum_free << ", real_size=" << real_size;
-        Kernel::hang();
-    }
+    if (s_pool_free < real_size)
+        return nullptr;
 
     size_t chunks_needed = real_size / CHUNK_SIZE;
     if (real_size % CHUNK_SIZE)
@@ -156,12 +222,11 @@ void* kmalloc_impl(size_t size)
                     u8* ptr = a->data;
                     a->allocation_size_in_chunks = chunks_needed;
 
-                    for (size_t k = first_chunk; k < (first_chunk + chunks_needed); ++k) {
-                        alloc_map[k / 8] |= 1 << (k % 8);
-                    }
+                    mark_pool_chunks(first_chunk, chunks_needed, true);
 
                     sum_alloc += a->allocation_size_in_chunks * CHUNK_SIZE;
                     sum_free -= a->allocation_size_in_chunks * CHUNK_SIZE;
+                    s_pool_free -= a->allocation_size_in_chunks * CHUNK_SIZE;
 #ifdef SANITIZE_KMALLOC
                     memset(ptr, KMALLOC_SCRUB_BYTE, (a->allocation_size_in_chunks * CHUNK_SIZE) - sizeof(AllocationHeader));
 #endif
@@ -174,33 +239,229 @@ void* kmalloc_impl(size_t size)
         }
     }
 
-    klog() << "kmalloc(): PANIC! Out of memory (no suitable block for size " << size << ")";
-    Kernel::dump_backtrace();
-    Kernel::hang();
+    return nullptr;
 }
 
-void kfree(void* ptr)
+static void free_to_pool(void* ptr)
 {
-    if (!ptr)
-        return;
-
-    Kernel::InterruptDisabler disabler;
-    ++g_kfree_call_count;
-
     auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
     FlatPtr start = ((FlatPtr)a - (FlatPtr)BASE_PHYSICAL) / CHUNK_SIZE;
 
-    for (size_t k = start; k < (start + a->allocation_size_in_chunks); ++k)
-        alloc_map[k / 8] &= ~(1 << (k % 8));
+    mark_pool_chunks(start, a->allocation_size_in_chunks, false);
 
     sum_alloc -= a->allocation_size_in_chunks * CHUNK_SIZE;
     sum_free += a->allocation_size_in_chunks * CHUNK_SIZE;
+    s_pool_free += a->allocation_size_in_chunks * CHUNK_SIZE;
 
 #ifdef SANITIZE_KMALLOC
     memset(a, KFREE_SCRUB_BYTE, a->allocation_size_in_chunks * CHUNK_SIZE);
 #endif
 }
 
+static u8* allocate_slab_block_from_pool()
+{
+    constexpr size_t map_bytes_per_block = SLAB_BLOCK_SIZE / CHUNK_SIZE / 8;
+
+    // Take slab blocks from the top of the pool, so they don't compete with
+    // the first-fit scan for large allocations at the bottom.
+    for (size_t block = POOL_SIZE / SLAB_BLOCK_SIZE; block > 0; --block) {
+        size_t index = block - 1;
+        if (s_pool_slab_blocks[index])
+            continue;
+        bool is_free = true;
+        for (size_t i = 0; i < map_bytes_per_block; ++i) {
+            if (alloc_map[index * map_bytes_per_block + i]) {
+                is_free = false;
+                break;
+            }
+        }
+        if (!is_free)
+            continue;
+
+        mark_pool_chunks(index * (SLAB_BLOCK_SIZE / CHUNK_SIZE), SLAB_BLOCK_SIZE / CHUNK_SIZE, true);
+        s_pool_slab_blocks[index] = true;
+        sum_free -= SLAB_BLOCK_SIZE;
+        s_pool_free -= SLAB_BLOCK_SIZE;
+        return (u8*)(BASE_PHYSICAL + index * SLAB_BLOCK_SIZE);
+    }
+    return nullptr;
+}
+
+static u8* allocate_slab_block()
+{
+    // Growing means calling into MemoryManager, which allocates too. Those nested
+    // allocations have to make do with the pool, and we can't grow from IRQ handlers.
+    bool can_expand = s_expansion_enabled && !s_expanding && !Kernel::g_in_irq;
+
+    if (!can_expand || s_pool_free > POOL_RESERVE_FOR_LARGE_ALLOCATIONS) {
+        if (auto* block = allocate_slab_block_from_pool())
+            return block;
+    }
+
+    if (can_expand) {
+        s_expanding = true;
+        auto region = MM.allocate_aligned_kernel_region(SLAB_BLOCK_SIZE, SLAB_BLOCK_SIZE, "kmalloc", Kernel::Region::Access::Read | Kernel::Region::Access::Write);
+        s_expanding = false;
+        if (region) {
+            // Slab blocks are never given back, so the region lives forever.
+            ++s_expanded_slab_block_count;
+            return region.leak_ptr()->vaddr().as_ptr();
+        }
+    }
+
+    return allocate_slab_block_from_pool();
+}
+
+static size_t size_class_index(size_t size)
+{
+    if (size <= (1u << MIN_SIZE_CLASS_SHIFT))
+        return 0;
+    return (32 - __builtin_clz(size - 1)) - MIN_SIZE_CLASS_SHIFT;
+}
+
+static size_t size_class_object_size(size_t index)
+{
+    return 1u << (MIN_SIZE_CLASS_SHIFT + index);
+}
+
+static size_t objects_per_slab_block(size_t index)
+{
+    return (SLAB_BLOCK_SIZE - SLAB_BLOCK_HEADER_SIZE) / size_class_object_size(index);
+}
+
+static SlabBlockHeader* slab_block_containing(void* ptr)
+{
+    FlatPtr address = (FlatPtr)ptr;
+    if (address >= BASE_PHYSICAL && address < BASE_PHYSICAL + POOL_SIZE) {
+        if (!s_pool_slab_blocks[(address - BASE_PHYSICAL) / SLAB_BLOCK_SIZE])
+            return nullptr;
+    }
+    auto* header = (SlabBlockHeader*)(address & ~(FlatPtr)(SLAB_BLOCK_SIZE - 1));
+    ASSERT(header->magic == SLAB_BLOCK_MAGIC);
+    return header;
+}
+
+static bool grow_size_class(size_t index)
+{
+    u8* block = allocate_slab_block();
+    if (!block)
+        return false;
+
+    auto* header = (SlabBlockHeader*)block;
+    header->magic = SLAB_BLOCK_MAGIC;
+    header->size_class = index;
+
+    auto& size_class = s_size_classes[index];
+    size_t object_size = size_class_object_size(index);
+    size_t object_count = objects_per_slab_block(index);
+
+    // Thread the objects onto the free list back to front, so they're handed out in address order.
+    for (size_t i = object_count; i > 0; --i) {
+        auto* object = (FreeObject*)(block + SLAB_BLOCK_HEADER_SIZE + (i - 1) * object_size);
+        object->next = size_class.free_list;
+        size_class.free_list = object;
+    }
+    size_class.free_count += object_count;
+    size_class.object_count += object_count;
+    ++size_class.block_count;
+    sum_free += object_count * object_size;
+    return true;
+}
+
+static Magazine& current_magazine(size_t index)
+{
+    // Processor::current() isn't usable until the BSP has been set up.
+    size_t processor_id = Kernel::Processor::count() > 1 ? Kernel::Processor::current().id() : 0;
+    return s_magazines[processor_id][index];
+}
+
+static void* allocate_from_size_class(size_t index)
+{
+    auto& magazine = current_magazine(index);
+    if (magazine.count == 0) {
+        // Refill half a magazine from the depot, so a following free doesn't have to flush it right away.
+        auto& size_class = s_size_classes[index];
+        if (!size_class.free_list && !grow_size_class(index))
+            return nullptr;
+        while (magazine.count < MAGAZINE_SIZE / 2 && size_class.free_list) {
+            auto* object = size_class.free_list;
+            size_class.free_list = object->next;
+            --size_class.free_count;
+            magazine.rounds[magazine.count++] = object;
+        }
+    }
+
+    void* ptr = magazine.rounds[--magazine.count];
+    size_t object_size = size_class_object_size(index);
+    sum_alloc += object_size;
+    sum_free -= object_size;
+#ifdef SANITIZE_KMALLOC
+    memset(ptr, KMALLOC_SCRUB_BYTE, object_size);
+#endif
+    return ptr;
+}
+
+static void free_to_size_class(size_t index, void* ptr)
+{
+    size_t object_size = size_class_object_size(index);
+    sum_alloc -= object_size;
+    sum_free += object_size;
+#ifdef SANITIZE_KMALLOC
+    memset(ptr, KFREE_SCRUB_BYTE, object_size);
+#endif
+
+    auto& magazine = current_magazine(index);
+    if (magazine.count == MAGAZINE_SIZE) {
+        auto& size_class = s_size_classes[index];
+        while (magazine.count > MAGAZINE_SIZE / 2) {
+            auto* object = (FreeObject*)magazine.rounds[--magazine.count];
+            object->next = size_class.free_list;
+            size_class.free_list = object;
+            ++size_class.free_count;
+        }
+    }
+    magazine.rounds[magazine.count++] = ptr;
+}
+
+void* kmalloc_impl(size_t size)
+{
+    Kernel::InterruptDisabler disabler;
+    ++g_kmalloc_call_count;
+
+    if (g_dump_kmalloc_stacks && Kernel::ksyms_ready) {
+        dbg() << "kmalloc(" << size << ")";
+        Kernel::dump_backtrace();
+    }
+
+    void* ptr = nullptr;
+    if (size <= MAX_SIZE_CLASS_SIZE)
+        ptr = allocate_from_size_class(size_class_index(size));
+    // If a size class can't get another slab block, the pool may still have room for a small allocation.
+    if (!ptr)
+        ptr = allocate_from_pool(size);
+
+    if (!ptr) {
+        klog() << "kmalloc(): PANIC! Out of memory (no suitable block for size " << size << ")";
+        Kernel::dump_backtrace();
+        Kernel::hang();
+    }
+    return ptr;
+}
+
+void kfree(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    Kernel::InterruptDisabler disabler;
+    ++g_kfree_call_count;
+
+    if (auto* header = slab_block_containing(ptr))
+        free_to_size_class(header->size_class, ptr);
+    else
+        free_to_pool(ptr);
+}
+
 void* krealloc(void* ptr, size_t new_size)
 {
     if (!ptr)
@@ -208,11 +469,17 @@ void* krealloc(void* ptr, size_t new_size)
 
     Kernel::InterruptDisabler disabler;
 
-    auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
-    size_t old_size = a->allocation_size_in_chunks * CHUNK_SIZE;
-
-    if (old_size == new_size)
-        return ptr;
+    size_t old_size;
+    if (auto* header = slab_block_containing(ptr)) {
+        if (new_size <= MAX_SIZE_CLASS_SIZE && size_class_index(new_size) == header->size_class)
+            return ptr;
+        old_size = size_class_object_size(header->size_class);
+    } else {
+        auto* a = (AllocationHeader*)((((u8*)ptr) - sizeof(AllocationHeader)));
+        old_size = a->allocation_size_in_chunks * CHUNK_SIZE - sizeof(AllocationHeader);
+        if (old_size == new_size)
+            return ptr;
+    }
 
     auto* new_ptr = kmalloc(new_size);
     memcpy(new_ptr, ptr, min(old_size, new_size));
@@ -220,6 +487,51 @@ void* krealloc(void* ptr, size_t new_size)
     return new_ptr;
 }
 
+void kmalloc_get_stats(KmallocStats& stats)
+{
+    Kernel::InterruptDisabler disabler;
+
+    for (size_t index = 0; index < KMALLOC_SIZE_CLASS_COUNT; ++index) {
+        auto& size_class = s_size_classes[index];
+        auto& class_stats = stats.size_classes[index];
+        class_stats.object_size = size_class_object_size(index);
+        class_stats.block_count = size_class.block_count;
+        class_stats.object_count = size_class.object_count;
+        class_stats.free_count = size_class.free_count;
+        class_stats.cached_count = 0;
+        for (size_t processor_id = 0; processor_id < Kernel::Processor::max_count; ++processor_id)
+            class_stats.cached_count += s_magazines[processor_id][index].count;
+    }
+
+    stats.pool_size = POOL_SIZE;
+    stats.pool_slab_block_count = 0;
+    for (size_t block = 0; block < POOL_SIZE / SLAB_BLOCK_SIZE; ++block) {
+        if (s_pool_slab_blocks[block])
+            ++stats.pool_slab_block_count;
+    }
+    stats.expanded_slab_block_count = s_expanded_slab_block_count;
+
+    size_t free_chunks = 0;
+    size_t largest_free_run = 0;
+    size_t free_run_count = 0;
+    size_t chunks_here = 0;
+    for (size_t k = 0; k < POOL_SIZE / CHUNK_SIZE; ++k) {
+        if (alloc_map[k / 8] & (1 << (k % 8))) {
+            chunks_here = 0;
+            continue;
+        }
+        if (chunks_here == 0)
+            ++free_run_count;
+        ++chunks_here;
+        ++free_chunks;
+        largest_free_run = max(largest_free_run, chunks_here);
+    }
+    stats.pool_free = free_chunks * CHUNK_SIZE;
+    stats.pool_allocated = POOL_SIZE - stats.pool_free - stats.pool_slab_block_count * SLAB_BLOCK_SIZE;
+    stats.pool_largest_free_run = largest_free_run * CHUNK_SIZE;
+    stats.pool_free_run_count = free_run_count;
+}
+
 void* operator new(size_t size)
 {
     return kmalloc(size);
@@ -33,7 +33,31 @@
 #define KMALLOC_SCRUB_BYTE 0xbb
 #define KFREE_SCRUB_BYTE 0xaa
 
+// Allocations up to 2 KB are served from power-of-two size classes starting at 16 bytes.
+#define KMALLOC_SIZE_CLASS_COUNT 8
+
+struct KmallocSizeClassStats {
+    size_t object_size;
+    size_t block_count;
+    size_t object_count;
+    size_t free_count;
+    size_t cached_count;
+};
+
+struct KmallocStats {
+    KmallocSizeClassStats size_classes[KMALLOC_SIZE_CLASS_COUNT];
+    size_t pool_size;
+    size_t pool_allocated;
+    size_t pool_free;
+    size_t pool_largest_free_run;
+    size_t pool_free_run_count;
+    size_t pool_slab_block_count;
+    size_t expanded_slab_block_count;
+};
+
 void kmalloc_init();
+void kmalloc_enable_expansion();
+void kmalloc_get_stats(KmallocStats&);
 [[gnu::malloc, gnu::returns_nonnull, gnu::alloc_size(1)]] void* kmalloc_impl(size_t);
 [[gnu::malloc, gnu::returns_nonnull, gnu::alloc_size(1)]] void* kmalloc_eternal(size_t);
 [[gnu::malloc, gnu::returns_nonnull, gnu::alloc_size(1)]] void* kmalloc_page_aligned(size_t);
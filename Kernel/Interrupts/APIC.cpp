@@ -28,15 +28,18 @@
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Arch/i386/Processor.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <LibBareMetal/IO.h>
+#include <LibBareMetal/StdLib.h>
 
 #define IRQ_APIC_SPURIOUS 0x7f
 
 #define APIC_BASE_MSR 0x1b
 
+#define APIC_REG_ID 0x20
 #define APIC_REG_EOI 0xb0
 #define APIC_REG_LD 0xd0
 #define APIC_REG_DF 0xe0
@@ -86,17 +89,24 @@ public:
         AllExcludingSelf = 0x3,
     };
 
-    ICRReg(u8 vector, DeliveryMode delivery_mode, DestinationMode destination_mode, Level level, TriggerMode trigger_mode, DestinationShorthand destination)
-        : m_reg(vector | (delivery_mode << 8) | (destination_mode << 11) | (level << 14) | (static_cast<u32>(trigger_mode) << 15) | (destination << 18))
+    ICRReg(u8 vector, DeliveryMode delivery_mode, DestinationMode destination_mode, Level level, TriggerMode trigger_mode, DestinationShorthand destination_shorthand, u8 destination = 0)
+        : m_reg(vector | (delivery_mode << 8) | (destination_mode << 11) | (level << 14) | (static_cast<u32>(trigger_mode) << 15) | (destination_shorthand << 18))
+        , m_destination(destination)
     {
     }
 
     u32 low() const { return m_reg; }
-    u32 high() const { return 0; }
+    u32 high() const { return m_destination << 24; }
+
+private:
+    u32 m_destination { 0 };
 };
 
 static volatile u8* g_apic_base = nullptr;
 
+// The local APIC registers are mapped once, since every CPU's local APIC shows up at the same address.
+static Region* s_apic_region = nullptr;
+
 static PhysicalAddress get_base()
 {
     u32 lo, hi;
@@ -113,36 +123,116 @@ static void set_base(const PhysicalAddress& base)
     msr.set(lo, hi);
 }
 
+static volatile u32* register_pointer(u32 offset)
+{
+    ASSERT(s_apic_region);
+    return (volatile u32*)s_apic_region->vaddr().offset(offset_in_page((u32)g_apic_base)).offset(offset).as_ptr();
+}
+
 static void write_register(u32 offset, u32 value)
 {
-    auto lapic_region = MM.allocate_kernel_region(PhysicalAddress(page_base_of((u32)g_apic_base)), PAGE_SIZE, "LAPIC Write Access", Region::Access::Read | Region::Access::Write, false, true);
-    auto* lapic = (volatile u32*)lapic_region->vaddr().offset(offset_in_page((u32)g_apic_base)).offset(offset).as_ptr();
-    *lapic = value;
+    *register_pointer(offset) = value;
 }
 
 static u32 read_register(u32 offset)
 {
-    auto lapic_region = MM.allocate_kernel_region(PhysicalAddress(page_base_of((u32)g_apic_base)), PAGE_SIZE, "LAPIC Read Access", Region::Access::Read, false, true);
-    auto* lapic = (volatile u32*)lapic_region->vaddr().offset(offset_in_page((u32)g_apic_base)).offset(offset).as_ptr();
-    return *lapic;
+    return *register_pointer(offset);
 }
 
 static void write_icr(const ICRReg& icr)
 {
     write_register(APIC_REG_ICR_HIGH, icr.high());
     write_register(APIC_REG_ICR_LOW, icr.low());
+
+    // Wait for the local APIC to accept the IPI.
+    while (read_register(APIC_REG_ICR_LOW) & (1 << 12))
+        ;
+}
+
+static void delay_microseconds(u32 microseconds)
+{
+    // IO::delay() takes around 3 microseconds.
+    for (u32 i = 0; i < microseconds; i += 3)
+        IO::delay();
 }
 
 #define APIC_LVT_MASKED (1 << 16)
 #define APIC_LVT_TRIGGER_LEVEL (1 << 14)
 #define APIC_LVT(iv, dm) ((iv & 0xff) | ((dm & 0x7) << 8))
 
+// Application processors start out in real mode, at the page given in the startup IPI.
+// This code is copied there. It switches to protected mode with a temporary GDT, loads the
+// control registers the BSP filled in below, turns on paging in the kernel's address space
+// (which maps this page 1:1 while APs start up), and calls init_ap() on the AP's idle stack.
+// NOTE: The code below hardcodes ap_startup_address (0x8000).
+static constexpr u32 ap_startup_address = 0x8000;
+
 asm(
     ".globl apic_ap_start \n"
     ".type apic_ap_start, @function \n"
     "apic_ap_start: \n"
     ".set begin_apic_ap_start, . \n"
-    "    jmp apic_ap_start\n" // TODO: implement
+    ".code16 \n"
+    "    cli \n"
+    "    ljmp $(0x8000 >> 4), $(1f - begin_apic_ap_start) \n"
+    "1: \n"
+    "    mov %cs, %ax \n"
+    "    mov %ax, %ds \n"
+    "    lgdtl (apic_ap_start_gdtr - begin_apic_ap_start) \n"
+    "    movl %cr0, %eax \n"
+    "    orl $1, %eax \n"
+    "    movl %eax, %cr0 \n"
+    "    ljmpl $0x8, $(0x8000 + 2f - begin_apic_ap_start) \n"
+    ".code32 \n"
+    "2: \n"
+    "    movw $0x10, %ax \n"
+    "    movw %ax, %ds \n"
+    "    movw %ax, %es \n"
+    "    movw %ax, %fs \n"
+    "    movw %ax, %gs \n"
+    "    movw %ax, %ss \n"
+    "    movl $0x8000, %ebx \n"
+    "    movl (apic_ap_start_cr3 - begin_apic_ap_start)(%ebx), %eax \n"
+    "    movl %eax, %cr3 \n"
+    "    movl (apic_ap_start_cr4 - begin_apic_ap_start)(%ebx), %eax \n"
+    "    movl %eax, %cr4 \n"
+    "    cmpl $0, (apic_ap_start_nx - begin_apic_ap_start)(%ebx) \n"
+    "    je 3f \n"
+    "    movl $0xc0000080, %ecx \n"
+    "    rdmsr \n"
+    "    orl $0x800, %eax \n"
+    "    wrmsr \n"
+    "3: \n"
+    "    movl (apic_ap_start_cr0 - begin_apic_ap_start)(%ebx), %eax \n"
+    "    movl %eax, %cr0 \n"
+    "    movl (apic_ap_start_stack - begin_apic_ap_start)(%ebx), %esp \n"
+    "    pushl (apic_ap_start_cpu - begin_apic_ap_start)(%ebx) \n"
+    "    pushl $0 \n"
+    "    movl (apic_ap_start_entry - begin_apic_ap_start)(%ebx), %eax \n"
+    "    jmp *%eax \n"
+    ".align 8 \n"
+    "apic_ap_start_gdt: \n"
+    "    .quad 0x0000000000000000 \n"
+    "    .quad 0x00cf9a000000ffff \n"
+    "    .quad 0x00cf92000000ffff \n"
+    "apic_ap_start_gdtr: \n"
+    "    .word 23 \n"
+    "    .long 0x8000 + apic_ap_start_gdt - begin_apic_ap_start \n"
+    ".align 4 \n"
+    ".globl apic_ap_start_cr0 \n"
+    "apic_ap_start_cr0: .long 0 \n"
+    ".globl apic_ap_start_cr3 \n"
+    "apic_ap_start_cr3: .long 0 \n"
+    ".globl apic_ap_start_cr4 \n"
+    "apic_ap_start_cr4: .long 0 \n"
+    ".globl apic_ap_start_nx \n"
+    "apic_ap_start_nx: .long 0 \n"
+    ".globl apic_ap_start_stack \n"
+    "apic_ap_start_stack: .long 0 \n"
+    ".globl apic_ap_start_cpu \n"
+    "apic_ap_start_cpu: .long 0 \n"
+    ".globl apic_ap_start_entry \n"
+    "apic_ap_start_entry: .long 0 \n"
     ".set end_apic_ap_start, . \n"
     "\n"
     ".globl apic_ap_start_size \n"
@@ -151,6 +241,15 @@ asm(
 
 extern "C" void apic_ap_start(void);
 extern "C" u16 apic_ap_start_size;
+extern "C" u32 apic_ap_start_cr0;
+extern "C" u32 apic_ap_start_cr3;
+extern "C" u32 apic_ap_start_cr4;
+extern "C" u32 apic_ap_start_nx;
+extern "C" u32 apic_ap_start_stack;
+extern "C" u32 apic_ap_start_cpu;
+extern "C" u32 apic_ap_start_entry;
+
+extern "C" [[noreturn]] void init_ap(u32 cpu);
 
 void eoi()
 {
@@ -178,10 +277,16 @@ bool init()
     set_base(apic_base);
 
     g_apic_base = apic_base.as_ptr();
+    s_apic_region = MM.allocate_kernel_region(apic_base.page_base(), PAGE_SIZE, "Local APIC", Region::Access::Read | Region::Access::Write, false, false).leak_ptr();
 
     return true;
 }
 
+u8 current_id()
+{
+    return read_register(APIC_REG_ID) >> 24;
+}
+
 void enable_bsp()
 {
     // FIXME: Ensure this method can only be executed by the BSP.
@@ -203,7 +308,8 @@ void enable(u32 cpu)
     // set destination id (note that this limits it to 8 cpus)
     write_register(APIC_REG_LD, 0);
 
-    SpuriousInterruptHandler::initialize(IRQ_APIC_SPURIOUS);
+    if (cpu == 0)
+        SpuriousInterruptHandler::initialize(IRQ_APIC_SPURIOUS);
 
     write_register(APIC_REG_LVT_TIMER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
     write_register(APIC_REG_LVT_THERMAL, APIC_LVT(0, 0) | APIC_LVT_MASKED);
@@ -213,24 +319,64 @@ void enable(u32 cpu)
     write_register(APIC_REG_LVT_ERR, APIC_LVT(0, 0) | APIC_LVT_MASKED);
 
     write_register(APIC_REG_TPR, 0);
+}
 
-    if (cpu != 0) {
-        static volatile u32 foo = 0;
+void boot_aps()
+{
+    ASSERT(Processor::current().is_bsp());
+    if (Processor::count() == 1)
+        return;
+
+    PhysicalAddress startup_address(ap_startup_address);
+    auto startup_region = MM.allocate_kernel_region(startup_address, PAGE_SIZE, "AP startup", Region::Access::Read | Region::Access::Write);
+    u8* startup_code = startup_region->vaddr().as_ptr();
+    ASSERT(apic_ap_start_size <= PAGE_SIZE);
+    memcpy(startup_code, (const void*)apic_ap_start, apic_ap_start_size);
+
+    auto set_startup_variable = [&](u32& variable, u32 value) {
+        *(u32*)(startup_code + ((const u8*)&variable - (const u8*)apic_ap_start)) = value;
+    };
 
-        // INIT
-        write_icr(ICRReg(0, ICRReg::INIT, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::AllExcludingSelf));
+    u32 cr0;
+    u32 cr4;
+    asm volatile("movl %%cr0, %%eax"
+                 : "=a"(cr0));
+    asm volatile("movl %%cr4, %%eax"
+                 : "=a"(cr4));
+    set_startup_variable(apic_ap_start_cr0, cr0);
+    set_startup_variable(apic_ap_start_cr3, read_cr3());
+    set_startup_variable(apic_ap_start_cr4, cr4);
+    set_startup_variable(apic_ap_start_nx, g_cpu_supports_nx);
+    set_startup_variable(apic_ap_start_entry, (u32)&init_ap);
+
+    MM.map_ap_startup_page(startup_address);
+
+    // APs are started one at a time, since they share the variables in the startup page.
+    Processor::for_each([&](Processor& processor) {
+        if (processor.is_bsp())
+            return;
+        set_startup_variable(apic_ap_start_stack, processor.idle_stack_top().get());
+        set_startup_variable(apic_ap_start_cpu, processor.id());
+
+        write_icr(ICRReg(0, ICRReg::INIT, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::NoShorthand, processor.apic_id()));
+        delay_microseconds(10000);
+
+        u8 startup_vector = ap_startup_address >> 12;
+        for (int i = 0; i < 2 && !processor.is_online(); ++i) {
+            write_icr(ICRReg(startup_vector, ICRReg::StartUp, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::NoShorthand, processor.apic_id()));
+            delay_microseconds(200);
+        }
 
-        for (foo = 0; foo < 0x800000; foo++)
-            ; // TODO: 10 millisecond delay
+        for (int i = 0; i < 100 && !processor.is_online(); ++i)
+            delay_microseconds(1000);
 
-        for (int i = 0; i < 2; i++) {
-            // SIPI
-            write_icr(ICRReg(0x08, ICRReg::StartUp, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::AllExcludingSelf)); // start execution at P8000
+        if (processor.is_online())
+            klog() << "APIC: CPU #" << processor.id() << " (APIC ID " << (u32)processor.apic_id() << ") is online";
+        else
+            klog() << "APIC: CPU #" << processor.id() << " (APIC ID " << (u32)processor.apic_id() << ") did not come up";
+    });
 
-            for (foo = 0; foo < 0x80000; foo++)
-                ; // TODO: 200 microsecond delay
-        }
-    }
+    MM.unmap_ap_startup_page(startup_address);
 }
 
 }
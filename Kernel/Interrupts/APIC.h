@@ -36,6 +36,8 @@ void enable_bsp();
 void eoi();
 bool init();
 void enable(u32 cpu);
+void boot_aps();
+u8 current_id();
 u8 spurious_interrupt_vector();
 }
 
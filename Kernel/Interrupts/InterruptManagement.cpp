@@ -27,6 +27,7 @@
 #include <AK/FixedArray.h>
 #include <AK/StringView.h>
 #include <Kernel/ACPI/MultiProcessorParser.h>
+#include <Kernel/Arch/i386/Processor.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Interrupts/APIC.h>
 #include <Kernel/Interrupts/IOAPIC.h>
@@ -187,6 +188,12 @@ void InterruptManagement::switch_to_ioapic_mode()
     APIC::init();
     APIC::enable_bsp();
     MultiProcessorParser::initialize();
+
+    for (auto apic_id : m_processor_apic_ids) {
+        if (apic_id != Processor::bsp().apic_id())
+            Processor::create_ap(apic_id);
+    }
+    APIC::boot_aps();
 }
 
 void InterruptManagement::locate_apic_data()
@@ -205,6 +212,12 @@ void InterruptManagement::locate_apic_data()
     auto* madt_entry = madt.entries;
     while (entries_length > 0) {
         size_t entry_length = madt_entry->length;
+        if (madt_entry->type == (u8)ACPI::Structures::MADTEntryType::LocalAPIC) {
+            auto* local_apic_entry = (const ACPI::Structures::MADTEntries::ProcessorLocalAPIC*)madt_entry;
+            // Bit 0 of the flags says whether the processor is enabled.
+            if (local_apic_entry->flags & 1)
+                m_processor_apic_ids.append(local_apic_entry->apic_id);
+        }
         if (madt_entry->type == (u8)ACPI::Structures::MADTEntryType::IOAPIC) {
             auto* ioapic_entry = (const ACPI::Structures::MADTEntries::IOAPIC*)madt_entry;
             dbg() << "IOAPIC found @ MADT entry " << entry_index << ", MMIO Registers @ Px" << String::format("%x", ioapic_entry->ioapic_address);
@@ -30,7 +30,7 @@
 
 namespace Kernel {
 
-void Lock::lock()
+void Lock::lock(Mode mode)
 {
     ASSERT(!Scheduler::is_active());
     if (!are_interrupts_enabled()) {
@@ -38,15 +38,29 @@ void Lock::lock()
         dump_backtrace();
         hang();
     }
+    bool is_waiting_shared = false;
     for (;;) {
         bool expected = false;
         if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            if (!m_holder || m_holder == Thread::current) {
+            if (is_waiting_shared) {
+                --m_shared_waiters;
+                is_waiting_shared = false;
+            }
+            if (m_holder == Thread::current || (mode == Mode::Exclusive && !m_holder && !m_shared_holders)) {
                 m_holder = Thread::current;
                 ++m_level;
                 m_lock.store(false, AK::memory_order_release);
                 return;
             }
+            if (mode == Mode::Shared && !m_holder) {
+                ++m_shared_holders;
+                m_lock.store(false, AK::memory_order_release);
+                return;
+            }
+            if (mode == Mode::Shared) {
+                ++m_shared_waiters;
+                is_waiting_shared = true;
+            }
             Thread::current->wait_on(m_queue, &m_lock, m_holder, m_name);
         }
     }
@@ -57,15 +71,28 @@ void Lock::unlock()
     for (;;) {
         bool expected = false;
         if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            ASSERT(m_holder == Thread::current);
-            ASSERT(m_level);
-            --m_level;
-            if (m_level) {
-                m_lock.store(false, AK::memory_order_release);
-                return;
+            if (m_holder) {
+                ASSERT(m_holder == Thread::current);
+                ASSERT(m_level);
+                --m_level;
+                if (m_level) {
+                    m_lock.store(false, AK::memory_order_release);
+                    return;
+                }
+                m_holder = nullptr;
+            } else {
+                ASSERT(m_shared_holders);
+                --m_shared_holders;
+                if (m_shared_holders) {
+                    m_lock.store(false, AK::memory_order_release);
+                    return;
+                }
             }
-            m_holder = nullptr;
-            m_queue.wake_one(&m_lock);
+            // Any number of shared waiters may be able to proceed at once.
+            if (m_shared_waiters)
+                m_queue.wake_all(&m_lock);
+            else
+                m_queue.wake_one(&m_lock);
             return;
         }
         // I don't know *who* is using "m_lock", so just yield.
@@ -37,16 +37,26 @@ namespace Kernel {
 
 class Lock {
 public:
+    // A Lock is held either exclusively by a single thread (which may take it
+    // again recursively), or shared by any number of threads. A thread that
+    // already holds the lock exclusively may take it shared as well, which just
+    // nests the exclusive hold. Upgrading a shared hold to an exclusive one is
+    // not supported and will deadlock.
+    enum class Mode {
+        Exclusive,
+        Shared,
+    };
+
     Lock(const char* name = nullptr)
         : m_name(name)
     {
     }
     ~Lock() {}
 
-    void lock();
+    void lock(Mode = Mode::Exclusive);
     void unlock();
     bool force_unlock_if_locked();
-    bool is_locked() const { return m_holder; }
+    bool is_locked() const { return m_holder || m_shared_holders; }
     void clear_waiters();
 
     const char* name() const { return m_name; }
@@ -54,6 +64,8 @@ public:
 private:
     Atomic<bool> m_lock { false };
     u32 m_level { 0 };
+    u32 m_shared_holders { 0 };
+    u32 m_shared_waiters { 0 };
     Thread* m_holder { nullptr };
     const char* m_name { nullptr };
     WaitQueue m_queue;
@@ -61,17 +73,19 @@ private:
 
 class Locker {
 public:
-    [[gnu::always_inline]] inline explicit Locker(Lock& l)
+    [[gnu::always_inline]] inline explicit Locker(Lock& l, Lock::Mode mode = Lock::Mode::Exclusive)
         : m_lock(l)
+        , m_mode(mode)
     {
         lock();
     }
     [[gnu::always_inline]] inline ~Locker() { unlock(); }
     [[gnu::always_inline]] inline void unlock() { m_lock.unlock(); }
-    [[gnu::always_inline]] inline void lock() { m_lock.lock(); }
+    [[gnu::always_inline]] inline void lock() { m_lock.lock(m_mode); }
 
 private:
     Lock& m_lock;
+    Lock::Mode m_mode { Lock::Mode::Exclusive };
 };
 
 #define LOCKER(lock) Locker locker(lock)
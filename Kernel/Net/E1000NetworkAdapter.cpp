@@ -113,6 +113,8 @@ namespace Kernel {
 #define TSTA_LC (1 << 2) // Late Collision
 #define LSTA_TU (1 << 3) // Transmit Underrun
 
+#define RSTA_DD (1 << 0) // Descriptor Done
+
 // STATUS Register
 
 #define STATUS_FD 0x01
@@ -207,7 +209,9 @@ void E1000NetworkAdapter::handle_irq(const RegisterState&)
         out32(REG_CTRL, flags | ECTRL_SLU);
     }
     if (status & 0x80) {
-        receive();
+        // NetworkTask picks the packets up straight from the RX ring.
+        if (on_receive)
+            on_receive();
     }
     if (status & 0x10) {
         // Threshold OK?
@@ -272,13 +276,21 @@ bool E1000NetworkAdapter::link_up()
     return (in32(REG_STATUS) & STATUS_LU);
 }
 
+u8* E1000NetworkAdapter::rx_buffer(int index) const
+{
+    constexpr int buffers_per_page = PAGE_SIZE / rx_buffer_size;
+    return m_rx_buffers_regions[index / buffers_per_page]->vaddr().offset((index % buffers_per_page) * rx_buffer_size).as_ptr();
+}
+
 void E1000NetworkAdapter::initialize_rx_descriptors()
 {
-    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    constexpr int buffers_per_page = PAGE_SIZE / rx_buffer_size;
+    auto* rx_descriptors = this->rx_descriptors();
     for (int i = 0; i < number_of_rx_descriptors; ++i) {
         auto& descriptor = rx_descriptors[i];
-        m_rx_buffers_regions.append(MM.allocate_contiguous_kernel_region(PAGE_ROUND_UP(8192), "E1000 RX buffer", Region::Access::Read | Region::Access::Write));
-        descriptor.addr = m_rx_buffers_regions[i]->vmobject().physical_pages()[0]->paddr().get();
+        if (!(i % buffers_per_page))
+            m_rx_buffers_regions.append(MM.allocate_contiguous_kernel_region(PAGE_SIZE, "E1000 RX buffers", Region::Access::Read | Region::Access::Write));
+        descriptor.addr = m_rx_buffers_regions.last()->vmobject().physical_pages()[0]->paddr().offset((i % buffers_per_page) * rx_buffer_size).get();
         descriptor.status = 0;
     }
 
@@ -288,7 +300,7 @@ void E1000NetworkAdapter::initialize_rx_descriptors()
     out32(REG_RXDESCHEAD, 0);
     out32(REG_RXDESCTAIL, number_of_rx_descriptors - 1);
 
-    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_8192);
+    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_2048);
 }
 
 void E1000NetworkAdapter::initialize_tx_descriptors()
@@ -414,25 +426,36 @@ void E1000NetworkAdapter::send_raw(const u8* data, size_t length)
 #endif
 }
 
-void E1000NetworkAdapter::receive()
+bool E1000NetworkAdapter::has_queued_packets() const
 {
-    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
-    for (;;) {
-        rx_current = in32(REG_RXDESCTAIL);
-        if (rx_current == in32(REG_RXDESCHEAD))
-            return;
-        rx_current = (rx_current + 1) % number_of_rx_descriptors;
-        if (!(rx_descriptors[rx_current].status & 1))
-            break;
-        auto* buffer = m_rx_buffers_regions[rx_current]->vaddr().as_ptr();
-        u16 length = rx_descriptors[rx_current].length;
+    return rx_descriptors()[m_rx_current].status & RSTA_DD;
+}
+
+NetworkAdapter::ReceivedPacket E1000NetworkAdapter::next_received_packet()
+{
+    // The packet stays where the card put it, and its descriptor only goes back to the card once it's released.
+    auto& descriptor = rx_descriptors()[m_rx_current];
+    if (!(descriptor.status & RSTA_DD))
+        return {};
 #ifdef E1000_DEBUG
-        klog() << "E1000: Received 1 packet @ " << buffer << " (" << length << ") bytes!";
+    klog() << "E1000: Received 1 packet @ " << rx_buffer(m_rx_current) << " (" << descriptor.length << ") bytes!";
 #endif
-        did_receive(buffer, length);
-        rx_descriptors[rx_current].status = 0;
-        out32(REG_RXDESCTAIL, rx_current);
+    return { rx_buffer(m_rx_current), descriptor.length };
+}
+
+void E1000NetworkAdapter::release_received_packet()
+{
+    auto* rx_descriptors = this->rx_descriptors();
+    auto& descriptor = rx_descriptors[m_rx_current];
+    count_received_packet(descriptor.length);
+    descriptor.status = 0;
+    int released = m_rx_current;
+    m_rx_current = (m_rx_current + 1) % number_of_rx_descriptors;
+
+    // Every tail update is an MMIO write, so give descriptors back in batches, or once we've caught up with the card.
+    if (++m_rx_released_since_tail_update >= 16 || !(rx_descriptors[m_rx_current].status & RSTA_DD)) {
+        out32(REG_RXDESCTAIL, released);
+        m_rx_released_since_tail_update = 0;
     }
 }
 
@@ -46,6 +46,10 @@ public:
     virtual void send_raw(const u8*, size_t) override;
     virtual bool link_up() override;
 
+    virtual bool has_queued_packets() const override;
+    virtual ReceivedPacket next_received_packet() override;
+    virtual void release_received_packet() override;
+
     virtual const char* purpose() const override { return class_name(); }
 
 private:
@@ -90,7 +94,8 @@ private:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    e1000_rx_desc* rx_descriptors() const { return (e1000_rx_desc*)m_rx_descriptors_region->vaddr().as_ptr(); }
+    u8* rx_buffer(int index) const;
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
@@ -103,8 +108,12 @@ private:
     bool m_has_eeprom { false };
     bool m_use_mmio { false };
 
-    static const int number_of_rx_descriptors = 32;
+    int m_rx_current { 0 };
+    int m_rx_released_since_tail_update { 0 };
+
+    static const int number_of_rx_descriptors = 128;
     static const int number_of_tx_descriptors = 8;
+    static const size_t rx_buffer_size = 2048;
 
     WaitQueue m_wait_queue;
 };
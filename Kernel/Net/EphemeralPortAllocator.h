@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <Kernel/Lock.h>
+#include <Kernel/Random.h>
+
+namespace Kernel {
+
+// Hands out local ports from the ephemeral range, keeping track of the ones in use in a bitmap.
+// Each search starts at a random port, so ports aren't predictable, and it usually ends right there.
+class EphemeralPortAllocator {
+public:
+    static constexpr u16 first_port = 32768;
+    static constexpr u16 last_port = 60999;
+    static constexpr size_t port_count = last_port - first_port + 1;
+
+    EphemeralPortAllocator()
+        : m_ports_in_use(Bitmap::create(port_count, false))
+    {
+    }
+
+    // Offers free ports to the callback until it manages to claim one (it may not, if the port was bound explicitly).
+    // Returns the claimed port, or 0 if every port is in use.
+    template<typename Callback>
+    u16 allocate(Callback try_claim)
+    {
+        LOCKER(m_lock);
+        size_t start = get_good_random<u16>() % port_count;
+        size_t index = start;
+        bool wrapped = false;
+        for (;;) {
+            auto next = m_ports_in_use.find_next_unset(index);
+            if (!next.has_value() || (wrapped && next.value() >= start)) {
+                if (wrapped)
+                    return 0;
+                wrapped = true;
+                index = 0;
+                continue;
+            }
+            u16 port = first_port + next.value();
+            if (try_claim(port)) {
+                m_ports_in_use.set(next.value(), true);
+                return port;
+            }
+            index = next.value() + 1;
+        }
+    }
+
+    void release(u16 port)
+    {
+        ASSERT(port >= first_port && port <= last_port);
+        LOCKER(m_lock);
+        m_ports_in_use.set(port - first_port, false);
+    }
+
+private:
+    Bitmap m_ports_in_use;
+    Lock m_lock { "EphemeralPortAllocator" };
+};
+
+}
@@ -28,6 +28,7 @@
 
 #include <AK/Assertions.h>
 #include <AK/IPv4Address.h>
+#include <AK/InternetChecksum.h>
 #include <AK/NetworkOrdered.h>
 #include <AK/String.h>
 #include <AK/Types.h>
@@ -45,7 +46,12 @@ enum class IPv4PacketFlags : u16 {
     MoreFragments = 0x2000,
 };
 
-NetworkOrdered<u16> internet_checksum(const void*, size_t);
+inline NetworkOrdered<u16> internet_checksum(const void* ptr, size_t count)
+{
+    InternetChecksum checksum;
+    checksum.add(ptr, count);
+    return checksum.finish();
+}
 
 class [[gnu::packed]] IPv4Packet
 {
@@ -124,21 +130,18 @@ private:
 };
 
 static_assert(sizeof(IPv4Packet) == 20);
-const LogStream& operator<<(const LogStream& stream, const IPv4Packet& packet);
 
-inline NetworkOrdered<u16> internet_checksum(const void* ptr, size_t count)
+// The parts of the IPv4 header that the TCP and UDP checksums cover, along with their own header and payload.
+struct [[gnu::packed]] IPv4PseudoHeader
 {
-    u32 checksum = 0;
-    auto* w = (const u16*)ptr;
-    while (count > 1) {
-        checksum += convert_between_host_and_network(*w++);
-        if (checksum & 0x80000000)
-            checksum = (checksum & 0xffff) | (checksum >> 16);
-        count -= 2;
-    }
-    while (checksum >> 16)
-        checksum = (checksum & 0xffff) + (checksum >> 16);
-    return ~checksum & 0xffff;
-}
+    IPv4Address source;
+    IPv4Address destination;
+    u8 zero;
+    u8 protocol;
+    NetworkOrdered<u16> payload_size;
+};
+
+static_assert(sizeof(IPv4PseudoHeader) == 12);
+const LogStream& operator<<(const LogStream& stream, const IPv4Packet& packet);
 
 }
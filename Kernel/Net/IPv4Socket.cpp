@@ -193,7 +193,7 @@ int IPv4Socket::allocate_local_port_if_needed()
     return port;
 }
 
-ssize_t IPv4Socket::sendto(FileDescription&, const void* data, size_t data_length, int flags, const sockaddr* addr, socklen_t addr_length)
+ssize_t IPv4Socket::sendto(FileDescription& description, const void* data, size_t data_length, int flags, const sockaddr* addr, socklen_t addr_length)
 {
     (void)flags;
     if (addr && addr_length != sizeof(sockaddr_in))
@@ -230,6 +230,13 @@ ssize_t IPv4Socket::sendto(FileDescription&, const void* data, size_t data_lengt
         return data_length;
     }
 
+    if (type() == SOCK_STREAM && !can_write(description)) {
+        if (!description.is_blocking())
+            return -EAGAIN;
+        if (Thread::current->block<Thread::WriteBlocker>(description) != Thread::BlockResult::WokeNormally)
+            return -EINTR;
+    }
+
     int nsent = protocol_send(data, data_length);
     if (nsent > 0)
         Thread::current->did_ipv4_socket_write(nsent);
@@ -348,10 +355,13 @@ ssize_t IPv4Socket::recvfrom(FileDescription& description, void* buffer, size_t
 #endif
 
     ssize_t nreceived = 0;
-    if (buffer_mode() == BufferMode::Bytes)
+    if (buffer_mode() == BufferMode::Bytes) {
         nreceived = receive_byte_buffered(description, buffer, buffer_length, flags, addr, addr_length);
-    else
+        if (nreceived > 0)
+            protocol_did_read();
+    } else {
         nreceived = receive_packet_buffered(description, buffer, buffer_length, flags, addr, addr_length);
+    }
 
     if (nreceived > 0)
         Thread::current->did_ipv4_socket_read(nreceived);
@@ -368,13 +378,12 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
     auto packet_size = packet.size();
 
     if (buffer_mode() == BufferMode::Bytes) {
-        size_t space_in_receive_buffer = m_receive_buffer.space_for_writing();
-        if (packet_size > space_in_receive_buffer) {
+        int nreceived = protocol_receive(packet, m_scratch_buffer.value().data(), m_scratch_buffer.value().size(), 0);
+        if ((size_t)nreceived > m_receive_buffer.space_for_writing()) {
             dbg() << "IPv4Socket(" << this << "): did_receive refusing packet since buffer is full.";
             ASSERT(m_can_read);
             return false;
         }
-        int nreceived = protocol_receive(packet, m_scratch_buffer.value().data(), m_scratch_buffer.value().size(), 0);
         m_receive_buffer.write(m_scratch_buffer.value().data(), nreceived);
         m_can_read = !m_receive_buffer.is_empty();
     } else {
@@ -393,6 +402,7 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
     else
         dbg() << "IPv4Socket(" << this << "): did_receive " << packet_size << " bytes, total_received=" << m_bytes_received << ", packets in queue: " << m_receive_queue.size_slow();
 #endif
+    evaluate_block_conditions();
     return true;
 }
 
@@ -573,6 +583,7 @@ void IPv4Socket::shut_down_for_reading()
 {
     Socket::shut_down_for_reading();
     m_can_read = true;
+    evaluate_block_conditions();
 }
 
 }
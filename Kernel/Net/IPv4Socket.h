@@ -101,6 +101,10 @@ protected:
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) { return KSuccess; }
     virtual int protocol_allocate_local_port() { return 0; }
     virtual bool protocol_is_disconnected() const { return false; }
+    virtual void protocol_did_read() {}
+
+    size_t receive_buffer_capacity() const { return m_receive_buffer.capacity(); }
+    size_t receive_buffer_space() const { return m_receive_buffer.space_for_writing(); }
 
     virtual void shut_down_for_reading() override;
 
@@ -70,6 +70,13 @@ LocalSocket::LocalSocket(int type)
 #ifdef DEBUG_LOCAL_SOCKET
     dbg() << "LocalSocket{" << this << "} created with type=" << type;
 #endif
+
+    m_for_client.set_unblock_callback([this] {
+        evaluate_block_conditions();
+    });
+    m_for_server.set_unblock_callback([this] {
+        evaluate_block_conditions();
+    });
 }
 
 LocalSocket::~LocalSocket()
@@ -215,6 +222,7 @@ void LocalSocket::attach(FileDescription& description)
         ASSERT(m_connect_side_fd != &description);
         m_accept_side_fd_open = true;
     }
+    evaluate_block_conditions();
 }
 
 void LocalSocket::detach(FileDescription& description)
@@ -225,6 +233,7 @@ void LocalSocket::detach(FileDescription& description)
         ASSERT(m_accept_side_fd_open);
         m_accept_side_fd_open = false;
     }
+    evaluate_block_conditions();
 }
 
 bool LocalSocket::can_read(const FileDescription& description) const
@@ -26,6 +26,8 @@
 
 #include <Kernel/Net/LoopbackAdapter.h>
 
+//#define LOOPBACK_DEBUG
+
 namespace Kernel {
 
 LoopbackAdapter& LoopbackAdapter::the()
@@ -41,6 +43,8 @@ LoopbackAdapter::LoopbackAdapter()
     set_interface_name("loop");
     set_mtu(65536);
     set_mac_address({ 19, 85, 2, 9, 0x55, 0xaa });
+    // Room for a full window of maximum-size TCP segments, plus plenty of small ones.
+    create_receive_ring(1 * MB);
 }
 
 LoopbackAdapter::~LoopbackAdapter()
@@ -49,7 +53,9 @@ LoopbackAdapter::~LoopbackAdapter()
 
 void LoopbackAdapter::send_raw(const u8* data, size_t size)
 {
+#ifdef LOOPBACK_DEBUG
     dbg() << "LoopbackAdapter: Sending " << size << " byte(s) to myself.";
+#endif
     did_receive(data, size);
 }
 
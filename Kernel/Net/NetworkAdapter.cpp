@@ -32,7 +32,9 @@
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Random.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <LibBareMetal/StdLib.h>
 
 namespace Kernel {
@@ -102,19 +104,25 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
 
 void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, const u8* payload, size_t payload_size, u8 ttl)
 {
-    size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    if (ipv4_packet_size > mtu()) {
+    if (sizeof(IPv4Packet) + payload_size > mtu()) {
         send_ipv4_fragmented(destination_mac, destination_ipv4, protocol, payload, payload_size, ttl);
         return;
     }
 
-    size_t ethernet_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + payload_size;
-    auto buffer = ByteBuffer::create_zeroed(ethernet_frame_size);
-    auto& eth = *(EthernetFrameHeader*)buffer.data();
-    eth.set_source(mac_address());
-    eth.set_destination(destination_mac);
-    eth.set_ether_type(EtherType::IPv4);
-    auto& ipv4 = *(IPv4Packet*)eth.payload();
+    PacketBuffer packet(payload_size, sizeof(EthernetFrameHeader) + sizeof(IPv4Packet));
+    memcpy(packet.data(), payload, payload_size);
+    send_ipv4(destination_mac, destination_ipv4, protocol, packet, ttl);
+}
+
+void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, PacketBuffer& packet, u8 ttl)
+{
+    size_t payload_size = packet.size();
+    if (sizeof(IPv4Packet) + payload_size > mtu()) {
+        send_ipv4_fragmented(destination_mac, destination_ipv4, protocol, packet.data(), payload_size, ttl);
+        return;
+    }
+
+    auto& ipv4 = *(IPv4Packet*)packet.prepend(sizeof(IPv4Packet));
     ipv4.set_version(4);
     ipv4.set_internet_header_length(5);
     ipv4.set_source(ipv4_address());
@@ -124,10 +132,15 @@ void NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Addr
     ipv4.set_ident(1);
     ipv4.set_ttl(ttl);
     ipv4.set_checksum(ipv4.compute_checksum());
+
+    auto& eth = *(EthernetFrameHeader*)packet.prepend(sizeof(EthernetFrameHeader));
+    eth.set_source(mac_address());
+    eth.set_destination(destination_mac);
+    eth.set_ether_type(EtherType::IPv4);
+
     m_packets_out++;
-    m_bytes_out += ethernet_frame_size;
-    memcpy(ipv4.payload(), payload, payload_size);
-    send_raw((const u8*)&eth, ethernet_frame_size);
+    m_bytes_out += packet.size();
+    send_raw(packet.data(), packet.size());
 }
 
 void NetworkAdapter::send_ipv4_fragmented(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, const u8* payload, size_t payload_size, u8 ttl)
@@ -168,47 +181,96 @@ void NetworkAdapter::send_ipv4_fragmented(const MACAddress& destination_mac, con
     }
 }
 
+// Each packet in the receive ring is stored as its size followed by its data, padded to 4 bytes.
+// A packet never wraps around the end of the ring; if it doesn't fit there, it starts over at the beginning,
+// and a zero size (or the end of the ring itself) tells the reader to do the same.
+static size_t receive_ring_entry_size(size_t packet_size)
+{
+    return (sizeof(u32) + packet_size + 3) & ~3;
+}
+
+void NetworkAdapter::create_receive_ring(size_t size)
+{
+    ASSERT(!m_receive_ring_region);
+    m_receive_ring_region = MM.allocate_kernel_region(PAGE_ROUND_UP(size), "Network adapter receive ring", Region::Access::Read | Region::Access::Write, false, true);
+    m_receive_ring_size = size;
+}
+
 void NetworkAdapter::did_receive(const u8* data, size_t length)
 {
     InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += length;
-
-    Optional<KBuffer> buffer;
-
-    if (m_unused_packet_buffers.is_empty()) {
-        buffer = KBuffer::copy(data, length);
-    } else {
-        buffer = m_unused_packet_buffers.take_first();
-        --m_unused_packet_buffers_count;
-        if (length <= buffer.value().size()) {
-            memcpy(buffer.value().data(), data, length);
-            buffer.value().set_size(length);
-        } else {
-            buffer = KBuffer::copy(data, length);
+    ASSERT(m_receive_ring_region);
+    if (!length) {
+        count_dropped_packet();
+        return;
+    }
+
+    size_t entry_size = receive_ring_entry_size(length);
+    auto* ring = m_receive_ring_region->vaddr().as_ptr();
+
+    if (!m_receive_ring_used)
+        m_receive_ring_head = m_receive_ring_tail = 0;
+
+    if (m_receive_ring_used && m_receive_ring_tail <= m_receive_ring_head) {
+        // We've wrapped around already, so there's only the gap up to the oldest packet.
+        if (entry_size > m_receive_ring_head - m_receive_ring_tail) {
+            count_dropped_packet();
+            return;
+        }
+    } else if (entry_size > m_receive_ring_size - m_receive_ring_tail) {
+        if (entry_size > m_receive_ring_head) {
+            count_dropped_packet();
+            return;
         }
+        size_t skipped = m_receive_ring_size - m_receive_ring_tail;
+        if (skipped >= sizeof(u32))
+            *(u32*)(ring + m_receive_ring_tail) = 0;
+        m_receive_ring_used += skipped;
+        m_receive_ring_tail = 0;
     }
 
-    m_packet_queue.append(buffer.value());
+    *(u32*)(ring + m_receive_ring_tail) = length;
+    memcpy(ring + m_receive_ring_tail + sizeof(u32), data, length);
+    m_receive_ring_tail += entry_size;
+    m_receive_ring_used += entry_size;
 
     if (on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size)
+void NetworkAdapter::count_received_packet(size_t size)
+{
+    m_packets_in++;
+    m_bytes_in += size;
+}
+
+bool NetworkAdapter::has_queued_packets() const
+{
+    return m_receive_ring_used;
+}
+
+NetworkAdapter::ReceivedPacket NetworkAdapter::next_received_packet()
 {
     InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
-        return 0;
-    auto packet = m_packet_queue.take_first();
-    size_t packet_size = packet.size();
-    ASSERT(packet_size <= buffer_size);
-    memcpy(buffer, packet.data(), packet_size);
-    if (m_unused_packet_buffers_count < 100) {
-        m_unused_packet_buffers.append(packet);
-        ++m_unused_packet_buffers_count;
+    if (!m_receive_ring_used)
+        return {};
+    auto* ring = m_receive_ring_region->vaddr().as_ptr();
+    if (m_receive_ring_size - m_receive_ring_head < sizeof(u32) || !*(const u32*)(ring + m_receive_ring_head)) {
+        m_receive_ring_used -= m_receive_ring_size - m_receive_ring_head;
+        m_receive_ring_head = 0;
     }
-    return packet_size;
+    return { ring + m_receive_ring_head + sizeof(u32), *(const u32*)(ring + m_receive_ring_head) };
+}
+
+void NetworkAdapter::release_received_packet()
+{
+    InterruptDisabler disabler;
+    ASSERT(m_receive_ring_used);
+    size_t size = *(const u32*)(m_receive_ring_region->vaddr().as_ptr() + m_receive_ring_head);
+    size_t entry_size = receive_ring_entry_size(size);
+    m_receive_ring_head += entry_size;
+    m_receive_ring_used -= entry_size;
+    count_received_packet(size);
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
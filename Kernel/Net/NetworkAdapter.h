@@ -28,7 +28,7 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
-#include <AK/SinglyLinkedList.h>
+#include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
@@ -41,6 +41,7 @@
 namespace Kernel {
 
 class NetworkAdapter;
+class PacketBuffer;
 
 class NetworkAdapter : public RefCounted<NetworkAdapter> {
 public:
@@ -64,11 +65,20 @@ public:
 
     void send(const MACAddress&, const ARPPacket&);
     void send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, const u8* payload, size_t payload_size, u8 ttl);
+    // Prepends the IPv4 and Ethernet headers to the packet in place, so it should have room for them.
+    void send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, PacketBuffer&, u8 ttl);
     void send_ipv4_fragmented(const MACAddress&, const IPv4Address&, IPv4Protocol, const u8* payload, size_t payload_size, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size);
+    struct ReceivedPacket {
+        const u8* data { nullptr };
+        size_t size { 0 };
+    };
 
-    bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
+    // Received packets are handed out in order, straight from the adapter's receive ring.
+    // The oldest one stays put (and valid) until it's released, which gives its space back to the adapter.
+    virtual bool has_queued_packets() const;
+    virtual ReceivedPacket next_received_packet();
+    virtual void release_received_packet();
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
@@ -77,6 +87,7 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 packets_dropped() const { return m_packets_dropped; }
 
     Function<void()> on_receive;
 
@@ -85,21 +96,29 @@ protected:
     void set_interface_name(const StringView& basename);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     virtual void send_raw(const u8*, size_t) = 0;
+
+    // Adapters that don't hand out their own buffers copy what they receive into a ring of this size.
+    void create_receive_ring(size_t size);
     void did_receive(const u8*, size_t);
+    void count_received_packet(size_t size);
+    void count_dropped_packet() { m_packets_dropped++; }
 
 private:
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
     IPv4Address m_ipv4_netmask;
     IPv4Address m_ipv4_gateway;
-    SinglyLinkedList<KBuffer> m_packet_queue;
-    SinglyLinkedList<KBuffer> m_unused_packet_buffers;
-    size_t m_unused_packet_buffers_count { 0 };
+    OwnPtr<Region> m_receive_ring_region;
+    size_t m_receive_ring_size { 0 };
+    size_t m_receive_ring_head { 0 };
+    size_t m_receive_ring_tail { 0 };
+    size_t m_receive_ring_used { 0 };
     String m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    u32 m_packets_dropped { 0 };
     u32 m_mtu { 1500 };
 };
 
@@ -32,6 +32,7 @@
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4Socket.h>
 #include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
@@ -50,17 +51,28 @@
 
 namespace Kernel {
 
+static void handle_ethernet(const u8* frame, size_t frame_size);
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
 static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size);
 static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&);
 static void handle_udp(const IPv4Packet&);
 static void handle_tcp(const IPv4Packet&);
 
+static WaitQueue* s_packet_wait_queue;
+static bool s_tcp_timers_due;
+
+void NetworkTask_wake_for_tcp_timers()
+{
+    s_tcp_timers_due = true;
+    if (s_packet_wait_queue)
+        s_packet_wait_queue->wake_all();
+}
+
 void NetworkTask_main()
 {
     WaitQueue packet_wait_queue;
     u8 octet = 15;
-    int pending_packets = 0;
+    Vector<NonnullRefPtr<NetworkAdapter>> adapters;
     NetworkAdapter::for_each([&](auto& adapter) {
         if (String(adapter.class_name()) == "LoopbackAdapter") {
             adapter.set_ipv4_address({ 127, 0, 0, 1 });
@@ -75,81 +87,106 @@ void NetworkTask_main()
         klog() << "NetworkTask: " << adapter.class_name() << " network adapter found: hw=" << adapter.mac_address().to_string().characters() << " address=" << adapter.ipv4_address().to_string().characters() << " netmask=" << adapter.ipv4_netmask().to_string().characters() << " gateway=" << adapter.ipv4_gateway().to_string().characters();
 
         adapter.on_receive = [&]() {
-            pending_packets++;
             packet_wait_queue.wake_all();
         };
+        adapters.append(adapter);
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkAdapter::for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size);
-            pending_packets--;
+    // Packets are handled right where the adapter received them, a batch at a time from each adapter in turn,
+    // so a busy adapter can't starve the others (or the TCP timers).
+    auto receive_batch = [&]() -> size_t {
+        static constexpr size_t max_packets_per_batch = 32;
+        size_t packet_count = 0;
+        for (auto& adapter : adapters) {
+            size_t adapter_packet_count = 0;
+            for (; adapter_packet_count < max_packets_per_batch; ++adapter_packet_count) {
+                auto packet = adapter->next_received_packet();
+                if (!packet.data)
+                    break;
+                handle_ethernet(packet.data, packet.size);
+                adapter->release_received_packet();
+            }
 #ifdef NETWORK_TASK_DEBUG
-            klog() << "NetworkTask: Dequeued packet from " << adapter.name().characters() << " (" << packet_size << " bytes)";
+            if (adapter_packet_count)
+                klog() << "NetworkTask: Handled " << adapter_packet_count << " packet(s) from " << adapter->name().characters();
 #endif
-        });
-        return packet_size;
+            packet_count += adapter_packet_count;
+        }
+        return packet_count;
     };
 
-    size_t buffer_size = 64 * KB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write, false, true);
-    auto buffer = (u8*)buffer_region->vaddr().get();
+    auto has_queued_packets = [&] {
+        for (auto& adapter : adapters) {
+            if (adapter->has_queued_packets())
+                return true;
+        }
+        return false;
+    };
+
+    {
+        InterruptDisabler disabler;
+        s_packet_wait_queue = &packet_wait_queue;
+    }
 
     klog() << "NetworkTask: Enter main loop.";
     for (;;) {
-        size_t packet_size = dequeue_packet(buffer, buffer_size);
-        if (!packet_size) {
-            Thread::current->wait_on(packet_wait_queue);
-            continue;
+        if (s_tcp_timers_due) {
+            s_tcp_timers_due = false;
+            TCPSocket::fire_timers();
         }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            klog() << "NetworkTask: Packet is too small to be an Ethernet packet! (" << packet_size << ")";
+        if (receive_batch())
             continue;
-        }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
+        // Check again with interrupts off, so a wakeup from an IRQ handler can't slip in before we're on the queue.
+        InterruptDisabler disabler;
+        if (!has_queued_packets() && !s_tcp_timers_due)
+            Thread::current->wait_on(packet_wait_queue);
+    }
+}
+
+void handle_ethernet(const u8* frame, size_t frame_size)
+{
+    if (frame_size < sizeof(EthernetFrameHeader)) {
+        klog() << "NetworkTask: Packet is too small to be an Ethernet packet! (" << frame_size << ")";
+        return;
+    }
+    auto& eth = *(const EthernetFrameHeader*)frame;
 #ifdef ETHERNET_DEBUG
-        klog() << "NetworkTask: From " << eth.source().to_string().characters() << " to " << eth.destination().to_string().characters() << ", ether_type=" << String::format("%w", eth.ether_type()) << ", packet_length=" << packet_size;
+    klog() << "NetworkTask: From " << eth.source().to_string().characters() << " to " << eth.destination().to_string().characters() << ", ether_type=" << String::format("%w", eth.ether_type()) << ", packet_length=" << frame_size;
 #endif
 
 #ifdef ETHERNET_VERY_DEBUG
-        for (size_t i = 0; i < packet_size; i++) {
-            klog() << String::format("%b", buffer[i]);
-
-            switch (i % 16) {
-            case 7:
-                klog() << "  ";
-                break;
-            case 15:
-                klog() << "";
-                break;
-            default:
-                klog() << " ";
-                break;
-            }
-        }
-
-        klog() << "";
-#endif
+    for (size_t i = 0; i < frame_size; i++) {
+        klog() << String::format("%b", frame[i]);
 
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
+        switch (i % 16) {
+        case 7:
+            klog() << "  ";
             break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size);
-            break;
-        case EtherType::IPv6:
-            // ignore
+        case 15:
+            klog() << "";
             break;
         default:
-            klog() << "NetworkTask: Unknown ethernet type 0x" << String::format("%x", eth.ether_type());
+            klog() << " ";
+            break;
         }
     }
+
+    klog() << "";
+#endif
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, frame_size);
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, frame_size);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        klog() << "NetworkTask: Unknown ethernet type 0x" << String::format("%x", eth.ether_type());
+    }
 }
 
 void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
@@ -266,8 +303,9 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet)
         auto& request = reinterpret_cast<const ICMPEchoPacket&>(icmp_header);
         klog() << "handle_icmp: EchoRequest from " << ipv4_packet.source().to_string().characters() << ": id=" << (u16)request.identifier << ", seq=" << (u16)request.sequence_number;
         size_t icmp_packet_size = ipv4_packet.payload_size();
-        auto buffer = ByteBuffer::create_zeroed(icmp_packet_size);
-        auto& response = *(ICMPEchoPacket*)buffer.data();
+        PacketBuffer packet(icmp_packet_size);
+        memset(packet.data(), 0, sizeof(ICMPEchoPacket));
+        auto& response = *(ICMPEchoPacket*)packet.data();
         response.header.set_type(ICMPType::EchoReply);
         response.header.set_code(0);
         response.identifier = request.identifier;
@@ -276,7 +314,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet)
             memcpy(response.payload(), request.payload(), icmp_payload_size);
         response.header.set_checksum(internet_checksum(&response, icmp_packet_size));
         // FIXME: What is the right TTL value here? Is 64 ok? Should we use the same TTL as the echo request?
-        adapter->send_ipv4(eth.source(), ipv4_packet.source(), IPv4Protocol::ICMP, buffer.data(), buffer.size(), 64);
+        adapter->send_ipv4(eth.source(), ipv4_packet.source(), IPv4Protocol::ICMP, packet, 64);
     }
 }
 
@@ -391,6 +429,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
 #endif
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->receive_syn_options(tcp_packet);
             client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -439,7 +478,9 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
     case TCPSocket::State::SynReceived:
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
-            socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
+        case TCPFlags::ACK | TCPFlags::PUSH:
+            // The handshake ACK may have been overtaken by data. Either way, any data riding along is dropped
+            // and will be retransmitted once we're established, so we keep waiting for the first byte.
 
             switch (socket->direction()) {
             case TCPSocket::Direction::Incoming:
@@ -475,6 +516,9 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
         }
     case TCPSocket::State::CloseWait:
         switch (tcp_packet.flags()) {
+        case TCPFlags::ACK:
+            // We may still be sending; the ACK itself was handled in receive_tcp_packet().
+            return;
         default:
             klog() << "handle_tcp: unexpected flags in CloseWait state";
             socket->send_tcp_packet(TCPFlags::RST);
@@ -485,7 +529,8 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            socket->set_state(TCPSocket::State::Closed);
+            if (socket->is_fin_acknowledged())
+                socket->set_state(TCPSocket::State::Closed);
             return;
         default:
             klog() << "handle_tcp: unexpected flags in LastAck state";
@@ -497,7 +542,8 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            socket->set_state(TCPSocket::State::FinWait2);
+            if (socket->is_fin_acknowledged())
+                socket->set_state(TCPSocket::State::FinWait2);
             return;
         case TCPFlags::FIN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
@@ -528,7 +574,8 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            socket->set_state(TCPSocket::State::TimeWait);
+            if (socket->is_fin_acknowledged())
+                socket->set_state(TCPSocket::State::TimeWait);
             return;
         default:
             klog() << "handle_tcp: unexpected flags in Closing state";
@@ -537,27 +584,37 @@ void handle_tcp(const IPv4Packet& ipv4_packet)
             return;
         }
     case TCPSocket::State::Established:
-        if (tcp_packet.has_fin()) {
-            if (payload_size != 0)
-                socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()));
+        if (tcp_packet.sequence_number() != socket->ack_number()) {
+            // Out of order, or something we already have. Either way, remind the peer what we're waiting for.
+            // A few of these in a row is what gets it to retransmit without waiting for a timeout.
+            if (payload_size || tcp_packet.has_fin())
+                socket->send_tcp_packet(TCPFlags::ACK);
+            return;
+        }
 
-            socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+        if (payload_size) {
+            if (!socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()))) {
+                // No room for it. The peer will retransmit, meanwhile let it know how much window we really have.
+                socket->send_tcp_packet(TCPFlags::ACK);
+                return;
+            }
+            socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
+        }
+
+        if (tcp_packet.has_fin()) {
+            socket->set_ack_number(socket->ack_number() + 1);
             socket->send_tcp_packet(TCPFlags::ACK);
             socket->set_state(TCPSocket::State::CloseWait);
             socket->set_connected(false);
             return;
         }
 
-        socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-
 #ifdef TCP_DEBUG
         klog() << "Got packet with ack_no=" << tcp_packet.ack_number() << ", seq_no=" << tcp_packet.sequence_number() << ", payload_size=" << payload_size << ", acking it with new ack_no=" << socket->ack_number() << ", seq_no=" << socket->sequence_number();
 #endif
 
-        if (payload_size) {
-            if (socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size())))
-                socket->send_tcp_packet(TCPFlags::ACK);
-        }
+        if (payload_size)
+            socket->acknowledge_received_data();
     }
 }
 
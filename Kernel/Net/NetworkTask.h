@@ -29,5 +29,7 @@
 namespace Kernel {
 
 void NetworkTask_main();
+// Gets the network task to run TCPSocket::fire_timers() when it gets around to it. Safe to call from IRQ handlers.
+void NetworkTask_wake_for_tcp_timers();
 
 }
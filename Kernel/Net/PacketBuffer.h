@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Types.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
+#include <Kernel/Net/IPv4.h>
+#include <LibBareMetal/StdLib.h>
+
+namespace Kernel {
+
+// An outgoing packet, built from the inside out: the payload goes in first, and then each layer on the way
+// down to the adapter prepends its header into space reserved in front of it, so the payload is never copied again.
+class PacketBuffer {
+public:
+    // Enough for the Ethernet and IPv4 headers, and a TCP header with the largest possible options.
+    static constexpr size_t default_headroom = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + 60;
+
+    explicit PacketBuffer(size_t size, size_t headroom = default_headroom)
+        : m_buffer(ByteBuffer::create_uninitialized(headroom + size))
+        , m_offset(headroom)
+        , m_size(size)
+    {
+    }
+
+    u8* data() { return m_buffer.data() + m_offset; }
+    const u8* data() const { return m_buffer.data() + m_offset; }
+    size_t size() const { return m_size; }
+    size_t headroom() const { return m_offset; }
+
+    // Grows the packet at the front, and returns the (zeroed) space for the new header.
+    u8* prepend(size_t size)
+    {
+        ASSERT(size <= m_offset);
+        m_offset -= size;
+        m_size += size;
+        memset(data(), 0, size);
+        return data();
+    }
+
+private:
+    ByteBuffer m_buffer;
+    size_t m_offset { 0 };
+    size_t m_size { 0 };
+};
+
+}
@@ -69,6 +69,13 @@ void Socket::set_setup_state(SetupState new_setup_state)
 #endif
 
     m_setup_state = new_setup_state;
+    evaluate_block_conditions();
+}
+
+void Socket::set_connected(bool connected)
+{
+    m_connected = connected;
+    evaluate_block_conditions();
 }
 
 RefPtr<Socket> Socket::accept()
@@ -85,6 +92,7 @@ RefPtr<Socket> Socket::accept()
     client->m_acceptor = { process.pid(), process.uid(), process.gid() };
     client->m_connected = true;
     client->m_role = Role::Accepted;
+    client->evaluate_block_conditions();
     return client;
 }
 
@@ -97,6 +105,7 @@ KResult Socket::queue_connection_from(NonnullRefPtr<Socket> peer)
     if (m_pending.size() >= m_backlog)
         return KResult(-ECONNREFUSED);
     m_pending.append(peer);
+    evaluate_block_conditions();
     return KSuccess;
 }
 
@@ -175,6 +184,7 @@ KResult Socket::shutdown(int how)
         shut_down_for_reading();
     m_shut_down_for_reading |= (how & SHUT_RD) != 0;
     m_shut_down_for_writing |= (how & SHUT_WR) != 0;
+    evaluate_block_conditions();
     return KSuccess;
 }
 
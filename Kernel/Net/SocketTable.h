@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/RefPtr.h>
+#include <Kernel/Lock.h>
+
+namespace Kernel {
+
+// Maps keys (ports or address tuples) to the sockets that own them. The table is split into shards,
+// each with its own lock, so that looking up the socket for an incoming packet doesn't wait for
+// unrelated sockets to come and go. Lookups only take the lock shared, so they don't wait for each other.
+template<typename Key, typename SocketType>
+class SocketTable {
+public:
+    RefPtr<SocketType> get(const Key& key)
+    {
+        auto& shard = shard_for(key);
+        Locker locker(shard.lock(), Lock::Mode::Shared);
+        auto socket = shard.resource().get(key);
+        if (!socket.has_value())
+            return {};
+        return *socket.value();
+    }
+
+    bool contains(const Key& key)
+    {
+        auto& shard = shard_for(key);
+        Locker locker(shard.lock(), Lock::Mode::Shared);
+        return shard.resource().contains(key);
+    }
+
+    // Returns false if the key already belongs to another socket.
+    bool add(const Key& key, SocketType& socket)
+    {
+        auto& shard = shard_for(key);
+        LOCKER(shard.lock());
+        if (shard.resource().contains(key))
+            return false;
+        shard.resource().set(key, &socket);
+        return true;
+    }
+
+    // Only removes the key if it belongs to this socket, so a socket that never got
+    // the key (e.g. because of EADDRINUSE) can't take it away from the one that did.
+    void remove(const Key& key, SocketType& socket)
+    {
+        auto& shard = shard_for(key);
+        LOCKER(shard.lock());
+        auto it = shard.resource().find(key);
+        if (it != shard.resource().end() && (*it).value == &socket)
+            shard.resource().remove(it);
+    }
+
+    template<typename Callback>
+    void for_each(Callback callback)
+    {
+        for (auto& shard : m_shards) {
+            Locker locker(shard.lock(), Lock::Mode::Shared);
+            for (auto& it : shard.resource())
+                callback(*it.value);
+        }
+    }
+
+private:
+    static constexpr size_t shard_count = 64;
+
+    Lockable<HashMap<Key, SocketType*>>& shard_for(const Key& key)
+    {
+        return m_shards[Traits<Key>::hash(key) % shard_count];
+    }
+
+    Lockable<HashMap<Key, SocketType*>> m_shards[shard_count];
+};
+
+}
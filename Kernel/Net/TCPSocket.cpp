@@ -24,25 +24,90 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/Time.h>
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/TimerQueue.h>
 
 //#define TCP_SOCKET_DEBUG
 
 namespace Kernel {
 
+static constexpr size_t send_buffer_capacity = 64 * KB;
+static constexpr size_t default_mss = 536;
+static constexpr u64 delayed_ack_timeout = 40;
+static constexpr u32 initial_retransmission_timeout = 1000;
+static constexpr u32 minimum_retransmission_timeout = 200;
+static constexpr u32 maximum_retransmission_timeout = 60 * 1000;
+
+static bool sequence_before(u32 a, u32 b)
+{
+    return (i32)(a - b) < 0;
+}
+
+static size_t maximum_segment_size_for(const NetworkAdapter& adapter)
+{
+    // The MTU includes the Ethernet header, see NetworkAdapter::send_ipv4_fragmented().
+    size_t mss = adapter.mtu() - sizeof(EthernetFrameHeader) - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    return min(mss, (size_t)0xffff - sizeof(IPv4Packet) - sizeof(TCPPacket));
+}
+
+static u8 window_scale_for(size_t buffer_size)
+{
+    u8 scale = 0;
+    while ((buffer_size >> scale) > 0xffff)
+        ++scale;
+    return scale;
+}
+
+static size_t initial_congestion_window(size_t mss)
+{
+    // RFC 5681, 3.1.
+    if (mss > 2190)
+        return 2 * mss;
+    if (mss > 1095)
+        return 3 * mss;
+    return 4 * mss;
+}
+
+// All TCP sockets share one timer, set for whichever of their timers expires first.
+// It fires in IRQ context, so all it does is get the network task to call TCPSocket::fire_timers().
+static u64 s_timer_id;
+static u64 s_timer_expires;
+
+static void arm_timer(u64 expires)
+{
+    InterruptDisabler disabler;
+    if (expires <= g_uptime)
+        expires = g_uptime + 1;
+    if (s_timer_id) {
+        if (s_timer_expires <= expires)
+            return;
+        TimerQueue::the().cancel_timer(s_timer_id);
+    }
+    auto timer = make<Timer>();
+    timer->expires = expires;
+    timer->callback = [] {
+        s_timer_id = 0;
+        NetworkTask_wake_for_tcp_timers();
+    };
+    s_timer_expires = expires;
+    s_timer_id = TimerQueue::the().add_timer(move(timer));
+}
+
 void TCPSocket::for_each(Function<void(TCPSocket&)> callback)
 {
-    LOCKER(sockets_by_tuple().lock());
-    for (auto& it : sockets_by_tuple().resource())
-        callback(*it.value);
+    listeners().for_each([&](TCPSocket& socket) { callback(socket); });
+    connections().for_each([&](TCPSocket& socket) { callback(socket); });
 }
 
 void TCPSocket::set_state(State new_state)
@@ -60,6 +125,8 @@ void TCPSocket::set_state(State new_state)
         LOCKER(closing_sockets().lock());
         closing_sockets().resource().remove(tuple());
     }
+
+    evaluate_block_conditions();
 }
 
 Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_sockets()
@@ -70,33 +137,39 @@ Lockable<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_socket
     return *s_map;
 }
 
-Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& TCPSocket::sockets_by_tuple()
+SocketTable<IPv4SocketTuple, TCPSocket>& TCPSocket::connections()
 {
-    static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>* s_map;
-    if (!s_map)
-        s_map = new Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>;
-    return *s_map;
+    static SocketTable<IPv4SocketTuple, TCPSocket>* s_table;
+    if (!s_table)
+        s_table = new SocketTable<IPv4SocketTuple, TCPSocket>;
+    return *s_table;
 }
 
-RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
+SocketTable<IPv4SocketTuple, TCPSocket>& TCPSocket::listeners()
 {
-    LOCKER(sockets_by_tuple().lock());
+    static SocketTable<IPv4SocketTuple, TCPSocket>* s_table;
+    if (!s_table)
+        s_table = new SocketTable<IPv4SocketTuple, TCPSocket>;
+    return *s_table;
+}
 
-    auto exact_match = sockets_by_tuple().resource().get(tuple);
-    if (exact_match.has_value())
-        return { *exact_match.value() };
+EphemeralPortAllocator& TCPSocket::ephemeral_ports()
+{
+    static EphemeralPortAllocator* s_allocator;
+    if (!s_allocator)
+        s_allocator = new EphemeralPortAllocator;
+    return *s_allocator;
+}
 
-    auto address_tuple = IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0);
-    auto address_match = sockets_by_tuple().resource().get(address_tuple);
-    if (address_match.has_value())
-        return { *address_match.value() };
+RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
+{
+    if (auto socket = connections().get(tuple))
+        return socket;
 
-    auto wildcard_tuple = IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0);
-    auto wildcard_match = sockets_by_tuple().resource().get(wildcard_tuple);
-    if (wildcard_match.has_value())
-        return { *wildcard_match.value() };
+    if (auto socket = listeners().get(IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0)))
+        return socket;
 
-    return {};
+    return listeners().get(IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0));
 }
 
 RefPtr<TCPSocket> TCPSocket::from_endpoints(const IPv4Address& local_address, u16 local_port, const IPv4Address& peer_address, u16 peer_port)
@@ -107,9 +180,7 @@ RefPtr<TCPSocket> TCPSocket::from_endpoints(const IPv4Address& local_address, u1
 RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address, u16 new_local_port, const IPv4Address& new_peer_address, u16 new_peer_port)
 {
     auto tuple = IPv4SocketTuple(new_local_address, new_local_port, new_peer_address, new_peer_port);
-
-    LOCKER(sockets_by_tuple().lock());
-    if (sockets_by_tuple().resource().contains(tuple))
+    if (connections().contains(tuple))
         return {};
 
     auto client = TCPSocket::create(protocol());
@@ -122,10 +193,11 @@ RefPtr<TCPSocket> TCPSocket::create_client(const IPv4Address& new_local_address,
     client->set_direction(Direction::Incoming);
     client->set_originator(*this);
 
+    if (!connections().add(tuple, *client))
+        return {};
     m_pending_release_for_accept.set(tuple, client);
-    sockets_by_tuple().resource().set(tuple, client);
 
-    return from_tuple(tuple);
+    return client;
 }
 
 void TCPSocket::release_to_originator()
@@ -143,13 +215,17 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 
 TCPSocket::TCPSocket(int protocol)
     : IPv4Socket(SOCK_STREAM, protocol)
+    , m_slow_start_threshold(send_buffer_capacity)
+    , m_retransmission_timeout(initial_retransmission_timeout)
 {
 }
 
 TCPSocket::~TCPSocket()
 {
-    LOCKER(sockets_by_tuple().lock());
-    sockets_by_tuple().resource().remove(tuple());
+    connections().remove(tuple(), *this);
+    listeners().remove(tuple(), *this);
+    if (m_has_ephemeral_port)
+        ephemeral_ports().release(local_port());
 
 #ifdef TCP_SOCKET_DEBUG
     dbg() << "~TCPSocket in state " << to_string(state());
@@ -177,156 +253,557 @@ int TCPSocket::protocol_receive(const KBuffer& packet_buffer, void* buffer, size
 
 int TCPSocket::protocol_send(const void* data, size_t data_length)
 {
-    send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, data, data_length);
-    return data_length;
+    LOCKER(m_connection_lock);
+    if (m_fin_queued || (m_state != State::Established && m_state != State::CloseWait))
+        return -EPIPE;
+
+    if (!m_send_buffer.has_value())
+        m_send_buffer = KBuffer::create_with_size(send_buffer_capacity, Region::Access::Read | Region::Access::Write, "TCPSocket send buffer");
+
+    size_t size = min(data_length, send_buffer_capacity - m_send_buffer_size);
+    if (size == 0 || m_send_buffer_reserved)
+        return -EAGAIN;
+
+    size_t end = (m_send_buffer_start + m_send_buffer_size) % send_buffer_capacity;
+    size_t size_before_wrap = min(size, send_buffer_capacity - end);
+    memcpy(m_send_buffer.value().data() + end, data, size_before_wrap);
+    memcpy(m_send_buffer.value().data(), (const u8*)data + size_before_wrap, size - size_before_wrap);
+    m_send_buffer_size += size;
+    m_sequence_number += size;
+
+    send_outgoing_packets();
+    return size;
+}
+
+ssize_t TCPSocket::send_from(FileDescription& description, size_t max_size, Function<ssize_t(u8*, size_t)> fill)
+{
+    if (!can_write(description)) {
+        if (!description.is_blocking())
+            return -EAGAIN;
+        if (Thread::current->block<Thread::WriteBlocker>(description) != Thread::BlockResult::WokeNormally)
+            return -EINTR;
+    }
+
+    Locker locker(m_connection_lock);
+    if (m_fin_queued || (m_state != State::Established && m_state != State::CloseWait))
+        return -EPIPE;
+    if (m_send_buffer_reserved)
+        return -EAGAIN;
+
+    if (!m_send_buffer.has_value())
+        m_send_buffer = KBuffer::create_with_size(send_buffer_capacity, Region::Access::Read | Region::Access::Write, "TCPSocket send buffer");
+
+    // Only hand out room up to where the buffer wraps around, so fill() gets one contiguous span.
+    size_t end = (m_send_buffer_start + m_send_buffer_size) % send_buffer_capacity;
+    size_t size = min(max_size, min(send_buffer_capacity - m_send_buffer_size, send_buffer_capacity - end));
+    if (size == 0)
+        return -EAGAIN;
+
+    // Incoming ACKs only ever consume bytes from the front of the buffer, so they can carry on while we fill in the back.
+    m_send_buffer_reserved = size;
+    locker.unlock();
+    ssize_t nfilled = fill(m_send_buffer.value().data() + end, size);
+    locker.lock();
+    m_send_buffer_reserved = 0;
+    evaluate_block_conditions();
+
+    if (nfilled <= 0)
+        return nfilled;
+    ASSERT((size_t)nfilled <= size);
+    if (m_fin_queued || (m_state != State::Established && m_state != State::CloseWait))
+        return -EPIPE;
+
+    m_send_buffer_size += nfilled;
+    m_sequence_number += nfilled;
+    send_outgoing_packets();
+    Thread::current->did_ipv4_socket_write(nfilled);
+    return nfilled;
+}
+
+void TCPSocket::protocol_did_read()
+{
+    LOCKER(m_connection_lock);
+    if (m_state != State::Established && m_state != State::FinWait1 && m_state != State::FinWait2)
+        return;
+
+    // Let the peer know the reader made room, but only once that's worth a segment or two (RFC 1122, 4.2.3.3).
+    u32 window_end = m_ack_number + advertised_window();
+    size_t threshold = min(receive_buffer_capacity() / 2, 2 * m_receive_mss);
+    if ((i32)(window_end - m_advertised_window_end) >= (i32)threshold)
+        send_segment(TCPFlags::ACK, m_send_next, 0, 0);
 }
 
-void TCPSocket::send_tcp_packet(u16 flags, const void* payload, size_t payload_size)
+bool TCPSocket::can_write(const FileDescription&) const
 {
-    auto buffer = ByteBuffer::create_zeroed(sizeof(TCPPacket) + payload_size);
-    auto& tcp_packet = *(TCPPacket*)(buffer.data());
+    if (m_state == State::Established || m_state == State::CloseWait)
+        return m_fin_queued || (!m_send_buffer_reserved && m_send_buffer_size < send_buffer_capacity);
+    // Once the connection is gone, writers should find out about it instead of waiting forever.
+    return protocol_is_disconnected();
+}
+
+void TCPSocket::set_sequence_number(u32 initial_sequence_number)
+{
+    m_sequence_number = initial_sequence_number;
+    m_send_unacknowledged = initial_sequence_number;
+    m_send_next = initial_sequence_number;
+    m_send_max = initial_sequence_number;
+}
+
+size_t TCPSocket::advertised_window() const
+{
+    size_t window = min(receive_buffer_space(), (size_t)0xffff << m_receive_window_scale);
+    return (window >> m_receive_window_scale) << m_receive_window_scale;
+}
+
+void TCPSocket::send_tcp_packet(u16 flags)
+{
+    LOCKER(m_connection_lock);
+
+    if (flags & TCPFlags::SYN) {
+        auto routing_decision = route_to(peer_address(), local_address());
+        ASSERT(!routing_decision.is_zero());
+        m_receive_mss = maximum_segment_size_for(*routing_decision.adapter);
+        // We always offer window scaling when connecting, and agree to it when the peer offered it.
+        if (!(flags & TCPFlags::ACK))
+            m_window_scaling = true;
+        m_receive_window_scale = m_window_scaling ? window_scale_for(receive_buffer_capacity()) : 0;
+
+        m_syn_flags = flags;
+        m_syn_unacknowledged = true;
+        m_sequence_number = m_send_unacknowledged + 1;
+        m_send_next = m_sequence_number;
+        m_send_max = m_sequence_number;
+        m_timing_segment = true;
+        m_timed_sequence_number = m_sequence_number;
+        m_timed_segment_sent_at = g_uptime;
+        send_segment(flags, m_send_unacknowledged, 0, 0);
+        start_retransmission_timer();
+        return;
+    }
+
+    if (flags & TCPFlags::FIN) {
+        m_fin_queued = true;
+        ++m_sequence_number;
+        send_outgoing_packets();
+        return;
+    }
+
+    send_segment(flags, m_send_next, 0, 0);
+}
+
+void TCPSocket::send_segment(u16 flags, u32 sequence_number, size_t offset, size_t size)
+{
+    size_t options_size = 0;
+    if (flags & TCPFlags::SYN)
+        options_size = m_window_scaling ? 8 : 4;
+
+    PacketBuffer packet(size);
+    if (size) {
+        ASSERT(offset + size <= m_send_buffer_size);
+        size_t start = (m_send_buffer_start + offset) % send_buffer_capacity;
+        size_t size_before_wrap = min(size, send_buffer_capacity - start);
+        memcpy(packet.data(), m_send_buffer.value().data() + start, size_before_wrap);
+        memcpy(packet.data() + size_before_wrap, m_send_buffer.value().data(), size - size_before_wrap);
+    }
+
+    auto& tcp_packet = *(TCPPacket*)packet.prepend(sizeof(TCPPacket) + options_size);
     ASSERT(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(1024);
-    tcp_packet.set_sequence_number(m_sequence_number);
-    tcp_packet.set_data_offset(sizeof(TCPPacket) / sizeof(u32));
+    tcp_packet.set_sequence_number(sequence_number);
+    tcp_packet.set_data_offset((sizeof(TCPPacket) + options_size) / sizeof(u32));
     tcp_packet.set_flags(flags);
 
     if (flags & TCPFlags::ACK)
         tcp_packet.set_ack_number(m_ack_number);
 
+    size_t window = advertised_window();
     if (flags & TCPFlags::SYN) {
-        ++m_sequence_number;
+        // The window in a SYN segment is never scaled.
+        window = min(window, (size_t)0xffff);
+        tcp_packet.set_window_size(window);
+        auto* options = tcp_packet.options();
+        options[0] = TCPOptionKind::MaximumSegmentSize;
+        options[1] = 4;
+        options[2] = m_receive_mss >> 8;
+        options[3] = m_receive_mss & 0xff;
+        if (m_window_scaling) {
+            options[4] = TCPOptionKind::NoOperation;
+            options[5] = TCPOptionKind::WindowScale;
+            options[6] = 3;
+            options[7] = m_receive_window_scale;
+        }
     } else {
-        m_sequence_number += payload_size;
+        tcp_packet.set_window_size(window >> m_receive_window_scale);
     }
+    m_advertised_window_end = m_ack_number + window;
 
-    memcpy(tcp_packet.payload(), payload, payload_size);
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, size));
 
-    if (tcp_packet.has_syn() || payload_size > 0) {
-        LOCKER(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(buffer) });
-        send_outgoing_packets();
-        return;
+    if (flags & TCPFlags::ACK) {
+        m_segments_awaiting_ack = 0;
+        m_delayed_ack_timer_expires = 0;
     }
 
+#ifdef TCP_SOCKET_DEBUG
+    klog() << "sending tcp packet from " << local_address().to_string().characters() << ":" << local_port() << " to " << peer_address().to_string().characters() << ":" << peer_port() << " with (" << (tcp_packet.has_syn() ? "SYN " : "") << (tcp_packet.has_ack() ? "ACK " : "") << (tcp_packet.has_fin() ? "FIN " : "") << (tcp_packet.has_rst() ? "RST " : "") << ") seq_no=" << tcp_packet.sequence_number() << ", ack_no=" << tcp_packet.ack_number() << ", size=" << size << ", window=" << window;
+#endif
+
     auto routing_decision = route_to(peer_address(), local_address());
     ASSERT(!routing_decision.is_zero());
 
-    routing_decision.adapter->send_ipv4(
-        routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-        buffer.data(), buffer.size(), ttl());
-
     m_packets_out++;
-    m_bytes_out += buffer.size();
+    m_bytes_out += packet.size();
+
+    routing_decision.adapter->send_ipv4(routing_decision.next_hop, peer_address(), IPv4Protocol::TCP, packet, ttl());
 }
 
 void TCPSocket::send_outgoing_packets()
 {
-    auto routing_decision = route_to(peer_address(), local_address());
-    ASSERT(!routing_decision.is_zero());
+    LOCKER(m_connection_lock);
+    if (m_syn_unacknowledged)
+        return;
 
-    auto now = kgettimeofday();
+    for (;;) {
+        size_t in_flight = bytes_in_flight();
+        if (in_flight > m_send_buffer_size)
+            break; // The FIN is out already.
+        size_t unsent = m_send_buffer_size - in_flight;
+        if (!unsent && !m_fin_queued)
+            break;
 
-    LOCKER(m_not_acked_lock);
-    for (auto& packet : m_not_acked) {
-        timeval diff;
-        timeval_sub(packet.tx_time, now, diff);
-        if (diff.tv_sec == 0 && diff.tv_usec <= 500000)
-            continue;
-        packet.tx_time = now;
-        packet.tx_counter++;
+        size_t window = min(m_congestion_window, m_send_window);
+        size_t usable_window = window > in_flight ? window - in_flight : 0;
+        size_t size = min(min(unsent, m_send_mss), usable_window);
+        if (unsent && !size)
+            break;
+        // Avoid silly windows (RFC 1122, 4.2.3.4): while there's data in flight, only send full segments or the rest of the queue.
+        if (size < unsent && size < m_send_mss && in_flight)
+            break;
 
-#ifdef TCP_SOCKET_DEBUG
-        auto& tcp_packet = *(TCPPacket*)(packet.buffer.data());
-        klog() << "sending tcp packet from " << local_address().to_string().characters() << ":" << local_port() << " to " << peer_address().to_string().characters() << ":" << peer_port() << " with (" << (tcp_packet.has_syn() ? "SYN " : "") << (tcp_packet.has_ack() ? "ACK " : "") << (tcp_packet.has_fin() ? "FIN " : "") << (tcp_packet.has_rst() ? "RST " : "") << ") seq_no=" << tcp_packet.sequence_number() << ", ack_no=" << tcp_packet.ack_number() << ", tx_counter=" << packet.tx_counter;
-#endif
-        routing_decision.adapter->send_ipv4(
-            routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-            packet.buffer.data(), packet.buffer.size(), ttl());
+        bool fin = m_fin_queued && size == unsent;
+        u16 flags = TCPFlags::ACK;
+        if (size && size == unsent)
+            flags |= TCPFlags::PUSH;
+        if (fin)
+            flags |= TCPFlags::FIN;
+
+        u32 sequence_number = m_send_next;
+        m_send_next += size + (fin ? 1 : 0);
+        if (!m_timing_segment && sequence_number == m_send_max) {
+            m_timing_segment = true;
+            m_timed_sequence_number = m_send_next;
+            m_timed_segment_sent_at = g_uptime;
+        }
+        if (sequence_before(m_send_max, m_send_next))
+            m_send_max = m_send_next;
 
-        m_packets_out++;
-        m_bytes_out += packet.buffer.size();
+        send_segment(flags, sequence_number, in_flight, size);
+        if (fin)
+            break;
     }
+
+    // The same timer retransmits what's in flight and probes a closed window.
+    if (m_send_unacknowledged != m_sequence_number && !m_retransmission_timer_expires)
+        start_retransmission_timer();
 }
 
-void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
+void TCPSocket::retransmit_first_segment()
 {
-    if (packet.has_ack()) {
-        u32 ack_number = packet.ack_number();
+    // Karn's algorithm: a retransmitted segment can't be timed, since we won't know which copy got acknowledged.
+    m_timing_segment = false;
 
-#ifdef TCP_SOCKET_DEBUG
-        dbg() << "TCPSocket: receive_tcp_packet: " << ack_number;
-#endif
+    if (m_syn_unacknowledged) {
+        send_segment(m_syn_flags, m_send_unacknowledged, 0, 0);
+        return;
+    }
+
+    size_t size = min(m_send_buffer_size, m_send_mss);
+    bool fin = m_fin_queued && size == m_send_buffer_size;
+    if (!size && !fin)
+        return;
+
+    u16 flags = TCPFlags::ACK;
+    if (size && size == m_send_buffer_size)
+        flags |= TCPFlags::PUSH;
+    if (fin)
+        flags |= TCPFlags::FIN;
+    send_segment(flags, m_send_unacknowledged, 0, size);
+
+    u32 end = m_send_unacknowledged + size + (fin ? 1 : 0);
+    if (sequence_before(m_send_next, end))
+        m_send_next = end;
+    if (sequence_before(m_send_max, m_send_next))
+        m_send_max = m_send_next;
+}
+
+void TCPSocket::start_retransmission_timer()
+{
+    m_retransmission_timer_expires = g_uptime + m_retransmission_timeout * TimeUnit::MS;
+    arm_timer(m_retransmission_timer_expires);
+}
+
+void TCPSocket::on_retransmission_timeout()
+{
+    if (m_send_unacknowledged == m_sequence_number)
+        return;
 
-        int removed = 0;
-        LOCKER(m_not_acked_lock);
-        while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
+    // With nothing in flight, we're here because the peer's window is closed, so this is just a probe.
+    bool is_window_probe = m_send_max == m_send_unacknowledged && !m_syn_unacknowledged;
+    if (!is_window_probe) {
+        m_slow_start_threshold = max(bytes_in_flight() / 2, 2 * m_send_mss);
+        m_congestion_window = m_send_mss;
+        m_in_fast_recovery = false;
+        m_duplicate_acks = 0;
+        m_send_next = m_send_unacknowledged;
+    }
 
 #ifdef TCP_SOCKET_DEBUG
-            dbg() << "TCPSocket: iterate: " << packet.ack_number;
+    dbg() << "TCPSocket{" << this << "} retransmission timeout after " << m_retransmission_timeout << " ms" << (is_window_probe ? ", probing window" : "");
 #endif
 
-            if (packet.ack_number <= ack_number) {
-                m_not_acked.take_first();
-                removed++;
-            } else {
-                break;
-            }
+    m_retransmission_timeout = min(m_retransmission_timeout * 2, maximum_retransmission_timeout);
+    retransmit_first_segment();
+    start_retransmission_timer();
+}
+
+void TCPSocket::update_round_trip_time(u32 sample)
+{
+    if (!m_has_round_trip_time) {
+        m_smoothed_round_trip_time = sample;
+        m_round_trip_time_variance = sample / 2;
+        m_has_round_trip_time = true;
+    } else {
+        u32 difference = sample > m_smoothed_round_trip_time ? sample - m_smoothed_round_trip_time : m_smoothed_round_trip_time - sample;
+        m_round_trip_time_variance = (3 * m_round_trip_time_variance + difference) / 4;
+        m_smoothed_round_trip_time = (7 * m_smoothed_round_trip_time + sample) / 8;
+    }
+    m_retransmission_timeout = estimated_retransmission_timeout();
+}
+
+u32 TCPSocket::estimated_retransmission_timeout() const
+{
+    u32 timeout = m_smoothed_round_trip_time + max(1u, 4 * m_round_trip_time_variance);
+    return min(max(timeout, minimum_retransmission_timeout), maximum_retransmission_timeout);
+}
+
+void TCPSocket::acknowledge_received_data()
+{
+    LOCKER(m_connection_lock);
+    // ACK at least every second segment (RFC 5681, 4.2), and otherwise give the ACK a moment to ride along with data.
+    if (++m_segments_awaiting_ack >= 2) {
+        send_segment(TCPFlags::ACK, m_send_next, 0, 0);
+        return;
+    }
+    if (!m_delayed_ack_timer_expires) {
+        m_delayed_ack_timer_expires = g_uptime + delayed_ack_timeout * TimeUnit::MS;
+        arm_timer(m_delayed_ack_timer_expires);
+    }
+}
+
+void TCPSocket::receive_syn_options(const TCPPacket& packet)
+{
+    LOCKER(m_connection_lock);
+
+    size_t peer_mss = default_mss;
+    bool peer_window_scaling = false;
+    u8 peer_window_scale = 0;
+
+    auto* options = packet.options();
+    size_t options_size = packet.options_size();
+    for (size_t i = 0; i < options_size;) {
+        u8 kind = options[i];
+        if (kind == TCPOptionKind::End)
+            break;
+        if (kind == TCPOptionKind::NoOperation) {
+            ++i;
+            continue;
         }
+        if (i + 1 >= options_size)
+            break;
+        u8 length = options[i + 1];
+        if (length < 2 || i + length > options_size)
+            break;
+        if (kind == TCPOptionKind::MaximumSegmentSize && length == 4) {
+            peer_mss = (options[i + 2] << 8) | options[i + 3];
+        } else if (kind == TCPOptionKind::WindowScale && length == 3) {
+            peer_window_scaling = true;
+            peer_window_scale = min(options[i + 2], (u8)14);
+        }
+        i += length;
+    }
 
-#ifdef TCP_SOCKET_DEBUG
-        dbg() << "TCPSocket: receive_tcp_packet acknowledged " << removed << " packets";
-#endif
+    auto routing_decision = route_to(peer_address(), local_address());
+    size_t local_mss = routing_decision.is_zero() ? default_mss : maximum_segment_size_for(*routing_decision.adapter);
+    m_send_mss = min(peer_mss, local_mss);
+    if (m_send_mss == 0)
+        m_send_mss = default_mss;
+
+    m_window_scaling = peer_window_scaling;
+    m_send_window_scale = m_window_scaling ? peer_window_scale : 0;
+    m_receive_window_scale = m_window_scaling ? window_scale_for(receive_buffer_capacity()) : 0;
+    m_send_window = packet.window_size();
+
+    m_congestion_window = initial_congestion_window(m_send_mss);
+}
+
+void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
+{
+    {
+        LOCKER(m_connection_lock);
+        if (packet.has_syn() && m_state == State::SynSent)
+            receive_syn_options(packet);
+        if (packet.has_ack())
+            receive_ack(packet, size - packet.header_size());
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+void TCPSocket::receive_ack(const TCPPacket& packet, size_t payload_size)
 {
-    struct [[gnu::packed]] PseudoHeader
-    {
-        IPv4Address source;
-        IPv4Address destination;
-        u8 zero;
-        u8 protocol;
-        NetworkOrdered<u16> payload_size;
-    };
+    u32 ack_number = packet.ack_number();
+    size_t window = packet.has_syn() ? packet.window_size() : (size_t)packet.window_size() << m_send_window_scale;
+
+    if (sequence_before(ack_number, m_send_unacknowledged) || sequence_before(m_send_max, ack_number))
+        return;
+
+    size_t acknowledged = ack_number - m_send_unacknowledged;
+    if (!acknowledged) {
+        // A duplicate ACK (RFC 5681, 2) carries no data and doesn't move the window while we have data in flight.
+        bool is_duplicate = !payload_size && !packet.has_syn() && !packet.has_fin() && window == m_send_window && m_send_max != m_send_unacknowledged;
+        m_send_window = window;
+        if (is_duplicate) {
+            ++m_duplicate_acks;
+            if (m_in_fast_recovery) {
+                m_congestion_window += m_send_mss;
+            } else if (m_duplicate_acks == 3) {
+#ifdef TCP_SOCKET_DEBUG
+                dbg() << "TCPSocket{" << this << "} fast retransmit of " << m_send_unacknowledged;
+#endif
+                m_slow_start_threshold = max(bytes_in_flight() / 2, 2 * m_send_mss);
+                m_recover = m_send_max;
+                m_in_fast_recovery = true;
+                retransmit_first_segment();
+                m_congestion_window = m_slow_start_threshold + 3 * m_send_mss;
+            }
+        }
+        send_outgoing_packets();
+        return;
+    }
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size };
+    if (m_timing_segment && !sequence_before(ack_number, m_timed_sequence_number)) {
+        m_timing_segment = false;
+        update_round_trip_time((g_uptime - m_timed_segment_sent_at) / TimeUnit::MS);
+    } else if (m_has_round_trip_time) {
+        // New data got through, so stop backing off. Waiting for the next clean sample instead can take
+        // a very long time on a lossy path, since every timeout makes the next sample less likely.
+        m_retransmission_timeout = estimated_retransmission_timeout();
+    }
 
-    u32 checksum = 0;
-    auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
-    for (size_t i = 0; i < sizeof(pseudo_header) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+    size_t remaining = acknowledged;
+    if (m_syn_unacknowledged) {
+        m_syn_unacknowledged = false;
+        --remaining;
+    }
+    size_t data_acknowledged = min(remaining, m_send_buffer_size);
+    m_send_buffer_start = (m_send_buffer_start + data_acknowledged) % send_buffer_capacity;
+    m_send_buffer_size -= data_acknowledged;
+    if (remaining > data_acknowledged) {
+        ASSERT(m_fin_queued);
+        m_fin_acknowledged = true;
+    }
+
+    m_send_unacknowledged = ack_number;
+    if (sequence_before(m_send_next, ack_number))
+        m_send_next = ack_number;
+    m_send_window = window;
+
+    if (m_in_fast_recovery) {
+        if (!sequence_before(ack_number, m_recover)) {
+            // Everything sent before we noticed the loss has arrived (RFC 6582, 3.2, step 3).
+            m_congestion_window = min(m_slow_start_threshold, max(bytes_in_flight(), m_send_mss) + m_send_mss);
+            m_in_fast_recovery = false;
+            m_duplicate_acks = 0;
+        } else {
+            // Another hole right behind the one we filled; retransmit it without waiting for more duplicates.
+            retransmit_first_segment();
+            m_congestion_window -= min(acknowledged, m_congestion_window);
+            if (acknowledged >= m_send_mss)
+                m_congestion_window += m_send_mss;
+        }
+    } else {
+        m_duplicate_acks = 0;
+        if (m_congestion_window < m_slow_start_threshold)
+            m_congestion_window += min(acknowledged, m_send_mss);
+        else
+            m_congestion_window += max((size_t)1, m_send_mss * m_send_mss / m_congestion_window);
+        // We can't have more than the send buffer in flight, so there's no point in growing past it.
+        m_congestion_window = min(m_congestion_window, max(send_buffer_capacity, initial_congestion_window(m_send_mss)));
     }
-    w = (const NetworkOrdered<u16>*)&packet;
-    for (size_t i = 0; i < sizeof(packet) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+
+    if (m_send_unacknowledged == m_sequence_number)
+        m_retransmission_timer_expires = 0;
+    else
+        start_retransmission_timer();
+
+    if (data_acknowledged)
+        evaluate_block_conditions();
+
+    send_outgoing_packets();
+}
+
+void TCPSocket::fire_timers()
+{
+    Vector<NonnullRefPtr<TCPSocket>> sockets;
+    connections().for_each([&](TCPSocket& socket) {
+        if (socket.m_retransmission_timer_expires || socket.m_delayed_ack_timer_expires)
+            sockets.append(socket);
+    });
+
+    u64 next_expires = 0;
+    for (auto& socket : sockets) {
+        u64 expires = socket->fire_timers_if_due(g_uptime);
+        if (expires && (!next_expires || expires < next_expires))
+            next_expires = expires;
     }
-    ASSERT(packet.data_offset() * 4 == sizeof(TCPPacket));
-    w = (const NetworkOrdered<u16>*)packet.payload();
-    for (size_t i = 0; i < payload_size / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+    if (next_expires)
+        arm_timer(next_expires);
+}
+
+u64 TCPSocket::fire_timers_if_due(u64 now)
+{
+    LOCKER(m_connection_lock);
+    if (m_state == State::Closed) {
+        m_delayed_ack_timer_expires = 0;
+        m_retransmission_timer_expires = 0;
+        return 0;
     }
-    if (payload_size & 1) {
-        u16 expanded_byte = ((const u8*)packet.payload())[payload_size - 1] << 8;
-        checksum += expanded_byte;
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+
+    if (m_delayed_ack_timer_expires && m_delayed_ack_timer_expires <= now)
+        send_segment(TCPFlags::ACK, m_send_next, 0, 0);
+
+    if (m_retransmission_timer_expires && m_retransmission_timer_expires <= now) {
+        m_retransmission_timer_expires = 0;
+        on_retransmission_timeout();
     }
-    return ~(checksum & 0xffff);
+
+    u64 next_expires = m_delayed_ack_timer_expires;
+    if (m_retransmission_timer_expires && (!next_expires || m_retransmission_timer_expires < next_expires))
+        next_expires = m_retransmission_timer_expires;
+    return next_expires;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+{
+    IPv4PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, (u16)(packet.header_size() + payload_size) };
+
+    // The header and the payload are next to each other, so they're summed in one go.
+    InternetChecksum checksum;
+    checksum.add(&pseudo_header, sizeof(pseudo_header));
+    checksum.add(&packet, packet.header_size() + payload_size);
+    return checksum.finish();
 }
 
 KResult TCPSocket::protocol_bind()
@@ -342,10 +819,8 @@ KResult TCPSocket::protocol_bind()
 
 KResult TCPSocket::protocol_listen()
 {
-    LOCKER(sockets_by_tuple().lock());
-    if (sockets_by_tuple().resource().contains(tuple()))
+    if (!listeners().add(tuple(), *this))
         return KResult(-EADDRINUSE);
-    sockets_by_tuple().resource().set(tuple(), this);
     set_direction(Direction::Passive);
     set_state(State::Listen);
     set_setup_state(SetupState::Completed);
@@ -362,7 +837,7 @@ KResult TCPSocket::protocol_connect(FileDescription& description, ShouldBlock sh
 
     allocate_local_port_if_needed();
 
-    m_sequence_number = get_good_random<u32>();
+    set_sequence_number(get_good_random<u32>());
     m_ack_number = 0;
 
     set_setup_state(SetupState::InProgress);
@@ -387,28 +862,18 @@ KResult TCPSocket::protocol_connect(FileDescription& description, ShouldBlock sh
 
 int TCPSocket::protocol_allocate_local_port()
 {
-    static const u16 first_ephemeral_port = 32768;
-    static const u16 last_ephemeral_port = 60999;
-    static const u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
-    u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
-
-    LOCKER(sockets_by_tuple().lock());
-    for (u16 port = first_scan_port;;) {
-        IPv4SocketTuple proposed_tuple(local_address(), port, peer_address(), peer_port());
-
-        auto it = sockets_by_tuple().resource().find(proposed_tuple);
-        if (it == sockets_by_tuple().resource().end()) {
-            set_local_port(port);
-            sockets_by_tuple().resource().set(proposed_tuple, this);
-            return port;
-        }
-        ++port;
-        if (port > last_ephemeral_port)
-            port = first_ephemeral_port;
-        if (port == first_scan_port)
-            break;
-    }
-    return -EADDRINUSE;
+    u16 port = ephemeral_ports().allocate([&](u16 candidate) {
+        IPv4SocketTuple proposed_tuple(local_address(), candidate, peer_address(), peer_port());
+        // A socket that's about to listen gets added to the listening sockets by protocol_listen().
+        if (!peer_port())
+            return !listeners().contains(proposed_tuple);
+        return connections().add(proposed_tuple, *this);
+    });
+    if (!port)
+        return -EADDRINUSE;
+    set_local_port(port);
+    m_has_ephemeral_port = true;
+    return port;
 }
 
 bool TCPSocket::protocol_is_disconnected() const
@@ -28,9 +28,10 @@
 
 #include <AK/Function.h>
 #include <AK/HashMap.h>
-#include <AK/SinglyLinkedList.h>
 #include <AK/WeakPtr.h>
+#include <Kernel/Net/EphemeralPortAllocator.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/SocketTable.h>
 
 namespace Kernel {
 
@@ -141,19 +142,35 @@ public:
     void set_error(Error error) { m_error = error; }
 
     void set_ack_number(u32 n) { m_ack_number = n; }
-    void set_sequence_number(u32 n) { m_sequence_number = n; }
+    void set_sequence_number(u32);
     u32 ack_number() const { return m_ack_number; }
     u32 sequence_number() const { return m_sequence_number; }
     u32 packets_in() const { return m_packets_in; }
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t send_window() const { return m_send_window; }
+    u32 retransmission_timeout() const { return m_retransmission_timeout; }
 
-    void send_tcp_packet(u16 flags, const void* = nullptr, size_t = 0);
-    void send_outgoing_packets();
+    // SYN and FIN take their place in the send queue and are retransmitted like data, everything else goes out right away.
+    void send_tcp_packet(u16 flags);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void receive_syn_options(const TCPPacket&);
+    // Acknowledges in-order data. The ACK is held back a little unless another segment is already waiting for one.
+    void acknowledge_received_data();
+    bool is_fin_acknowledged() const { return m_fin_acknowledged; }
+
+    virtual bool can_write(const FileDescription&) const override;
+
+    // Lets sendfile() read file data straight into the send buffer instead of staging it somewhere else first.
+    // fill() is called without the connection lock held, so it may block on disk I/O. It gets room for up to
+    // max_size bytes and returns how many it filled in, or an error. Blocks for room like a write would.
+    ssize_t send_from(FileDescription&, size_t max_size, Function<ssize_t(u8*, size_t)> fill);
+
+    // Runs the retransmission and delayed ACK timers that are due. Called by the network task.
+    static void fire_timers();
 
-    static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
     static RefPtr<TCPSocket> from_endpoints(const IPv4Address& local_address, u16 local_port, const IPv4Address& peer_address, u16 peer_port);
 
@@ -174,24 +191,42 @@ private:
     explicit TCPSocket(int protocol);
     virtual const char* class_name() const override { return "TCPSocket"; }
 
+    // Connections are found by their whole tuple, and listening sockets by their local address and port only.
+    static SocketTable<IPv4SocketTuple, TCPSocket>& connections();
+    static SocketTable<IPv4SocketTuple, TCPSocket>& listeners();
+    static EphemeralPortAllocator& ephemeral_ports();
+
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
 
     virtual void shut_down_for_writing() override;
 
     virtual int protocol_receive(const KBuffer&, void* buffer, size_t buffer_size, int flags) override;
     virtual int protocol_send(const void*, size_t) override;
+    virtual void protocol_did_read() override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
     virtual bool protocol_is_disconnected() const override;
     virtual KResult protocol_bind() override;
     virtual KResult protocol_listen() override;
 
+    void send_outgoing_packets();
+    void send_segment(u16 flags, u32 sequence_number, size_t offset, size_t size);
+    void retransmit_first_segment();
+    void receive_ack(const TCPPacket&, size_t payload_size);
+    void update_round_trip_time(u32 sample);
+    u32 estimated_retransmission_timeout() const;
+    void on_retransmission_timeout();
+    u64 fire_timers_if_due(u64 now);
+    void start_retransmission_timer();
+    size_t bytes_in_flight() const { return m_send_next - m_send_unacknowledged; }
+    size_t advertised_window() const;
+
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
+    bool m_has_ephemeral_port { false };
     Error m_error { Error::None };
     RefPtr<NetworkAdapter> m_adapter;
-    u32 m_sequence_number { 0 };
     u32 m_ack_number { 0 };
     State m_state { State::Closed };
     u32 m_packets_in { 0 };
@@ -199,15 +234,56 @@ private:
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
 
-    struct OutgoingPacket {
-        u32 ack_number { 0 };
-        ByteBuffer buffer;
-        int tx_counter { 0 };
-        timeval tx_time { 0, 0 };
-    };
+    Lock m_connection_lock { "TCPSocket" };
+
+    // Sequence numbers, in the spirit of RFC 793: everything before m_send_unacknowledged has been acknowledged,
+    // everything before m_send_next has been sent, and m_sequence_number is just past the last queued byte (or FIN).
+    // m_send_max is the highest sequence number sent so far; m_send_next falls back behind it after a timeout.
+    u32 m_sequence_number { 0 };
+    u32 m_send_unacknowledged { 0 };
+    u32 m_send_next { 0 };
+    u32 m_send_max { 0 };
+
+    // Bytes from m_send_unacknowledged up to m_sequence_number, kept until they are acknowledged.
+    Optional<KBuffer> m_send_buffer;
+    size_t m_send_buffer_start { 0 };
+    size_t m_send_buffer_size { 0 };
+    // Room right after the queued bytes that send_from() is filling in. Nobody else may append while it's non-zero.
+    size_t m_send_buffer_reserved { 0 };
+
+    u16 m_syn_flags { 0 };
+    bool m_syn_unacknowledged { false };
+    bool m_fin_queued { false };
+    bool m_fin_acknowledged { false };
+
+    size_t m_send_mss { 536 };
+    size_t m_receive_mss { 536 };
+    bool m_window_scaling { false };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    size_t m_send_window { 0 };
+    u32 m_advertised_window_end { 0 };
+
+    // NewReno congestion control (RFC 5681, RFC 6582).
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { 0 };
+    u32 m_duplicate_acks { 0 };
+    bool m_in_fast_recovery { false };
+    u32 m_recover { 0 };
+
+    // Round-trip time estimation (RFC 6298), in milliseconds. One segment at a time is timed, and never a retransmitted one.
+    bool m_has_round_trip_time { false };
+    u32 m_smoothed_round_trip_time { 0 };
+    u32 m_round_trip_time_variance { 0 };
+    u32 m_retransmission_timeout { 0 };
+    bool m_timing_segment { false };
+    u32 m_timed_sequence_number { 0 };
+    u64 m_timed_segment_sent_at { 0 };
+
+    u32 m_segments_awaiting_ack { 0 };
 
-    Lock m_not_acked_lock { "TCPSocket unacked packets" };
-    SinglyLinkedList<OutgoingPacket> m_not_acked;
+    u64 m_retransmission_timer_expires { 0 };
+    u64 m_delayed_ack_timer_expires { 0 };
 };
 
 }
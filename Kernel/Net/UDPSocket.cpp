@@ -26,40 +26,43 @@
 
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
 
+//#define UDP_SOCKET_DEBUG
+
 namespace Kernel {
 
 void UDPSocket::for_each(Function<void(UDPSocket&)> callback)
 {
-    LOCKER(sockets_by_port().lock());
-    for (auto it : sockets_by_port().resource())
-        callback(*it.value);
+    sockets_by_port().for_each([&](UDPSocket& socket) { callback(socket); });
 }
 
-Lockable<HashMap<u16, UDPSocket*>>& UDPSocket::sockets_by_port()
+SocketTable<u16, UDPSocket>& UDPSocket::sockets_by_port()
 {
-    static Lockable<HashMap<u16, UDPSocket*>>* s_map;
-    if (!s_map)
-        s_map = new Lockable<HashMap<u16, UDPSocket*>>;
-    return *s_map;
+    static SocketTable<u16, UDPSocket>* s_table;
+    if (!s_table)
+        s_table = new SocketTable<u16, UDPSocket>;
+    return *s_table;
+}
+
+EphemeralPortAllocator& UDPSocket::ephemeral_ports()
+{
+    static EphemeralPortAllocator* s_allocator;
+    if (!s_allocator)
+        s_allocator = new EphemeralPortAllocator;
+    return *s_allocator;
 }
 
 SocketHandle<UDPSocket> UDPSocket::from_port(u16 port)
 {
-    RefPtr<UDPSocket> socket;
-    {
-        LOCKER(sockets_by_port().lock());
-        auto it = sockets_by_port().resource().find(port);
-        if (it == sockets_by_port().resource().end())
-            return {};
-        socket = (*it).value;
-        ASSERT(socket);
-    }
+    auto socket = sockets_by_port().get(port);
+    if (!socket)
+        return {};
     return { *socket };
 }
 
@@ -70,8 +73,9 @@ UDPSocket::UDPSocket(int protocol)
 
 UDPSocket::~UDPSocket()
 {
-    LOCKER(sockets_by_port().lock());
-    sockets_by_port().resource().remove(local_port());
+    sockets_by_port().remove(local_port(), *this);
+    if (m_has_ephemeral_port)
+        ephemeral_ports().release(local_port());
 }
 
 NonnullRefPtr<UDPSocket> UDPSocket::create(int protocol)
@@ -95,14 +99,26 @@ int UDPSocket::protocol_send(const void* data, size_t data_length)
     auto routing_decision = route_to(peer_address(), local_address());
     if (routing_decision.is_zero())
         return -EHOSTUNREACH;
-    auto buffer = ByteBuffer::create_zeroed(sizeof(UDPPacket) + data_length);
-    auto& udp_packet = *(UDPPacket*)(buffer.data());
+    PacketBuffer packet(data_length);
+    u8* payload = packet.data();
+    auto& udp_packet = *(UDPPacket*)packet.prepend(sizeof(UDPPacket));
     udp_packet.set_source_port(local_port());
     udp_packet.set_destination_port(peer_port());
     udp_packet.set_length(sizeof(UDPPacket) + data_length);
-    memcpy(udp_packet.payload(), data, data_length);
+
+    // This is the only time the payload gets copied on its way out (from userspace, usually), so it's checksummed on the way.
+    IPv4PseudoHeader pseudo_header { routing_decision.adapter->ipv4_address(), peer_address(), 0, (u8)IPv4Protocol::UDP, (u16)(sizeof(UDPPacket) + data_length) };
+    InternetChecksum checksum;
+    checksum.add(&pseudo_header, sizeof(pseudo_header));
+    checksum.add(&udp_packet, sizeof(UDPPacket));
+    checksum.add_while_copying(payload, data, data_length);
+    // A checksum of zero means "no checksum" in UDP, so it's sent as its ones' complement equivalent instead.
+    u16 udp_checksum = checksum.finish();
+    udp_packet.set_checksum(udp_checksum ? udp_checksum : 0xffff);
+#ifdef UDP_SOCKET_DEBUG
     klog() << "sending as udp packet from " << routing_decision.adapter->ipv4_address().to_string().characters() << ":" << local_port() << " to " << peer_address().to_string().characters() << ":" << peer_port() << "!";
-    routing_decision.adapter->send_ipv4(routing_decision.next_hop, peer_address(), IPv4Protocol::UDP, buffer.data(), buffer.size(), ttl());
+#endif
+    routing_decision.adapter->send_ipv4(routing_decision.next_hop, peer_address(), IPv4Protocol::UDP, packet, ttl());
     return data_length;
 }
 
@@ -115,34 +131,20 @@ KResult UDPSocket::protocol_connect(FileDescription&, ShouldBlock)
 
 int UDPSocket::protocol_allocate_local_port()
 {
-    static const u16 first_ephemeral_port = 32768;
-    static const u16 last_ephemeral_port = 60999;
-    static const u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
-    u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
-
-    LOCKER(sockets_by_port().lock());
-    for (u16 port = first_scan_port;;) {
-        auto it = sockets_by_port().resource().find(port);
-        if (it == sockets_by_port().resource().end()) {
-            set_local_port(port);
-            sockets_by_port().resource().set(port, this);
-            return port;
-        }
-        ++port;
-        if (port > last_ephemeral_port)
-            port = first_ephemeral_port;
-        if (port == first_scan_port)
-            break;
-    }
-    return -EADDRINUSE;
+    u16 port = ephemeral_ports().allocate([&](u16 candidate) {
+        return sockets_by_port().add(candidate, *this);
+    });
+    if (!port)
+        return -EADDRINUSE;
+    set_local_port(port);
+    m_has_ephemeral_port = true;
+    return port;
 }
 
 KResult UDPSocket::protocol_bind()
 {
-    LOCKER(sockets_by_port().lock());
-    if (sockets_by_port().resource().contains(local_port()))
+    if (!sockets_by_port().add(local_port(), *this))
         return KResult(-EADDRINUSE);
-    sockets_by_port().resource().set(local_port(), this);
     return KSuccess;
 }
 
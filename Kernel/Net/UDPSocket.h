@@ -26,7 +26,9 @@
 
 #pragma once
 
+#include <Kernel/Net/EphemeralPortAllocator.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/SocketTable.h>
 
 namespace Kernel {
 
@@ -41,13 +43,16 @@ public:
 private:
     explicit UDPSocket(int protocol);
     virtual const char* class_name() const override { return "UDPSocket"; }
-    static Lockable<HashMap<u16, UDPSocket*>>& sockets_by_port();
+    static SocketTable<u16, UDPSocket>& sockets_by_port();
+    static EphemeralPortAllocator& ephemeral_ports();
 
     virtual int protocol_receive(const KBuffer&, void* buffer, size_t buffer_size, int flags) override;
     virtual int protocol_send(const void*, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
     virtual KResult protocol_bind() override;
+
+    bool m_has_ephemeral_port { false };
 };
 
 }
@@ -40,6 +40,7 @@
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/DevPtsFS.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/Ext2FileSystem.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/FileDescription.h>
@@ -54,6 +55,7 @@
 #include <Kernel/Module.h>
 #include <Kernel/Multiboot.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/Net/TCPSocket.h>
 #include <Kernel/PerformanceEventBuffer.h>
 #include <Kernel/Process.h>
 #include <Kernel/Profiling.h>
@@ -67,6 +69,7 @@
 #include <Kernel/Thread.h>
 #include <Kernel/ThreadTracer.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/PurgeableVMObject.h>
@@ -1299,7 +1302,7 @@ Process* Process::create_user_process(Thread*& first_thread, const String& path,
         root = VFS::the().root_custody();
 
     auto* process = new Process(first_thread, parts.take_last(), uid, gid, parent_pid, Ring3, move(cwd), nullptr, tty);
-    process->m_fds.resize(m_max_open_file_descriptors);
+    process->m_fds.resize(m_initial_fd_table_size);
     auto& device_to_use_as_tty = tty ? (CharacterDevice&)*tty : NullDevice::the();
     auto description = device_to_use_as_tty.open(O_RDWR).value();
     process->m_fds[0].set(*description);
@@ -2037,11 +2040,15 @@ int Process::sys$open(const Syscall::SC_open_params* user_params)
 
 int Process::alloc_fd(int first_candidate_fd)
 {
-    for (int i = first_candidate_fd; i < (int)m_max_open_file_descriptors; ++i) {
+    for (int i = first_candidate_fd; i < (int)m_fds.size(); ++i) {
         if (!m_fds[i])
             return i;
     }
-    return -EMFILE;
+    int fd = max(first_candidate_fd, (int)m_fds.size());
+    if (fd >= m_max_open_file_descriptors)
+        return -EMFILE;
+    m_fds.resize(min(max(fd + 1, (int)m_fds.size() * 2), m_max_open_file_descriptors));
+    return fd;
 }
 
 int Process::sys$pipe(int pipefd[2], int flags)
@@ -2105,18 +2112,36 @@ int Process::sys$setgid(gid_t gid)
 unsigned Process::sys$alarm(unsigned seconds)
 {
     REQUIRE_PROMISE(stdio);
+    InterruptDisabler disabler;
     unsigned previous_alarm_remaining = 0;
     if (m_alarm_deadline && m_alarm_deadline > g_uptime) {
         previous_alarm_remaining = (m_alarm_deadline - g_uptime) / TimeManagement::the().ticks_per_second();
     }
-    if (!seconds) {
-        m_alarm_deadline = 0;
+    cancel_alarm();
+    if (!seconds)
         return previous_alarm_remaining;
-    }
     m_alarm_deadline = g_uptime + seconds * TimeManagement::the().ticks_per_second();
+
+    auto timer = make<Timer>();
+    timer->expires = m_alarm_deadline;
+    timer->callback = [this] {
+        m_alarm_timer_id = 0;
+        m_alarm_deadline = 0;
+        send_signal(SIGALRM, nullptr);
+    };
+    m_alarm_timer_id = TimerQueue::the().add_timer(move(timer));
     return previous_alarm_remaining;
 }
 
+void Process::cancel_alarm()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    if (m_alarm_timer_id)
+        TimerQueue::the().cancel_timer(m_alarm_timer_id);
+    m_alarm_timer_id = 0;
+    m_alarm_deadline = 0;
+}
+
 int Process::sys$uname(utsname* buf)
 {
     REQUIRE_PROMISE(stdio);
@@ -2328,6 +2353,7 @@ siginfo_t Process::reap(Process& process)
             if (parent) {
                 parent->m_ticks_in_user_for_dead_children += process.m_ticks_in_user + process.m_ticks_in_user_for_dead_children;
                 parent->m_ticks_in_kernel_for_dead_children += process.m_ticks_in_kernel + process.m_ticks_in_kernel_for_dead_children;
+                parent->wait_block_condition().notify_all();
             }
         }
 
@@ -2336,11 +2362,35 @@ siginfo_t Process::reap(Process& process)
 #endif
         ASSERT(process.is_dead());
         g_processes->remove(&process);
+
+        // Any dead children of the reaped process are now unparented, let the finalizer reap them.
+        g_finalizer_has_work = true;
+        g_finalizer_wait_queue->wake_all();
     }
     delete &process;
     return siginfo;
 }
 
+void Process::reap_unparented_dead_processes()
+{
+    ASSERT(Thread::current == g_finalizer);
+    Vector<Process*, 16> unparented_processes;
+    {
+        InterruptDisabler disabler;
+        Process::for_each([&](Process& process) {
+            if (process.is_dead() && (!process.ppid() || !Process::from_pid(process.ppid())))
+                unparented_processes.append(&process);
+            return IterationDecision::Continue;
+        });
+    }
+    for (auto* process : unparented_processes) {
+        auto name = process->name();
+        auto pid = process->pid();
+        auto exit_status = Process::reap(*process);
+        dbg() << "Finalizer: Reaped unparented process " << name << "(" << pid << "), exit status: " << exit_status.si_status;
+    }
+}
+
 KResultOr<siginfo_t> Process::do_waitid(idtype_t idtype, int id, int options)
 {
     if (idtype == P_PID) {
@@ -2599,6 +2649,8 @@ int Process::sys$dup2(int old_fd, int new_fd)
         return -EBADF;
     if (new_fd < 0 || new_fd >= m_max_open_file_descriptors)
         return -EINVAL;
+    if (new_fd >= (int)m_fds.size())
+        m_fds.resize(new_fd + 1);
     m_fds[new_fd].set(*description);
     return new_fd;
 }
@@ -2784,7 +2836,7 @@ int Process::sys$select(const Syscall::SC_select_params* params)
         return -EFAULT;
     if (timeout && !validate_read_typed(timeout))
         return -EFAULT;
-    if (nfds < 0)
+    if (nfds < 0 || nfds > FD_SETSIZE)
         return -EINVAL;
 
     timeval computed_timeout;
@@ -2922,6 +2974,206 @@ int Process::sys$poll(pollfd* fds, int nfds, int timeout)
     return fds_with_revents;
 }
 
+int Process::sys$epoll_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+    // Reject flags other than O_CLOEXEC.
+    if ((flags & O_CLOEXEC) != flags)
+        return -EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    m_fds[fd].set(FileDescription::create(EPoll::create()), (flags & O_CLOEXEC) ? FD_CLOEXEC : 0);
+    m_fds[fd].description->set_readable(true);
+    return fd;
+}
+
+int Process::sys$epoll_ctl(const Syscall::SC_epoll_ctl_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_ctl_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    auto epoll_description = file_description(params.epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_epoll())
+        return -EINVAL;
+    auto& epoll = static_cast<EPoll&>(epoll_description->file());
+
+    epoll_event event;
+    if (params.op != EPOLL_CTL_DEL) {
+        if (!validate_read_and_copy_typed(&event, params.event))
+            return -EFAULT;
+    }
+
+    // Interests belong to the fd together with the description it refers to right now.
+    auto description = file_description(params.fd);
+    if (!description)
+        return -EBADF;
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return epoll.add_interest(params.fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return epoll.modify_interest(params.fd, *description, event);
+    case EPOLL_CTL_DEL:
+        return epoll.remove_interest(params.fd, *description);
+    default:
+        return -EINVAL;
+    }
+}
+
+int Process::sys$epoll_wait(const Syscall::SC_epoll_wait_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_epoll_wait_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if (params.max_events <= 0)
+        return -EINVAL;
+    if (!validate_write_typed(params.events, params.max_events))
+        return -EFAULT;
+
+    auto epoll_description = file_description(params.epfd);
+    if (!epoll_description)
+        return -EBADF;
+    if (!epoll_description->file().is_epoll())
+        return -EINVAL;
+    auto& epoll = static_cast<EPoll&>(epoll_description->file());
+
+    // Returning fewer events than asked for is fine, and keeps the kernel buffer bounded.
+    static constexpr int max_events_per_wait = 256;
+    Vector<epoll_event> events;
+    events.resize(min(params.max_events, max_events_per_wait));
+
+    timeval deadline {};
+    bool has_timeout = params.timeout >= 0;
+    if (has_timeout) {
+        timeval relative_timeout { params.timeout / 1000, (params.timeout % 1000) * 1000 };
+        timeval_add(Scheduler::time_since_boot(), relative_timeout, deadline);
+    }
+
+    int event_count = 0;
+    for (;;) {
+        event_count = epoll.collect_ready_events(events.data(), events.size());
+        if (event_count || params.timeout == 0)
+            break;
+        if (has_timeout) {
+            auto now = Scheduler::time_since_boot();
+            if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_usec >= deadline.tv_usec))
+                break;
+        }
+        // The EPoll notifies its block condition when one of the interests may have become ready.
+        if (Thread::current->block<Thread::EPollBlocker>(*epoll_description, deadline, has_timeout) != Thread::BlockResult::WokeNormally)
+            return -EINTR;
+    }
+
+    // While we blocked, the process lock was dropped, so re-validate the output buffer.
+    if (!validate_write_typed(params.events, event_count))
+        return -EFAULT;
+    copy_to_user(params.events, events.data(), event_count * sizeof(epoll_event));
+    return event_count;
+}
+
+ssize_t Process::sys$sendfile(const Syscall::SC_sendfile_params* user_params)
+{
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+    if ((ssize_t)params.count < 0)
+        return -EINVAL;
+
+    auto in_description = file_description(params.in_fd);
+    auto out_description = file_description(params.out_fd);
+    if (!in_description || !out_description)
+        return -EBADF;
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return -EBADF;
+
+    // Only regular files can be read at an arbitrary offset, which we need when the write comes up short.
+    auto* inode = in_description->inode();
+    if (!inode || !inode->metadata().is_regular_file())
+        return -EINVAL;
+
+    off_t offset;
+    if (params.offset) {
+        if (!validate_read_and_copy_typed(&offset, params.offset))
+            return -EFAULT;
+        if (offset < 0)
+            return -EINVAL;
+    } else {
+        offset = in_description->offset();
+    }
+
+    if (params.count == 0)
+        return 0;
+
+    ssize_t nsent = 0;
+    auto* socket = out_description->socket();
+    if (socket && socket->is_ipv4() && socket->type() == SOCK_STREAM) {
+        // The file is read straight into the socket's send buffer. This isn't zero-copy: the data is copied
+        // from the disk cache into the send buffer, and from there into each outgoing packet.
+        auto& tcp_socket = static_cast<TCPSocket&>(*socket);
+        while ((size_t)nsent < params.count) {
+            ssize_t nread = tcp_socket.send_from(*out_description, params.count - nsent, [&](u8* buffer, size_t size) {
+                return inode->read_bytes(offset, size, buffer, in_description.ptr());
+            });
+            if (nread < 0) {
+                if (nsent == 0)
+                    return nread;
+                break;
+            }
+            if (nread == 0)
+                break;
+            Thread::current->did_file_read(nread);
+            offset += nread;
+            nsent += nread;
+        }
+    } else {
+        // Anything else gets the data through one kernel buffer, which still saves the trip through userspace.
+        static constexpr size_t max_chunk_size = 64 * KB;
+        auto buffer = KBuffer::create_with_size(PAGE_ROUND_UP(min(params.count, max_chunk_size)), Region::Access::Read | Region::Access::Write, "sendfile");
+        while ((size_t)nsent < params.count) {
+            ssize_t chunk_size = min(params.count - nsent, max_chunk_size);
+            ssize_t nread = inode->read_bytes(offset, chunk_size, buffer.data(), in_description.ptr());
+            if (nread < 0) {
+                if (nsent == 0)
+                    return nread;
+                break;
+            }
+            if (nread == 0)
+                break;
+            Thread::current->did_file_read(nread);
+
+            ssize_t nwritten = do_write(*out_description, buffer.data(), nread);
+            if (nwritten < 0) {
+                if (nsent == 0)
+                    return nwritten;
+                break;
+            }
+            offset += nwritten;
+            nsent += nwritten;
+            if (nwritten < nread)
+                break;
+        }
+    }
+
+    if (params.offset) {
+        // While we blocked, the process lock was dropped, so re-validate the offset pointer.
+        if (!validate_write_typed(params.offset))
+            return -EFAULT;
+        copy_to_user(params.offset, &offset, sizeof(offset));
+    } else {
+        in_description->seek(offset, SEEK_SET);
+    }
+    return nsent;
+}
+
 Custody& Process::current_directory()
 {
     if (!m_cwd)
@@ -3058,6 +3310,7 @@ void Process::finalize()
     disown_all_shared_buffers();
     {
         InterruptDisabler disabler;
+        cancel_alarm();
         if (auto* parent_thread = Thread::from_tid(m_ppid)) {
             if (parent_thread->m_signal_action_data[SIGCHLD].flags & SA_NOCLDWAIT) {
                 // NOTE: If the parent doesn't care about this process, let it go.
@@ -3071,6 +3324,12 @@ void Process::finalize()
     m_regions.clear();
 
     m_dead = true;
+
+    {
+        InterruptDisabler disabler;
+        if (auto* parent = Process::from_pid(m_ppid))
+            parent->wait_block_condition().notify_all();
+    }
 }
 
 void Process::die()
@@ -4606,7 +4865,7 @@ int Process::sys$futex(const Syscall::SC_futex_params* user_params)
 int Process::sys$set_thread_boost(int tid, int amount)
 {
     REQUIRE_PROMISE(proc);
-    if (amount < 0 || amount > 20)
+    if (amount < 0 || amount > THREAD_PRIORITY_BOOST_MAX)
         return -EINVAL;
     InterruptDisabler disabler;
     auto* thread = Thread::from_tid(tid);
@@ -4623,7 +4882,7 @@ int Process::sys$set_thread_boost(int tid, int amount)
 int Process::sys$set_process_boost(pid_t pid, int amount)
 {
     REQUIRE_PROMISE(proc);
-    if (amount < 0 || amount > 20)
+    if (amount < 0 || amount > THREAD_PRIORITY_BOOST_MAX)
         return -EINVAL;
     InterruptDisabler disabler;
     auto* process = Process::from_pid(pid);
@@ -4632,6 +4891,10 @@ int Process::sys$set_process_boost(pid_t pid, int amount)
     if (!is_superuser() && process->uid() != euid())
         return -EPERM;
     process->m_priority_boost = amount;
+    process->for_each_thread([](Thread& thread) {
+        Scheduler::update_priority_for_thread(thread);
+        return IterationDecision::Continue;
+    });
     return 0;
 }
 
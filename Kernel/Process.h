@@ -300,6 +300,10 @@ public:
     int sys$perf_event(int type, FlatPtr arg1, FlatPtr arg2);
     int sys$get_stack_bounds(FlatPtr* stack_base, size_t* stack_size);
     int sys$ptrace(const Syscall::SC_ptrace_params*);
+    int sys$epoll_create(int flags);
+    int sys$epoll_ctl(const Syscall::SC_epoll_ctl_params*);
+    int sys$epoll_wait(const Syscall::SC_epoll_wait_params*);
+    ssize_t sys$sendfile(const Syscall::SC_sendfile_params*);
 
     template<bool sockname, typename Params>
     int get_sock_or_peer_name(const Params&);
@@ -307,7 +311,10 @@ public:
     static void initialize();
 
     [[noreturn]] void crash(int signal, u32 eip);
+    Thread::BlockCondition& wait_block_condition() { return m_wait_block_condition; }
+
     [[nodiscard]] static siginfo_t reap(Process&);
+    static void reap_unparented_dead_processes();
 
     const TTY* tty() const { return m_tty; }
     void set_tty(TTY*);
@@ -416,6 +423,8 @@ private:
     Process(Thread*& first_thread, const String& name, uid_t, gid_t, pid_t ppid, RingLevel, RefPtr<Custody> cwd = nullptr, RefPtr<Custody> executable = nullptr, TTY* = nullptr, Process* fork_parent = nullptr);
     static pid_t allocate_pid();
 
+    void cancel_alarm();
+
     Range allocate_range(VirtualAddress, size_t, size_t alignment = PAGE_SIZE);
 
     Region& add_region(NonnullOwnPtr<Region>);
@@ -458,7 +467,9 @@ private:
 
     pid_t m_exec_tid { 0 };
 
-    static const int m_max_open_file_descriptors { FD_SETSIZE };
+    // The fd table starts out big enough for select() and grows on demand up to the maximum.
+    static const int m_initial_fd_table_size { FD_SETSIZE };
+    static const int m_max_open_file_descriptors { 1024 };
 
     struct FileDescriptionAndFlags {
         operator bool() const { return !!description; }
@@ -506,6 +517,10 @@ private:
     Lock m_big_lock { "Process" };
 
     u64 m_alarm_deadline { 0 };
+    u64 m_alarm_timer_id { 0 };
+
+    // Notified whenever one of our children dies, stops or continues, or gets reaped.
+    Thread::BlockCondition m_wait_block_condition;
 
     int m_icon_id { -1 };
 
@@ -654,9 +669,16 @@ inline const LogStream& operator<<(const LogStream& stream, const Process& proce
     return stream << process.name() << '(' << process.pid() << ')';
 }
 
+inline u32 Thread::base_priority() const
+{
+    return m_priority + m_process.priority_boost() + m_priority_boost;
+}
+
 inline u32 Thread::effective_priority() const
 {
-    return m_priority + m_process.priority_boost() + m_priority_boost + m_extra_priority;
+    if (!is_runnable_state(m_state))
+        return base_priority();
+    return m_run_queue_priority + (g_scheduler_data->m_scheduling_passes - m_run_queue_enqueue_pass);
 }
 
 #define REQUIRE_NO_PROMISES                      \
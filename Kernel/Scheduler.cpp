@@ -24,7 +24,6 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/QuickSort.h>
 #include <AK/TemporaryChange.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Net/Socket.h>
@@ -45,20 +44,56 @@ SchedulerData* g_scheduler_data;
 
 void Scheduler::init_thread(Thread& thread)
 {
-    g_scheduler_data->m_nonrunnable_threads.append(thread);
+    g_scheduler_data->m_waiting_threads.append(thread);
+}
+
+bool Scheduler::thread_needs_polling(const Thread& thread)
+{
+    switch (thread.state()) {
+    case Thread::Blocked:
+        ASSERT(thread.m_blocker != nullptr);
+        return thread.m_blocker->needs_polling();
+    case Thread::Skip1SchedulerPass:
+    case Thread::Skip0SchedulerPasses:
+        return true;
+    default:
+        return false;
+    }
 }
 
 void Scheduler::update_state_for_thread(Thread& thread)
 {
     ASSERT_INTERRUPTS_DISABLED();
-    auto& list = g_scheduler_data->thread_list_for_state(thread.state());
+    auto& data = *g_scheduler_data;
 
+    if (Thread::is_runnable_state(thread.state())) {
+        if (!data.is_in_run_queue(thread))
+            data.enqueue_runnable(thread);
+        return;
+    }
+
+    if (data.is_in_run_queue(thread))
+        data.dequeue_runnable(thread);
+
+    auto& list = thread_needs_polling(thread) ? data.m_polled_threads : data.m_waiting_threads;
     if (list.contains(thread))
         return;
 
     list.append(thread);
 }
 
+void Scheduler::update_priority_for_thread(Thread& thread)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    auto& data = *g_scheduler_data;
+    if (!data.is_in_run_queue(thread))
+        return;
+    if (thread.m_run_queue_priority == min(thread.base_priority(), SchedulerData::run_queue_count - 1))
+        return;
+    data.dequeue_runnable(thread);
+    data.enqueue_runnable(thread);
+}
+
 static u32 time_slice_for(const Thread& thread)
 {
     // One time slice unit == 1ms
@@ -91,6 +126,83 @@ bool Scheduler::is_active()
     return s_active;
 }
 
+Thread::Blocker::Blocker()
+    : m_thread(*Thread::current)
+{
+}
+
+Thread::Blocker::~Blocker()
+{
+    InterruptDisabler disabler;
+    if (m_timeout_timer_id)
+        TimerQueue::the().cancel_timer(m_timeout_timer_id);
+}
+
+void Thread::Blocker::notify()
+{
+    InterruptDisabler disabler;
+    if (m_was_notified)
+        return;
+    m_was_notified = true;
+    // If we haven't blocked yet, the scheduler will see that we need polling once we do.
+    if (m_thread.state() == Thread::Blocked && m_thread.m_blocker == this)
+        Scheduler::update_state_for_thread(m_thread);
+}
+
+void Thread::Blocker::set_timeout(u64 wakeup_time)
+{
+    InterruptDisabler disabler;
+    ASSERT(!m_timeout_timer_id);
+    if (wakeup_time <= g_uptime) {
+        m_timed_out = true;
+        notify();
+        return;
+    }
+    auto timer = make<Timer>();
+    timer->expires = wakeup_time;
+    timer->callback = [this] {
+        m_timeout_timer_id = 0;
+        m_timed_out = true;
+        notify();
+    };
+    m_timeout_timer_id = TimerQueue::the().add_timer(move(timer));
+}
+
+void Thread::BlockCondition::add_blocker(Blocker& blocker)
+{
+    InterruptDisabler disabler;
+    m_blockers.append(&blocker);
+}
+
+void Thread::BlockCondition::remove_blocker(Blocker& blocker)
+{
+    InterruptDisabler disabler;
+    m_blockers.remove_first_matching([&](auto* entry) { return entry == &blocker; });
+}
+
+void Thread::BlockCondition::notify_all()
+{
+    InterruptDisabler disabler;
+    for (auto* blocker : m_blockers)
+        blocker->notify();
+}
+
+static bool is_deadline_reached(const timeval& deadline, time_t now_sec, long now_usec)
+{
+    return now_sec > deadline.tv_sec || (now_sec == deadline.tv_sec && now_usec >= deadline.tv_usec);
+}
+
+// Converts a deadline relative to Scheduler::time_since_boot() into the first g_uptime tick at or after it.
+static u64 uptime_for_deadline(const timeval& deadline)
+{
+    auto now = Scheduler::time_since_boot();
+    if (is_deadline_reached(deadline, now.tv_sec, now.tv_usec))
+        return g_uptime;
+    u64 usec_left = (u64)(deadline.tv_sec - now.tv_sec) * 1000000 + deadline.tv_usec - now.tv_usec;
+    u64 ticks_per_second = TimeManagement::the().ticks_per_second();
+    return g_uptime + (usec_left * ticks_per_second + 999999) / 1000000;
+}
+
 Thread::JoinBlocker::JoinBlocker(Thread& joinee, void*& joinee_exit_value)
     : m_joinee(joinee)
     , m_joinee_exit_value(joinee_exit_value)
@@ -108,6 +220,17 @@ bool Thread::JoinBlocker::should_unblock(Thread& joiner, time_t, long)
 Thread::FileDescriptionBlocker::FileDescriptionBlocker(const FileDescription& description)
     : m_blocked_description(description)
 {
+    m_blocked_description->file().block_condition().add_blocker(*this);
+}
+
+Thread::FileDescriptionBlocker::~FileDescriptionBlocker()
+{
+    m_blocked_description->file().block_condition().remove_blocker(*this);
+}
+
+bool Thread::FileDescriptionBlocker::is_event_driven() const
+{
+    return m_blocked_description->file().signals_readiness_changes();
 }
 
 const FileDescription& Thread::FileDescriptionBlocker::blocked_description() const
@@ -149,6 +272,7 @@ Thread::WriteBlocker::WriteBlocker(const FileDescription& description)
             deadline.tv_sec += (socket.send_timeout().tv_usec / 1000000) * 1;
             deadline.tv_usec %= 1000000;
             m_deadline = deadline;
+            set_timeout(uptime_for_deadline(deadline));
         }
     }
 }
@@ -156,7 +280,7 @@ Thread::WriteBlocker::WriteBlocker(const FileDescription& description)
 bool Thread::WriteBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
 {
     if (m_deadline.has_value()) {
-        bool timed_out = now_sec > m_deadline.value().tv_sec || (now_sec == m_deadline.value().tv_sec && now_usec >= m_deadline.value().tv_usec);
+        bool timed_out = has_timed_out() || is_deadline_reached(m_deadline.value(), now_sec, now_usec);
         return timed_out || blocked_description().can_write();
     }
     return blocked_description().can_write();
@@ -174,6 +298,7 @@ Thread::ReadBlocker::ReadBlocker(const FileDescription& description)
             deadline.tv_sec += (socket.receive_timeout().tv_usec / 1000000) * 1;
             deadline.tv_usec %= 1000000;
             m_deadline = deadline;
+            set_timeout(uptime_for_deadline(deadline));
         }
     }
 }
@@ -181,7 +306,25 @@ Thread::ReadBlocker::ReadBlocker(const FileDescription& description)
 bool Thread::ReadBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
 {
     if (m_deadline.has_value()) {
-        bool timed_out = now_sec > m_deadline.value().tv_sec || (now_sec == m_deadline.value().tv_sec && now_usec >= m_deadline.value().tv_usec);
+        bool timed_out = has_timed_out() || is_deadline_reached(m_deadline.value(), now_sec, now_usec);
+        return timed_out || blocked_description().can_read();
+    }
+    return blocked_description().can_read();
+}
+
+Thread::EPollBlocker::EPollBlocker(const FileDescription& epoll_description, const timeval& deadline, bool has_timeout)
+    : FileDescriptionBlocker(epoll_description)
+{
+    if (has_timeout) {
+        m_deadline = deadline;
+        set_timeout(uptime_for_deadline(deadline));
+    }
+}
+
+bool Thread::EPollBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
+{
+    if (m_deadline.has_value()) {
+        bool timed_out = has_timed_out() || is_deadline_reached(m_deadline.value(), now_sec, now_usec);
         return timed_out || blocked_description().can_read();
     }
     return blocked_description().can_read();
@@ -202,6 +345,7 @@ bool Thread::ConditionBlocker::should_unblock(Thread&, time_t, long)
 Thread::SleepBlocker::SleepBlocker(u64 wakeup_time)
     : m_wakeup_time(wakeup_time)
 {
+    set_timeout(m_wakeup_time);
 }
 
 bool Thread::SleepBlocker::should_unblock(Thread&, time_t, long)
@@ -216,12 +360,35 @@ Thread::SelectBlocker::SelectBlocker(const timeval& tv, bool select_has_timeout,
     , m_select_write_fds(write_fds)
     , m_select_exceptional_fds(except_fds)
 {
+    auto& process = Thread::current->process();
+    auto register_fds = [&](const FDVector& fds) {
+        for (int fd : fds) {
+            if (!process.m_fds[fd])
+                continue;
+            auto& description = *process.m_fds[fd].description;
+            description.file().block_condition().add_blocker(*this);
+            if (!description.file().signals_readiness_changes())
+                m_is_event_driven = false;
+            m_registered_descriptions.append(description);
+        }
+    };
+    register_fds(m_select_read_fds);
+    register_fds(m_select_write_fds);
+
+    if (m_select_has_timeout)
+        set_timeout(uptime_for_deadline(m_select_timeout));
+}
+
+Thread::SelectBlocker::~SelectBlocker()
+{
+    for (auto& description : m_registered_descriptions)
+        description->file().block_condition().remove_blocker(*this);
 }
 
 bool Thread::SelectBlocker::should_unblock(Thread& thread, time_t now_sec, long now_usec)
 {
     if (m_select_has_timeout) {
-        if (now_sec > m_select_timeout.tv_sec || (now_sec == m_select_timeout.tv_sec && now_usec >= m_select_timeout.tv_usec))
+        if (has_timed_out() || is_deadline_reached(m_select_timeout, now_sec, now_usec))
             return true;
     }
 
@@ -243,9 +410,16 @@ bool Thread::SelectBlocker::should_unblock(Thread& thread, time_t now_sec, long
 }
 
 Thread::WaitBlocker::WaitBlocker(int wait_options, pid_t& waitee_pid)
-    : m_wait_options(wait_options)
+    : m_process(Thread::current->process())
+    , m_wait_options(wait_options)
     , m_waitee_pid(waitee_pid)
 {
+    m_process.wait_block_condition().add_blocker(*this);
+}
+
+Thread::WaitBlocker::~WaitBlocker()
+{
+    m_process.wait_block_condition().remove_blocker(*this);
 }
 
 bool Thread::WaitBlocker::should_unblock(Thread& thread, time_t, long)
@@ -308,8 +482,14 @@ void Thread::consider_unblock(time_t now_sec, long now_usec)
         return;
     case Thread::Blocked:
         ASSERT(m_blocker != nullptr);
-        if (m_blocker->should_unblock(*this, now_sec, now_usec))
+        if (m_blocker->should_unblock(*this, now_sec, now_usec)) {
             unblock();
+            return;
+        }
+        // Event-driven blockers go back to waiting until they're notified again.
+        m_blocker->did_evaluate();
+        if (!m_blocker->needs_polling())
+            Scheduler::update_state_for_thread(*this);
         return;
     case Thread::Skip1SchedulerPass:
         set_state(Thread::Skip0SchedulerPasses);
@@ -340,56 +520,49 @@ bool Scheduler::pick_next()
     auto now_sec = now.tv_sec;
     auto now_usec = now.tv_usec;
 
-    // Check and unblock threads whose wait conditions have been met.
-    Scheduler::for_each_nonrunnable([&](Thread& thread) {
-        thread.consider_unblock(now_sec, now_usec);
-        return IterationDecision::Continue;
-    });
+    auto& data = *g_scheduler_data;
+    ++data.m_scheduling_passes;
 
-    Process::for_each([&](Process& process) {
-        if (process.is_dead()) {
-            if (Process::current->pid() != process.pid() && (!process.ppid() || !Process::from_pid(process.ppid()))) {
-                auto name = process.name();
-                auto pid = process.pid();
-                auto exit_status = Process::reap(process);
-                dbg() << "Scheduler: Reaped unparented process " << name << "(" << pid << "), exit status: " << exit_status.si_status;
-            }
-            return IterationDecision::Continue;
-        }
-        if (process.m_alarm_deadline && g_uptime > process.m_alarm_deadline) {
-            process.m_alarm_deadline = 0;
-            process.send_signal(SIGALRM, nullptr);
-        }
-        return IterationDecision::Continue;
-    });
+    // Check and unblock threads whose wait conditions may have been met.
+    // Threads whose blockers haven't been notified since they were last evaluated aren't on this list.
+    for (auto it = data.m_polled_threads.begin(); it != data.m_polled_threads.end();) {
+        auto& thread = *it;
+        ++it;
+        thread.consider_unblock(now_sec, now_usec);
+    }
 
     // Dispatch any pending signals.
-    Thread::for_each_living([](Thread& thread) -> IterationDecision {
+    for (auto it = data.m_threads_with_pending_signals.begin(); it != data.m_threads_with_pending_signals.end();) {
+        auto& thread = *it;
+        ++it;
+        if (!thread.m_pending_signals || thread.state() == Thread::Dead || thread.state() == Thread::Dying) {
+            data.m_threads_with_pending_signals.remove(thread);
+            continue;
+        }
         if (!thread.has_unmasked_pending_signals())
-            return IterationDecision::Continue;
+            continue;
         // FIXME: It would be nice if the Scheduler didn't have to worry about who is "current"
         //        For now, avoid dispatching signals to "current" and do it in a scheduling pass
         //        while some other process is interrupted. Otherwise a mess will be made.
         if (&thread == Thread::current)
-            return IterationDecision::Continue;
+            continue;
         // We know how to interrupt blocked processes, but if they are just executing
         // at some random point in the kernel, let them continue.
         // Before returning to userspace from a syscall, we will block a thread if it has any
         // pending unmasked signals, allowing it to be dispatched then.
         if (thread.in_kernel() && !thread.is_blocked() && !thread.is_stopped())
-            return IterationDecision::Continue;
+            continue;
         // NOTE: dispatch_one_pending_signal() may unblock the process.
         bool was_blocked = thread.is_blocked();
         if (thread.dispatch_one_pending_signal() == ShouldUnblockThread::No)
-            return IterationDecision::Continue;
+            continue;
         if (was_blocked) {
             dbg() << "Unblock " << thread << " due to signal";
             ASSERT(thread.m_blocker != nullptr);
             thread.m_blocker->set_interrupted_by_signal();
             thread.unblock();
         }
-        return IterationDecision::Continue;
-    });
+    }
 
 #ifdef SCHEDULER_RUNNABLE_DEBUG
     dbg() << "Non-runnables:";
@@ -405,34 +578,39 @@ bool Scheduler::pick_next()
     });
 #endif
 
-    Vector<Thread*, 128> sorted_runnables;
-    for_each_runnable([&sorted_runnables](auto& thread) {
-        sorted_runnables.append(&thread);
-        return IterationDecision::Continue;
-    });
-    quick_sort(sorted_runnables, [](auto& a, auto& b) { return a->effective_priority() >= b->effective_priority(); });
-
+    // A runnable thread's effective priority is its run queue's priority plus the number of
+    // scheduling passes it has been waiting for. Threads are appended to their run queue when
+    // they become runnable or get scheduled, so the first eligible thread of a queue is the one
+    // that has waited the longest, and only the head of each non-empty queue has to be looked at.
     Thread* thread_to_schedule = nullptr;
+    u64 best_effective_priority = 0;
+    data.for_each_nonempty_run_queue([&](u32 priority) {
+        for (auto& thread : data.m_run_queues[priority]) {
+            if (thread.process().is_being_inspected())
+                continue;
 
-    for (auto* thread : sorted_runnables) {
-        if (thread->process().is_being_inspected())
-            continue;
-
-        if (thread->process().exec_tid() && thread->process().exec_tid() != thread->tid())
-            continue;
+            if (thread.process().exec_tid() && thread.process().exec_tid() != thread.tid())
+                continue;
 
-        ASSERT(thread->state() == Thread::Runnable || thread->state() == Thread::Running);
+            ASSERT(thread.state() == Thread::Runnable || thread.state() == Thread::Running);
 
-        if (!thread_to_schedule) {
-            thread->m_extra_priority = 0;
-            thread_to_schedule = thread;
-        } else {
-            thread->m_extra_priority++;
+            u64 effective_priority = priority + (data.m_scheduling_passes - thread.m_run_queue_enqueue_pass);
+            if (!thread_to_schedule || effective_priority > best_effective_priority) {
+                thread_to_schedule = &thread;
+                best_effective_priority = effective_priority;
+            }
+            break;
         }
-    }
+        return IterationDecision::Continue;
+    });
 
-    if (!thread_to_schedule)
+    if (thread_to_schedule) {
+        // Move the chosen thread to the back of its queue, which also resets its waiting time.
+        data.dequeue_runnable(*thread_to_schedule);
+        data.enqueue_runnable(*thread_to_schedule);
+    } else {
         thread_to_schedule = g_colonel;
+    }
 
 #ifdef SCHEDULER_DEBUG
     dbg() << "Scheduler: Switch to " << *thread_to_schedule << " @ " << String::format("%04x:%08x", thread_to_schedule->tss().cs, thread_to_schedule->tss().eip);
@@ -73,9 +73,11 @@ public:
 
     static void init_thread(Thread& thread);
     static void update_state_for_thread(Thread& thread);
+    static void update_priority_for_thread(Thread& thread);
 
 private:
     static void prepare_for_iret_to_new_process();
+    static bool thread_needs_polling(const Thread&);
 };
 
 }
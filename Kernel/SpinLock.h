@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Types.h>
+#include <Kernel/Arch/i386/CPU.h>
+
+namespace Kernel {
+
+// A SpinLock provides mutual exclusion between CPUs, for short critical sections
+// that must not sleep. Taking it also disables interrupts on the current CPU, so
+// it can be shared with interrupt handlers. It is not recursive.
+template<typename BaseType = u32>
+class SpinLock {
+public:
+    SpinLock() = default;
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+
+    [[gnu::always_inline]] inline u32 lock()
+    {
+        u32 prev_flags = cpu_flags();
+        cli();
+        while (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
+            while (m_lock.load(AK::memory_order_relaxed) != 0)
+                asm volatile("pause");
+        }
+        return prev_flags;
+    }
+
+    [[gnu::always_inline]] inline void unlock(u32 prev_flags)
+    {
+        ASSERT(is_locked());
+        m_lock.store(0, AK::memory_order_release);
+        if (prev_flags & 0x200)
+            sti();
+        else
+            cli();
+    }
+
+    [[gnu::always_inline]] inline bool is_locked() const
+    {
+        return m_lock.load(AK::memory_order_relaxed) != 0;
+    }
+
+private:
+    AK::Atomic<BaseType> m_lock { 0 };
+};
+
+template<typename LockType>
+class ScopedSpinLock {
+public:
+    ScopedSpinLock() = delete;
+    ScopedSpinLock(const ScopedSpinLock&) = delete;
+    ScopedSpinLock& operator=(const ScopedSpinLock&) = delete;
+
+    [[gnu::always_inline]] inline explicit ScopedSpinLock(LockType& lock)
+        : m_lock(lock)
+    {
+        m_prev_flags = m_lock.lock();
+        m_have_lock = true;
+    }
+
+    [[gnu::always_inline]] inline ~ScopedSpinLock()
+    {
+        if (m_have_lock)
+            m_lock.unlock(m_prev_flags);
+    }
+
+    [[gnu::always_inline]] inline void lock()
+    {
+        ASSERT(!m_have_lock);
+        m_prev_flags = m_lock.lock();
+        m_have_lock = true;
+    }
+
+    [[gnu::always_inline]] inline void unlock()
+    {
+        ASSERT(m_have_lock);
+        m_lock.unlock(m_prev_flags);
+        m_have_lock = false;
+    }
+
+    [[gnu::always_inline]] inline bool have_lock() const { return m_have_lock; }
+
+private:
+    LockType& m_lock;
+    u32 m_prev_flags { 0 };
+    bool m_have_lock { false };
+};
+
+}
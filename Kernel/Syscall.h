@@ -38,6 +38,7 @@ extern "C" {
 struct timeval;
 struct timespec;
 struct sockaddr;
+struct epoll_event;
 struct siginfo;
 typedef u32 socklen_t;
 }
@@ -182,7 +183,11 @@ namespace Kernel {
     __ENUMERATE_SYSCALL(perf_event)           \
     __ENUMERATE_SYSCALL(shutdown)             \
     __ENUMERATE_SYSCALL(get_stack_bounds)     \
-    __ENUMERATE_SYSCALL(ptrace)
+    __ENUMERATE_SYSCALL(ptrace)               \
+    __ENUMERATE_SYSCALL(epoll_create)         \
+    __ENUMERATE_SYSCALL(epoll_ctl)            \
+    __ENUMERATE_SYSCALL(epoll_wait)           \
+    __ENUMERATE_SYSCALL(sendfile)
 
 namespace Syscall {
 
@@ -431,6 +436,27 @@ struct SC_ptrace_params {
     int data;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    const struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    int timeout;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    int32_t* offset; // FIXME: 64-bit off_t?
+    size_t count;
+};
+
 void initialize();
 int sync();
 
@@ -44,6 +44,12 @@ MasterPTY::MasterPTY(unsigned index)
     m_pts_name = String::format("/dev/pts/%u", m_index);
     set_uid(Process::current->uid());
     set_gid(Process::current->gid());
+
+    m_buffer.set_unblock_callback([this] {
+        evaluate_block_conditions();
+        if (m_slave)
+            m_slave->evaluate_block_conditions();
+    });
 }
 
 MasterPTY::~MasterPTY()
@@ -95,6 +101,7 @@ void MasterPTY::notify_slave_closed(Badge<SlavePTY>)
     // +1 ref for FileDescription::m_device
     if (m_slave->ref_count() == 2)
         m_slave = nullptr;
+    evaluate_block_conditions();
 }
 
 ssize_t MasterPTY::on_slave_write(const u8* data, ssize_t size)
@@ -121,6 +128,7 @@ void MasterPTY::close()
         m_closed = true;
 
         m_slave->hang_up();
+        m_slave->evaluate_block_conditions();
     }
 }
 
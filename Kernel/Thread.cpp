@@ -304,6 +304,7 @@ void Thread::finalize()
         static_cast<JoinBlocker*>(m_joiner->m_blocker)->set_joinee_exit_value(m_exit_value);
         static_cast<JoinBlocker*>(m_joiner->m_blocker)->set_interrupted_by_death();
         m_joiner->m_joinee = nullptr;
+        m_joiner->m_blocker->notify();
         // NOTE: We clear the joiner pointer here as well, to be tidy.
         m_joiner = nullptr;
     }
@@ -363,6 +364,8 @@ void Thread::send_signal(u8 signal, [[maybe_unused]] Process* sender)
 #endif
 
     m_pending_signals |= 1 << (signal - 1);
+    if (!g_scheduler_data->m_threads_with_pending_signals.contains(*this))
+        g_scheduler_data->m_threads_with_pending_signals.append(*this);
 }
 
 // Certain exceptions, such as SIGSEGV and SIGILL, put a
@@ -746,6 +749,20 @@ bool Thread::is_thread(void* ptr)
     return thread_table().contains((Thread*)ptr);
 }
 
+void Thread::set_priority(u32 priority)
+{
+    InterruptDisabler disabler;
+    m_priority = priority;
+    Scheduler::update_priority_for_thread(*this);
+}
+
+void Thread::set_priority_boost(u32 boost)
+{
+    InterruptDisabler disabler;
+    m_priority_boost = boost;
+    Scheduler::update_priority_for_thread(*this);
+}
+
 void Thread::set_state(State new_state)
 {
     InterruptDisabler disabler;
@@ -757,11 +774,18 @@ void Thread::set_state(State new_state)
         ASSERT(m_blocker != nullptr);
     }
 
+    auto previous_state = m_state;
     m_state = new_state;
     if (m_process.pid() != 0) {
         Scheduler::update_state_for_thread(*this);
     }
 
+    if (new_state == Stopped || previous_state == Stopped) {
+        // Let the parent's waitpid() know we have stopped or continued.
+        if (auto* parent = Process::from_pid(m_process.ppid()))
+            parent->wait_block_condition().notify_all();
+    }
+
     if (new_state == Dying) {
         g_finalizer_has_work = true;
         g_finalizer_wait_queue->wake_all();
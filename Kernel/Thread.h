@@ -62,6 +62,8 @@ struct ThreadSpecificData {
 #define THREAD_PRIORITY_HIGH 50
 #define THREAD_PRIORITY_MAX 99
 
+#define THREAD_PRIORITY_BOOST_MAX 20
+
 class Thread {
     friend class Process;
     friend class Scheduler;
@@ -82,12 +84,15 @@ public:
     int tid() const { return m_tid; }
     int pid() const;
 
-    void set_priority(u32 p) { m_priority = p; }
+    void set_priority(u32 p);
     u32 priority() const { return m_priority; }
 
-    void set_priority_boost(u32 boost) { m_priority_boost = boost; }
+    void set_priority_boost(u32 boost);
     u32 priority_boost() const { return m_priority_boost; }
 
+    // The priority of the thread's run queue, i.e its priority including boosts.
+    u32 base_priority() const;
+    // The base priority plus the number of scheduling passes this thread has been passed over.
     u32 effective_priority() const;
 
     void set_joinable(bool j) { m_is_joinable = j; }
@@ -119,25 +124,55 @@ public:
 
     class Blocker {
     public:
-        virtual ~Blocker() {}
+        Blocker();
+        virtual ~Blocker();
         virtual bool should_unblock(Thread&, time_t now_s, long us) = 0;
         virtual const char* state_string() const = 0;
         virtual bool is_reason_signal() const { return false; }
+        // Event-driven blockers are only re-evaluated by the scheduler after they have been notified,
+        // either by a BlockCondition they're registered with or by their timeout. Other blockers are polled.
+        virtual bool is_event_driven() const { return false; }
+        bool needs_polling() const { return !is_event_driven() || m_was_notified; }
+        void notify();
+        void did_evaluate() { m_was_notified = false; }
         void set_interrupted_by_death() { m_was_interrupted_by_death = true; }
         bool was_interrupted_by_death() const { return m_was_interrupted_by_death; }
         void set_interrupted_by_signal() { m_was_interrupted_while_blocked = true; }
         bool was_interrupted_by_signal() const { return m_was_interrupted_while_blocked; }
 
+    protected:
+        // Notifies this blocker once g_uptime reaches wakeup_time.
+        void set_timeout(u64 wakeup_time);
+        bool has_timed_out() const { return m_timed_out; }
+
     private:
+        Thread& m_thread;
+        u64 m_timeout_timer_id { 0 };
+        bool m_timed_out { false };
+        // Evaluate every blocker at least once, in case its condition was met before it got registered.
+        bool m_was_notified { true };
         bool m_was_interrupted_while_blocked { false };
         bool m_was_interrupted_by_death { false };
         friend class Thread;
     };
 
+    // Something event-driven blockers can wait on, e.g a File becoming readable.
+    class BlockCondition {
+    public:
+        void add_blocker(Blocker&);
+        void remove_blocker(Blocker&);
+        // Asks the scheduler to re-evaluate every blocker waiting on this condition.
+        void notify_all();
+
+    private:
+        Vector<Blocker*, 2> m_blockers;
+    };
+
     class JoinBlocker final : public Blocker {
     public:
         explicit JoinBlocker(Thread& joinee, void*& joinee_exit_value);
         virtual bool should_unblock(Thread&, time_t now_s, long us) override;
+        virtual bool is_event_driven() const override { return true; }
         virtual const char* state_string() const override { return "Joining"; }
         void set_joinee_exit_value(void* value) { m_joinee_exit_value = value; }
 
@@ -148,7 +183,9 @@ public:
 
     class FileDescriptionBlocker : public Blocker {
     public:
+        virtual ~FileDescriptionBlocker() override;
         const FileDescription& blocked_description() const;
+        virtual bool is_event_driven() const override;
 
     protected:
         explicit FileDescriptionBlocker(const FileDescription&);
@@ -191,6 +228,16 @@ public:
         Optional<timeval> m_deadline;
     };
 
+    class EPollBlocker final : public FileDescriptionBlocker {
+    public:
+        EPollBlocker(const FileDescription& epoll_description, const timeval& deadline, bool has_timeout);
+        virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual const char* state_string() const override { return "EPolling"; }
+
+    private:
+        Optional<timeval> m_deadline;
+    };
+
     class ConditionBlocker final : public Blocker {
     public:
         ConditionBlocker(const char* state_string, Function<bool()>&& condition);
@@ -206,6 +253,7 @@ public:
     public:
         explicit SleepBlocker(u64 wakeup_time);
         virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual bool is_event_driven() const override { return true; }
         virtual const char* state_string() const override { return "Sleeping"; }
 
     private:
@@ -214,12 +262,18 @@ public:
 
     class SelectBlocker final : public Blocker {
     public:
-        typedef Vector<int, FD_SETSIZE> FDVector;
+        // Room for a full fd_set, so select() never has to allocate.
+        static constexpr size_t fd_vector_inline_capacity = FD_SETSIZE;
+        typedef Vector<int, fd_vector_inline_capacity> FDVector;
         SelectBlocker(const timeval& tv, bool select_has_timeout, const FDVector& read_fds, const FDVector& write_fds, const FDVector& except_fds);
+        virtual ~SelectBlocker() override;
         virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual bool is_event_driven() const override { return m_is_event_driven; }
         virtual const char* state_string() const override { return "Selecting"; }
 
     private:
+        Vector<NonnullRefPtr<FileDescription>> m_registered_descriptions;
+        bool m_is_event_driven { true };
         timeval m_select_timeout;
         bool m_select_has_timeout { false };
         const FDVector& m_select_read_fds;
@@ -230,10 +284,13 @@ public:
     class WaitBlocker final : public Blocker {
     public:
         WaitBlocker(int wait_options, pid_t& waitee_pid);
+        virtual ~WaitBlocker() override;
         virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual bool is_event_driven() const override { return true; }
         virtual const char* state_string() const override { return "Waiting"; }
 
     private:
+        Process& m_process;
         int m_wait_options { 0 };
         pid_t& m_waitee_pid;
     };
@@ -246,6 +303,7 @@ public:
 
         SemiPermanentBlocker(Reason reason);
         virtual bool should_unblock(Thread&, time_t, long) override;
+        virtual bool is_event_driven() const override { return true; }
         virtual const char* state_string() const override
         {
             switch (m_reason) {
@@ -442,9 +500,10 @@ public:
 private:
     IntrusiveListNode m_runnable_list_node;
     IntrusiveListNode m_wait_queue_node;
+    IntrusiveListNode m_pending_signals_list_node;
 
 private:
-    friend class SchedulerData;
+    friend struct SchedulerData;
     friend class WaitQueue;
     bool unlock_process_if_locked();
     void relock_process();
@@ -490,8 +549,9 @@ private:
     State m_state { Invalid };
     String m_name;
     u32 m_priority { THREAD_PRIORITY_NORMAL };
-    u32 m_extra_priority { 0 };
     u32 m_priority_boost { 0 };
+    u32 m_run_queue_priority { 0 };
+    u64 m_run_queue_enqueue_pass { 0 };
 
     u8 m_stop_signal { 0 };
     State m_stop_state { Invalid };
@@ -545,15 +605,72 @@ const LogStream& operator<<(const LogStream&, const Thread&);
 
 struct SchedulerData {
     typedef IntrusiveList<Thread, &Thread::m_runnable_list_node> ThreadList;
+    typedef IntrusiveList<Thread, &Thread::m_pending_signals_list_node> PendingSignalsThreadList;
+
+    // One run queue per base priority, so picking the next thread doesn't depend on the number of runnable threads.
+    static constexpr u32 run_queue_count = THREAD_PRIORITY_MAX + 2 * THREAD_PRIORITY_BOOST_MAX + 1;
+    static constexpr u32 run_queue_bitmap_words = (run_queue_count + 31) / 32;
+
+    ThreadList m_run_queues[run_queue_count];
+    u32 m_nonempty_run_queues[run_queue_bitmap_words] {};
+
+    // Non-runnable threads whose state must be re-evaluated on every scheduling pass.
+    ThreadList m_polled_threads;
+    // Non-runnable threads that will be woken up by someone else (a WaitQueue, a timer, a signal...)
+    ThreadList m_waiting_threads;
+
+    PendingSignalsThreadList m_threads_with_pending_signals;
+
+    u64 m_scheduling_passes { 0 };
+
+    bool is_run_queue_empty(u32 priority) const
+    {
+        return !(m_nonempty_run_queues[priority / 32] & (1u << (priority % 32)));
+    }
+
+    void set_run_queue_empty(u32 priority, bool empty)
+    {
+        if (empty)
+            m_nonempty_run_queues[priority / 32] &= ~(1u << (priority % 32));
+        else
+            m_nonempty_run_queues[priority / 32] |= 1u << (priority % 32);
+    }
+
+    bool is_in_run_queue(const Thread& thread) const
+    {
+        return m_run_queues[thread.m_run_queue_priority].contains(thread);
+    }
+
+    void enqueue_runnable(Thread& thread)
+    {
+        thread.m_run_queue_priority = min(thread.base_priority(), run_queue_count - 1);
+        thread.m_run_queue_enqueue_pass = m_scheduling_passes;
+        m_run_queues[thread.m_run_queue_priority].append(thread);
+        set_run_queue_empty(thread.m_run_queue_priority, false);
+    }
 
-    ThreadList m_runnable_threads;
-    ThreadList m_nonrunnable_threads;
+    void dequeue_runnable(Thread& thread)
+    {
+        auto& queue = m_run_queues[thread.m_run_queue_priority];
+        queue.remove(thread);
+        if (queue.is_empty())
+            set_run_queue_empty(thread.m_run_queue_priority, true);
+    }
 
-    ThreadList& thread_list_for_state(Thread::State state)
+    // Calls the callback with the priority of every non-empty run queue, highest priority first.
+    template<typename Callback>
+    IterationDecision for_each_nonempty_run_queue(Callback callback)
     {
-        if (Thread::is_runnable_state(state))
-            return m_runnable_threads;
-        return m_nonrunnable_threads;
+        for (int word_index = run_queue_bitmap_words - 1; word_index >= 0; --word_index) {
+            u32 word = m_nonempty_run_queues[word_index];
+            while (word) {
+                u32 bit = 31 - __builtin_clz(word);
+                word &= ~(1u << bit);
+                if (callback(word_index * 32 + bit) == IterationDecision::Break)
+                    return IterationDecision::Break;
+            }
+        }
+        return IterationDecision::Continue;
     }
 };
 
@@ -561,30 +678,34 @@ template<typename Callback>
 inline IterationDecision Scheduler::for_each_runnable(Callback callback)
 {
     ASSERT_INTERRUPTS_DISABLED();
-    auto& tl = g_scheduler_data->m_runnable_threads;
-    for (auto it = tl.begin(); it != tl.end();) {
-        auto& thread = *it;
-        it = ++it;
-        if (callback(thread) == IterationDecision::Break)
-            return IterationDecision::Break;
-    }
-
-    return IterationDecision::Continue;
+    return g_scheduler_data->for_each_nonempty_run_queue([&](u32 priority) {
+        auto& tl = g_scheduler_data->m_run_queues[priority];
+        for (auto it = tl.begin(); it != tl.end();) {
+            auto& thread = *it;
+            it = ++it;
+            if (callback(thread) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
 }
 
 template<typename Callback>
 inline IterationDecision Scheduler::for_each_nonrunnable(Callback callback)
 {
     ASSERT_INTERRUPTS_DISABLED();
-    auto& tl = g_scheduler_data->m_nonrunnable_threads;
-    for (auto it = tl.begin(); it != tl.end();) {
-        auto& thread = *it;
-        it = ++it;
-        if (callback(thread) == IterationDecision::Break)
-            return IterationDecision::Break;
-    }
-
-    return IterationDecision::Continue;
+    auto for_each_in_list = [&](auto& tl) {
+        for (auto it = tl.begin(); it != tl.end();) {
+            auto& thread = *it;
+            it = ++it;
+            if (callback(thread) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    };
+    if (for_each_in_list(g_scheduler_data->m_polled_threads) == IterationDecision::Break)
+        return IterationDecision::Break;
+    return for_each_in_list(g_scheduler_data->m_waiting_threads);
 }
 
 u16 thread_specific_selector();
@@ -83,7 +83,7 @@ void TimerQueue::fire()
 
     ASSERT(m_next_timer_due == m_timer_queue.first()->expires);
 
-    while (!m_timer_queue.is_empty() && g_uptime > m_timer_queue.first()->expires) {
+    while (!m_timer_queue.is_empty() && g_uptime >= m_timer_queue.first()->expires) {
         auto timer = m_timer_queue.take_first();
         timer->callback();
     }
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/Bitmap.h>
+#include <Kernel/FileSystem/ReadAheadWindow.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/VM/VMObject.h>
 
@@ -50,6 +51,8 @@ public:
     u32 writable_mappings() const;
     u32 executable_mappings() const;
 
+    ReadAheadWindow& read_ahead_window() { return m_read_ahead_window; }
+
 protected:
     explicit InodeVMObject(Inode&, size_t);
     explicit InodeVMObject(const InodeVMObject&);
@@ -64,6 +67,7 @@ protected:
 
     NonnullRefPtr<Inode> m_inode;
     Bitmap m_dirty_pages;
+    ReadAheadWindow m_read_ahead_window;
 };
 
 }
@@ -117,6 +117,39 @@ void MemoryManager::setup_low_identity_mapping()
     }
 }
 
+void MemoryManager::map_ap_startup_page(PhysicalAddress paddr)
+{
+    ASSERT(paddr.get() < 1 * MB);
+    ASSERT(paddr.offset_in_page() == 0);
+    InterruptDisabler disabler;
+
+    // The execute-disable bit on the PDE covers the whole low 2 MB, so lift it while APs start up.
+    auto& pde_zero = quickmap_pd(kernel_page_directory(), 0)[0];
+    pde_zero.set_execute_disabled(false);
+
+    auto& pte = quickmap_pt(m_low_page_table->paddr())[paddr.get() / PAGE_SIZE];
+    pte.set_physical_page_base(paddr.get());
+    pte.set_user_allowed(false);
+    pte.set_writable(false);
+    pte.set_present(true);
+    flush_tlb(VirtualAddress(paddr.get()));
+}
+
+void MemoryManager::unmap_ap_startup_page(PhysicalAddress paddr)
+{
+    ASSERT(paddr.get() < 1 * MB);
+    InterruptDisabler disabler;
+
+    auto& pte = quickmap_pt(m_low_page_table->paddr())[paddr.get() / PAGE_SIZE];
+    pte.clear();
+
+    if (g_cpu_supports_nx) {
+        auto& pde_zero = quickmap_pd(kernel_page_directory(), 0)[0];
+        pde_zero.set_execute_disabled(true);
+    }
+    flush_entire_tlb();
+}
+
 void MemoryManager::parse_memory_map()
 {
     RefPtr<PhysicalRegion> region;
@@ -332,6 +365,22 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region(size_t size, const StringVi
     return region;
 }
 
+OwnPtr<Region> MemoryManager::allocate_aligned_kernel_region(size_t size, size_t alignment, const StringView& name, u8 access)
+{
+    ASSERT(!(size % PAGE_SIZE));
+    ASSERT(!(alignment % PAGE_SIZE));
+    auto range = kernel_page_directory().range_allocator().allocate_anywhere(size, alignment);
+    if (!range.is_valid())
+        return nullptr;
+    auto vmobject = AnonymousVMObject::create_with_size(size);
+    auto region = allocate_kernel_region_with_vmobject(range, vmobject, name, access, false, true);
+    if (!region)
+        return nullptr;
+    if (!region->commit())
+        return nullptr;
+    return region;
+}
+
 OwnPtr<Region> MemoryManager::allocate_kernel_region(PhysicalAddress paddr, size_t size, const StringView& name, u8 access, bool user_accessible, bool cacheable)
 {
     ASSERT(!(size % PAGE_SIZE));
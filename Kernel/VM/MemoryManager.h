@@ -106,6 +106,7 @@ public:
 
     OwnPtr<Region> allocate_contiguous_kernel_region(size_t, const StringView& name, u8 access, bool user_accessible = false, bool cacheable = true);
     OwnPtr<Region> allocate_kernel_region(size_t, const StringView& name, u8 access, bool user_accessible = false, bool should_commit = true, bool cacheable = true);
+    OwnPtr<Region> allocate_aligned_kernel_region(size_t, size_t alignment, const StringView& name, u8 access);
     OwnPtr<Region> allocate_kernel_region(PhysicalAddress, size_t, const StringView& name, u8 access, bool user_accessible = false, bool cacheable = true);
     OwnPtr<Region> allocate_kernel_region_with_vmobject(VMObject&, size_t, const StringView& name, u8 access, bool user_accessible = false, bool cacheable = true);
     OwnPtr<Region> allocate_kernel_region_with_vmobject(const Range&, VMObject&, const StringView& name, u8 access, bool user_accessible = false, bool cacheable = true);
@@ -116,6 +117,10 @@ public:
     unsigned super_physical_pages() const { return m_super_physical_pages; }
     unsigned super_physical_pages_used() const { return m_super_physical_pages_used; }
 
+    // Inode pages that were read ahead and mapped on a page fault, so never faulted in on their own.
+    u64 inode_faults_avoided() const { return m_inode_faults_avoided; }
+    void did_avoid_inode_faults(size_t count) { m_inode_faults_avoided += count; }
+
     template<typename Callback>
     static void for_each_vmobject(Callback callback)
     {
@@ -132,6 +137,11 @@ public:
 
     PhysicalPage& shared_zero_page() { return *m_shared_zero_page; }
 
+    // Identity maps a page below 1 MB, executable, in the kernel page directory. Application
+    // processors run their startup code from there while they turn on paging.
+    void map_ap_startup_page(PhysicalAddress);
+    void unmap_ap_startup_page(PhysicalAddress);
+
 private:
     MemoryManager();
     ~MemoryManager();
@@ -181,6 +191,7 @@ private:
     unsigned m_user_physical_pages_used { 0 };
     unsigned m_super_physical_pages { 0 };
     unsigned m_super_physical_pages_used { 0 };
+    u64 m_inode_faults_avoided { 0 };
 
     NonnullRefPtrVector<PhysicalRegion> m_user_physical_regions;
     NonnullRefPtrVector<PhysicalRegion> m_super_physical_regions;
@@ -27,6 +27,7 @@
 #include <AK/Memory.h>
 #include <AK/StringView.h>
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
 #include <Kernel/VM/AnonymousVMObject.h>
@@ -433,33 +434,80 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     if (Thread::current)
         Thread::current->did_inode_fault();
 
+    auto& inode = inode_vmobject.inode();
+    size_t page_index_in_vmobject = first_page_index() + page_index_in_region;
+
+    // If this inode is being faulted in sequentially, bring in the pages following
+    // this one as well, as far as they are in this region, not yet present, and within the file.
+    size_t read_ahead_pages = inode_vmobject.read_ahead_window().did_access(page_index_in_vmobject * PAGE_SIZE, PAGE_SIZE) / PAGE_SIZE;
+    size_t pages_in_file = ceil_div((size_t)inode.size(), (size_t)PAGE_SIZE);
+    size_t page_count = 1;
+    while (page_count <= read_ahead_pages
+        && page_index_in_region + page_count < this->page_count()
+        && page_index_in_vmobject + page_count < pages_in_file
+        && inode_vmobject.physical_pages()[page_index_in_vmobject + page_count].is_null())
+        ++page_count;
+    if (page_count - 1 < read_ahead_pages)
+        inode_vmobject.read_ahead_window().did_read_ahead((page_count - 1) * PAGE_SIZE);
+
 #ifdef MM_DEBUG
-    dbg() << "MM: page_in_from_inode ready to read from inode";
+    dbg() << "MM: page_in_from_inode ready to read " << page_count << " page(s) from inode";
 #endif
     sti();
     u8 page_buffer[PAGE_SIZE];
-    auto& inode = inode_vmobject.inode();
-    auto nread = inode.read_bytes((first_page_index() + page_index_in_region) * PAGE_SIZE, PAGE_SIZE, page_buffer, nullptr);
+    u8* buffer = page_buffer;
+    Optional<KBuffer> read_ahead_buffer;
+    if (page_count > 1) {
+        read_ahead_buffer = KBuffer::create_with_size(page_count * PAGE_SIZE);
+        buffer = read_ahead_buffer.value().data();
+    }
+    auto nread = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, page_count * PAGE_SIZE, buffer, nullptr);
     if (nread < 0) {
         klog() << "MM: handle_inode_fault had error (" << nread << ") while reading!";
         return PageFaultResponse::ShouldCrash;
     }
-    if (nread < PAGE_SIZE) {
-        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
-        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+    if ((size_t)nread < page_count * PAGE_SIZE) {
+        // If we read less than we asked for, zero out the rest to avoid leaking uninitialized data.
+        memset(buffer + nread, 0, page_count * PAGE_SIZE - nread);
     }
     cli();
+
+    auto release_read_ahead_buffer = [&] {
+        if (!read_ahead_buffer.has_value())
+            return;
+        // Freeing the buffer's kernel region takes locks, so do it with interrupts enabled.
+        sti();
+        read_ahead_buffer.clear();
+        cli();
+    };
+
     vmobject_physical_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
     if (vmobject_physical_page_entry.is_null()) {
         klog() << "MM: handle_inode_fault was unable to allocate a physical page";
+        release_read_ahead_buffer();
         return PageFaultResponse::ShouldCrash;
     }
 
     u8* dest_ptr = MM.quickmap_page(*vmobject_physical_page_entry);
-    memcpy(dest_ptr, page_buffer, PAGE_SIZE);
+    memcpy(dest_ptr, buffer, PAGE_SIZE);
     MM.unquickmap_page();
 
+    // Map the read-ahead pages right away so they don't fault on their own.
+    for (size_t i = 1; i < page_count; ++i) {
+        auto& read_ahead_page_entry = inode_vmobject.physical_pages()[page_index_in_vmobject + i];
+        ASSERT(read_ahead_page_entry.is_null());
+        read_ahead_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+        if (read_ahead_page_entry.is_null())
+            break;
+        dest_ptr = MM.quickmap_page(*read_ahead_page_entry);
+        memcpy(dest_ptr, buffer + i * PAGE_SIZE, PAGE_SIZE);
+        MM.unquickmap_page();
+        remap_page(page_index_in_region + i);
+        MM.did_avoid_inode_faults(1);
+    }
+
     remap_page(page_index_in_region);
+    release_read_ahead_buffer();
     return PageFaultResponse::Continue;
 }
 
@@ -28,6 +28,7 @@
 
 #include <AK/Atomic.h>
 #include <AK/SinglyLinkedList.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/Thread.h>
 
 namespace Kernel {
@@ -39,12 +40,13 @@ public:
 
     void enqueue(Thread&);
     void wake_one(Atomic<bool>* lock = nullptr);
-    void wake_all();
+    void wake_all(Atomic<bool>* lock = nullptr);
     void clear();
 
 private:
     typedef IntrusiveList<Thread, &Thread::m_wait_queue_node> ThreadList;
     ThreadList m_threads;
+    SpinLock<u32> m_lock;
 };
 
 }
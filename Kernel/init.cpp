@@ -35,6 +35,7 @@
 #include <Kernel/ACPI/DMIDecoder.h>
 #include <Kernel/ACPI/MultiProcessorParser.h>
 #include <Kernel/Arch/i386/CPU.h>
+#include <Kernel/Arch/i386/Processor.h>
 #include <Kernel/CMOS.h>
 #include <Kernel/Devices/BXVGADevice.h>
 #include <Kernel/Devices/DebugLogDevice.h>
@@ -104,11 +105,14 @@ extern "C" [[noreturn]] void init()
     new KParams(String(reinterpret_cast<const char*>(low_physical_to_virtual(multiboot_info_ptr->cmdline))));
 
     MemoryManager::initialize();
+    kmalloc_enable_expansion();
 
     bool text_debug = KParams::the().has("text_debug");
     gdt_init();
     idt_init();
 
+    Processor::initialize_bsp();
+
     setup_interrupts();
     setup_acpi();
 
@@ -190,6 +194,7 @@ extern "C" [[noreturn]] void init()
                 g_finalizer_has_work = false;
             }
             Thread::finalize_dying_threads();
+            Process::reap_unparented_dead_processes();
         }
     });
 
@@ -201,6 +206,13 @@ extern "C" [[noreturn]] void init()
     ASSERT_NOT_REACHED();
 }
 
+extern "C" [[noreturn]] void init_ap(u32 cpu)
+{
+    auto* processor = Processor::by_id(cpu);
+    ASSERT(processor);
+    processor->initialize_ap();
+}
+
 void init_stage2()
 {
     Syscall::initialize();
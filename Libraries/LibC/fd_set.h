@@ -27,10 +27,12 @@
 #pragma once
 
 #define FD_SETSIZE 64
+// Processes can have more fds open than an fd_set has room for, so crash rather than write past the end of it.
+#define __FD_INDEX(fd) ((unsigned)(fd) < FD_SETSIZE ? (fd) : (__builtin_trap(), 0))
 #define FD_ZERO(set) memset((set), 0, sizeof(fd_set));
-#define FD_CLR(fd, set) ((set)->bits[(fd / 8)] &= ~(1 << (fd) % 8))
-#define FD_SET(fd, set) ((set)->bits[(fd / 8)] |= (1 << (fd) % 8))
-#define FD_ISSET(fd, set) ((set)->bits[(fd / 8)] & (1 << (fd) % 8))
+#define FD_CLR(fd, set) ((set)->bits[__FD_INDEX(fd) / 8] &= ~(1 << (fd) % 8))
+#define FD_SET(fd, set) ((set)->bits[__FD_INDEX(fd) / 8] |= (1 << (fd) % 8))
+#define FD_ISSET(fd, set) ((set)->bits[__FD_INDEX(fd) / 8] & (1 << (fd) % 8))
 
 struct __fd_set {
     unsigned char bits[FD_SETSIZE / 8];
@@ -49,6 +49,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__serenity__) || defined(__linux__)
+#    define CEVENTLOOP_USE_EPOLL
+#    include <sys/epoll.h>
+#endif
+
 //#define CEVENTLOOP_DEBUG
 //#define DEFERRED_INVOKE_DEBUG
 
@@ -78,6 +83,70 @@ static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
 static HashTable<Notifier*>* s_notifiers;
 int EventLoop::s_wake_pipe_fds[2];
+
+#ifdef CEVENTLOOP_USE_EPOLL
+// All notifiers share one epoll instance, so waiting doesn't have to hand the whole fd set to the kernel every time.
+// Several notifiers may watch the same fd, so the interest registered for an fd is the union of their event masks.
+struct EPollRegistration {
+    Vector<Notifier*, 1> notifiers;
+    u32 registered_events { 0 };
+};
+static int s_epoll_fd = -1;
+static HashMap<int, EPollRegistration>* s_epoll_registrations;
+
+static u32 epoll_events_for(const Notifier& notifier)
+{
+    u32 events = 0;
+    if (notifier.event_mask() & Notifier::Read)
+        events |= EPOLLIN;
+    if (notifier.event_mask() & Notifier::Write)
+        events |= EPOLLOUT;
+    if (notifier.event_mask() & Notifier::Exceptional)
+        ASSERT_NOT_REACHED();
+    return events;
+}
+
+static void update_epoll_interest(int fd)
+{
+    auto it = s_epoll_registrations->find(fd);
+    if (it == s_epoll_registrations->end())
+        return;
+    auto& registration = it->value;
+
+    u32 events = 0;
+    for (auto* notifier : registration.notifiers)
+        events |= epoll_events_for(*notifier);
+
+    if (!events) {
+        // This fails if the fd has already been closed. The kernel drops the interest by itself once
+        // nothing refers to the file description anymore, and a reused fd number gets a fresh interest.
+        if (registration.registered_events)
+            epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        if (registration.notifiers.is_empty())
+            s_epoll_registrations->remove(it);
+        else
+            registration.registered_events = 0;
+        return;
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+    // If the fd was closed and reused behind our back, the kernel doesn't know the new file yet, so fall back to adding it.
+    int rc = epoll_ctl(s_epoll_fd, registration.registered_events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+    if (rc < 0 && errno == ENOENT)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    else if (rc < 0 && errno == EEXIST)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    if (rc < 0) {
+        perror("EventLoop: epoll_ctl");
+        registration.registered_events = 0;
+        return;
+    }
+    registration.registered_events = events;
+}
+#endif
 static RefPtr<LocalServer> s_rpc_server;
 HashMap<int, RefPtr<RPCClient>> s_rpc_clients;
 
@@ -218,6 +287,11 @@ EventLoop::EventLoop()
         s_event_loop_stack = new Vector<EventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef CEVENTLOOP_USE_EPOLL
+        s_epoll_registrations = new HashMap<int, EPollRegistration>;
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        ASSERT(s_epoll_fd >= 0);
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -231,6 +305,14 @@ EventLoop::EventLoop()
 
 #endif
         ASSERT(rc == 0);
+#ifdef CEVENTLOOP_USE_EPOLL
+        epoll_event wake_event;
+        memset(&wake_event, 0, sizeof(wake_event));
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &wake_event);
+        ASSERT(rc == 0);
+#endif
         s_event_loop_stack->append(this);
 
         auto rpc_path = String::format("/tmp/rpc.%d", getpid());
@@ -385,6 +467,7 @@ void EventLoop::post_event(Object& receiver, NonnullOwnPtr<Event>&& event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifndef CEVENTLOOP_USE_EPOLL
     fd_set rfds;
     fd_set wfds;
     FD_ZERO(&rfds);
@@ -408,6 +491,7 @@ void EventLoop::wait_for_event(WaitMode mode)
         if (notifier->event_mask() & Notifier::Exceptional)
             ASSERT_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -437,8 +521,7 @@ void EventLoop::wait_for_event(WaitMode mode)
         should_wait_forever = false;
     }
 
-    int marked_fd_count = Core::safe_syscall(select, max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+    auto drain_wake_pipe = [] {
         char buffer[32];
         auto nread = read(s_wake_pipe_fds[0], buffer, sizeof(buffer));
         if (nread < 0) {
@@ -446,7 +529,23 @@ void EventLoop::wait_for_event(WaitMode mode)
             ASSERT_NOT_REACHED();
         }
         ASSERT(nread > 0);
+    };
+
+#ifdef CEVENTLOOP_USE_EPOLL
+    static constexpr int max_events_per_wait = 64;
+    epoll_event ready_events[max_events_per_wait];
+    // Round up, so that we don't wake up just before the next timer is due.
+    int timeout_ms = should_wait_forever ? -1 : (int)(timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000);
+    int marked_fd_count = Core::safe_syscall(epoll_wait, s_epoll_fd, ready_events, max_events_per_wait, timeout_ms);
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (ready_events[i].data.fd == s_wake_pipe_fds[0])
+            drain_wake_pipe();
     }
+#else
+    int marked_fd_count = Core::safe_syscall(select, max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    if (FD_ISSET(s_wake_pipe_fds[0], &rfds))
+        drain_wake_pipe();
+#endif
 
     if (!s_timers->is_empty()) {
         timespec now_spec;
@@ -479,6 +578,20 @@ void EventLoop::wait_for_event(WaitMode mode)
     if (!marked_fd_count)
         return;
 
+#ifdef CEVENTLOOP_USE_EPOLL
+    for (int i = 0; i < marked_fd_count; ++i) {
+        int fd = ready_events[i].data.fd;
+        auto it = s_epoll_registrations->find(fd);
+        if (it == s_epoll_registrations->end())
+            continue;
+        for (auto* notifier : it->value.notifiers) {
+            if ((ready_events[i].events & EPOLLIN) && (notifier->event_mask() & Notifier::Read) && notifier->on_ready_to_read)
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if ((ready_events[i].events & EPOLLOUT) && (notifier->event_mask() & Notifier::Write) && notifier->on_ready_to_write)
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->on_ready_to_read)
@@ -489,6 +602,7 @@ void EventLoop::wait_for_event(WaitMode mode)
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -552,12 +666,36 @@ bool EventLoop::unregister_timer(int timer_id)
 
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
+    if (s_notifiers->contains(&notifier))
+        return;
     s_notifiers->set(&notifier);
+#ifdef CEVENTLOOP_USE_EPOLL
+    s_epoll_registrations->ensure(notifier.fd()).notifiers.append(&notifier);
+    update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
+    if (!s_notifiers->contains(&notifier))
+        return;
     s_notifiers->remove(&notifier);
+#ifdef CEVENTLOOP_USE_EPOLL
+    auto it = s_epoll_registrations->find(notifier.fd());
+    ASSERT(it != s_epoll_registrations->end());
+    it->value.notifiers.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    update_epoll_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, Notifier& notifier)
+{
+#ifdef CEVENTLOOP_USE_EPOLL
+    if (s_notifiers->contains(&notifier))
+        update_epoll_interest(notifier.fd());
+#else
+    UNUSED_PARAM(notifier);
+#endif
 }
 
 void EventLoop::wake()
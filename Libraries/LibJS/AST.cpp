@@ -28,6 +28,7 @@
 #include <AK/HashMap.h>
 #include <AK/StringBuilder.h>
 #include <LibJS/AST.h>
+#include <LibJS/Heap/MarkedValueList.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/Error.h>
@@ -76,7 +77,7 @@ CallExpression::ThisAndCallee CallExpression::compute_this_and_callee(Interprete
         auto* this_value = object_value.to_object(interpreter.heap());
         if (interpreter.exception())
             return {};
-        auto callee = this_value->get(member_expression.computed_property_name(interpreter)).value_or({});
+        auto callee = member_expression.get_property(interpreter, *this_value).value_or({});
         return { this_value, callee };
     }
     return { &interpreter.global_object(), m_callee->execute(interpreter) };
@@ -101,7 +102,7 @@ Value CallExpression::execute(Interpreter& interpreter) const
 
     auto& function = static_cast<Function&>(callee.as_object());
 
-    Vector<Value> arguments;
+    MarkedValueList arguments(interpreter.heap());
     arguments.ensure_capacity(m_arguments.size());
     for (size_t i = 0; i < m_arguments.size(); ++i) {
         auto value = m_arguments[i].execute(interpreter);
@@ -113,7 +114,7 @@ Value CallExpression::execute(Interpreter& interpreter) const
     }
 
     auto& call_frame = interpreter.push_call_frame();
-    call_frame.arguments = move(arguments);
+    call_frame.arguments = move(arguments.values());
 
     Object* new_object = nullptr;
     Value result;
@@ -177,14 +178,19 @@ Value WhileStatement::execute(Interpreter& interpreter) const
     return last_value;
 }
 
-Value ForStatement::execute(Interpreter& interpreter) const
+ForStatement::ForStatement(RefPtr<ASTNode> init, RefPtr<Expression> test, RefPtr<Expression> update, NonnullRefPtr<ScopeNode> body, RefPtr<BlockStatement> init_scope)
+    : m_init(move(init))
+    , m_test(move(test))
+    , m_update(move(update))
+    , m_body(move(body))
+    , m_init_scope(move(init_scope))
 {
-    RefPtr<BlockStatement> wrapper;
+}
 
-    if (m_init && m_init->is_variable_declaration() && static_cast<const VariableDeclaration*>(m_init.ptr())->declaration_type() != DeclarationType::Var) {
-        wrapper = create_ast_node<BlockStatement>();
-        interpreter.enter_scope(*wrapper, {}, ScopeType::Block);
-    }
+Value ForStatement::execute(Interpreter& interpreter) const
+{
+    if (m_init_scope)
+        interpreter.enter_scope(*m_init_scope, {}, ScopeType::Block);
 
     Value last_value = js_undefined();
 
@@ -220,8 +226,8 @@ Value ForStatement::execute(Interpreter& interpreter) const
         }
     }
 
-    if (wrapper)
-        interpreter.exit_scope(*wrapper);
+    if (m_init_scope)
+        interpreter.exit_scope(*m_init_scope);
 
     return last_value;
 }
@@ -308,22 +314,7 @@ Value UnaryExpression::execute(Interpreter& interpreter) const
     case UnaryOp::Minus:
         return unary_minus(lhs_result);
     case UnaryOp::Typeof:
-        switch (lhs_result.type()) {
-        case Value::Type::Undefined:
-            return js_string(interpreter.heap(), "undefined");
-        case Value::Type::Null:
-            // yes, this is on purpose. yes, this is how javascript works.
-            // yes, it's silly.
-            return js_string(interpreter.heap(), "object");
-        case Value::Type::Number:
-            return js_string(interpreter.heap(), "number");
-        case Value::Type::String:
-            return js_string(interpreter.heap(), "string");
-        case Value::Type::Object:
-            return js_string(interpreter.heap(), "object");
-        case Value::Type::Boolean:
-            return js_string(interpreter.heap(), "boolean");
-        }
+        return js_typeof(interpreter.heap(), lhs_result);
     }
 
     ASSERT_NOT_REACHED();
@@ -565,12 +556,23 @@ void ForStatement::dump(int indent) const
 
 Value Identifier::execute(Interpreter& interpreter) const
 {
+    if (has_slot())
+        return interpreter.get_variable_in_slot(m_slot_depth, m_slot_index);
+
     auto variable = interpreter.get_variable(string());
     if (!variable.has_value())
         return interpreter.throw_exception<Error>("ReferenceError", String::format("'%s' not known", string().characters()));
     return variable.value();
 }
 
+void Identifier::assign(Interpreter& interpreter, Value value, bool first_assignment) const
+{
+    if (has_slot())
+        interpreter.set_variable_in_slot(m_slot_depth, m_slot_index, value, first_assignment);
+    else
+        interpreter.set_variable(string(), value, first_assignment);
+}
+
 void Identifier::dump(int indent) const
 {
     print_indent(indent);
@@ -582,14 +584,16 @@ Value AssignmentExpression::execute(Interpreter& interpreter) const
     AK::Function<void(Value)> commit;
     if (m_lhs->is_identifier()) {
         commit = [&](Value value) {
-            auto name = static_cast<const Identifier&>(*m_lhs).string();
-            interpreter.set_variable(name, value);
+            static_cast<const Identifier&>(*m_lhs).assign(interpreter, value);
         };
     } else if (m_lhs->is_member_expression()) {
         commit = [&](Value value) {
-            if (auto* object = static_cast<const MemberExpression&>(*m_lhs).object().execute(interpreter).to_object(interpreter.heap())) {
-                auto property_name = static_cast<const MemberExpression&>(*m_lhs).computed_property_name(interpreter);
-                object->put(property_name, value);
+            auto& member_expression = static_cast<const MemberExpression&>(*m_lhs);
+            if (auto* object = member_expression.object().execute(interpreter).to_object(interpreter.heap())) {
+                if (member_expression.is_computed())
+                    object->put_computed(member_expression.property().execute(interpreter), value);
+                else
+                    m_property_cache.put(*object, member_expression.computed_property_name(interpreter), value);
             }
         };
     } else {
@@ -625,11 +629,10 @@ Value AssignmentExpression::execute(Interpreter& interpreter) const
 Value UpdateExpression::execute(Interpreter& interpreter) const
 {
     ASSERT(m_argument->is_identifier());
-    auto name = static_cast<const Identifier&>(*m_argument).string();
 
-    auto previous_variable = interpreter.get_variable(name);
-    ASSERT(previous_variable.has_value());
-    auto previous_value = previous_variable.value();
+    auto previous_value = m_argument->execute(interpreter);
+    if (interpreter.exception())
+        return {};
     ASSERT(previous_value.is_number());
 
     int op_result = 0;
@@ -642,7 +645,7 @@ Value UpdateExpression::execute(Interpreter& interpreter) const
         break;
     }
 
-    interpreter.set_variable(name, Value(previous_value.as_double() + op_result));
+    m_argument->assign(interpreter, Value(previous_value.as_double() + op_result));
 
     if (m_prefixed)
         return JS::Value(previous_value.as_double() + op_result);
@@ -703,12 +706,16 @@ void UpdateExpression::dump(int indent) const
 
 Value VariableDeclaration::execute(Interpreter& interpreter) const
 {
-    interpreter.declare_variable(name().string(), m_declaration_type);
+    if (!m_name->has_slot())
+        interpreter.declare_variable(name().string(), m_declaration_type);
+    else if (m_declaration_type != DeclarationType::Var)
+        m_name->assign(interpreter, js_undefined(), true);
+
     if (m_initializer) {
         auto initalizer_result = m_initializer->execute(interpreter);
         if (interpreter.exception())
             return {};
-        interpreter.set_variable(name().string(), initalizer_result, true);
+        m_name->assign(interpreter, initalizer_result, true);
     }
 
     return {};
@@ -787,8 +794,18 @@ Value MemberExpression::execute(Interpreter& interpreter) const
     auto* object_result = m_object->execute(interpreter).to_object(interpreter.heap());
     if (interpreter.exception())
         return {};
-    auto result = object_result->get(computed_property_name(interpreter));
-    return result.value_or({});
+    return get_property(interpreter, *object_result).value_or({});
+}
+
+Optional<Value> MemberExpression::get_property(Interpreter& interpreter, Object& object) const
+{
+    if (m_computed) {
+        auto key = m_property->execute(interpreter);
+        if (interpreter.exception())
+            return {};
+        return object.get_computed(key);
+    }
+    return m_property_cache.get(object, static_cast<const Identifier&>(*m_property).string());
 }
 
 Value StringLiteral::execute(Interpreter& interpreter) const
@@ -32,25 +32,37 @@
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
+#include <LibJS/ASTArena.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Runtime/PropertyCache.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS {
 
 template<class T, class... Args>
 static inline NonnullRefPtr<T>
-create_ast_node(Args&&... args)
+create_ast_node(ASTArena& arena, Args&&... args)
 {
-    return adopt(*new T(forward<Args>(args)...));
+    static_assert(alignof(T) <= ASTArena::alignment);
+    return adopt(*new (arena) T(forward<Args>(args)...));
 }
 
 class ASTNode : public RefCounted<ASTNode> {
 public:
+    // AST nodes can only be created in an ASTArena, see create_ast_node().
+    void* operator new(size_t size, ASTArena& arena) { return arena.allocate(size); }
+    void operator delete(void* ptr) { ASTArena::deallocate(ptr); }
+    void operator delete(void* ptr, ASTArena&) { ASTArena::deallocate(ptr); }
+
     virtual ~ASTNode() {}
     virtual const char* class_name() const = 0;
     virtual Value execute(Interpreter&) const = 0;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const;
+    virtual void resolve(ScopeResolver&) {}
     virtual void dump(int indent) const;
     virtual bool is_identifier() const { return false; }
+    virtual bool is_literal() const { return false; }
+    virtual bool is_program() const { return false; }
     virtual bool is_member_expression() const { return false; }
     virtual bool is_scope_node() const { return false; }
     virtual bool is_variable_declaration() const { return false; }
@@ -79,6 +91,8 @@ public:
     }
 
     Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     const char* class_name() const override { return "ExpressionStatement"; }
     virtual void dump(int indent) const override;
 
@@ -88,13 +102,11 @@ private:
 
 class ScopeNode : public Statement {
 public:
-    template<typename T, typename... Args>
-    T& append(Args&&... args)
-    {
-        auto child = create_ast_node<T>(forward<Args>(args)...);
-        m_children.append(move(child));
-        return static_cast<T&>(m_children.last());
-    }
+    struct Variable {
+        FlyString name;
+        DeclarationType declaration_type;
+    };
+
     void append(NonnullRefPtr<Statement> child)
     {
         m_children.append(move(child));
@@ -102,14 +114,31 @@ public:
 
     const NonnullRefPtrVector<Statement>& children() const { return m_children; }
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
+    void resolve_children(ScopeResolver&);
     virtual void dump(int indent) const override;
 
+    // The variables that live in this scope's ScopeFrame, in slot order.
+    // These are filled in by ScopeResolver after parsing.
+    const Vector<Variable>& variables() const { return m_variables; }
+    Optional<size_t> variable_index(const FlyString& name) const
+    {
+        auto it = m_variable_indices.find(name);
+        if (it == m_variable_indices.end())
+            return {};
+        return (*it).value;
+    }
+    size_t add_variable(const FlyString& name, DeclarationType);
+
 protected:
     ScopeNode() {}
 
 private:
     virtual bool is_scope_node() const final { return true; }
     NonnullRefPtrVector<Statement> m_children;
+    Vector<Variable> m_variables;
+    HashMap<FlyString, size_t> m_variable_indices;
 };
 
 class Program : public ScopeNode {
@@ -117,6 +146,7 @@ public:
     Program() {}
 
 private:
+    virtual bool is_program() const override { return true; }
     virtual const char* class_name() const override { return "Program"; }
 };
 
@@ -146,6 +176,7 @@ protected:
     }
 
     void dump(int indent, const char* class_name) const;
+    void resolve_function(ScopeResolver&);
 
 private:
     FlyString m_name;
@@ -165,6 +196,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -182,6 +215,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -204,6 +239,8 @@ public:
     const Expression* argument() const { return m_argument; }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -226,6 +263,8 @@ public:
     const Statement* alternate() const { return m_alternate; }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -248,6 +287,8 @@ public:
     const ScopeNode& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -259,13 +300,7 @@ private:
 
 class ForStatement : public Statement {
 public:
-    ForStatement(RefPtr<ASTNode> init, RefPtr<Expression> test, RefPtr<Expression> update, NonnullRefPtr<ScopeNode> body)
-        : m_init(move(init))
-        , m_test(move(test))
-        , m_update(move(update))
-        , m_body(move(body))
-    {
-    }
+    ForStatement(RefPtr<ASTNode> init, RefPtr<Expression> test, RefPtr<Expression> update, NonnullRefPtr<ScopeNode> body, RefPtr<BlockStatement> init_scope);
 
     const ASTNode* init() const { return m_init; }
     const Expression* test() const { return m_test; }
@@ -273,6 +308,8 @@ public:
     const ScopeNode& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -282,6 +319,9 @@ private:
     RefPtr<Expression> m_test;
     RefPtr<Expression> m_update;
     NonnullRefPtr<ScopeNode> m_body;
+
+    // Holds the loop variable when the init is a let/const declaration.
+    RefPtr<BlockStatement> m_init_scope;
 };
 
 enum class BinaryOp {
@@ -315,6 +355,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -340,6 +382,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -367,6 +411,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -377,6 +423,9 @@ private:
 };
 
 class Literal : public Expression {
+public:
+    virtual bool is_literal() const override { return true; }
+
 protected:
     explicit Literal() {}
 };
@@ -389,6 +438,7 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -405,6 +455,7 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -421,6 +472,7 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -434,6 +486,7 @@ public:
     explicit NullLiteral() {}
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -449,7 +502,23 @@ public:
 
     const FlyString& string() const { return m_string; }
 
+    // A resolved identifier refers to a slot in the ScopeFrame that is
+    // |slot_depth| frames below the innermost one. Unresolved identifiers
+    // are looked up by name at runtime.
+    bool has_slot() const { return m_slot_depth >= 0; }
+    size_t slot_depth() const { return m_slot_depth; }
+    size_t slot_index() const { return m_slot_index; }
+    void set_slot(size_t depth, size_t index)
+    {
+        m_slot_depth = depth;
+        m_slot_index = index;
+    }
+
+    void assign(Interpreter&, Value, bool first_assignment = false) const;
+
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
     virtual bool is_identifier() const override { return true; }
 
@@ -457,6 +526,8 @@ private:
     virtual const char* class_name() const override { return "Identifier"; }
 
     FlyString m_string;
+    ssize_t m_slot_depth { -1 };
+    size_t m_slot_index { 0 };
 };
 
 class CallExpression : public Expression {
@@ -468,6 +539,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -480,7 +553,7 @@ private:
     ThisAndCallee compute_this_and_callee(Interpreter&) const;
 
     NonnullRefPtr<Expression> m_callee;
-    const NonnullRefPtrVector<Expression> m_arguments;
+    NonnullRefPtrVector<Expression> m_arguments;
 };
 
 class NewExpression final : public CallExpression {
@@ -513,6 +586,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -521,6 +596,7 @@ private:
     AssignmentOp m_op;
     NonnullRefPtr<ASTNode> m_lhs;
     NonnullRefPtr<Expression> m_rhs;
+    mutable PropertyCache m_property_cache;
 };
 
 enum class UpdateOp {
@@ -538,6 +614,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -568,6 +646,8 @@ public:
     DeclarationType declaration_type() const { return m_declaration_type; }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -586,6 +666,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -604,6 +686,8 @@ public:
     const NonnullRefPtrVector<Expression>& elements() const { return m_elements; }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
 private:
@@ -622,6 +706,8 @@ public:
     }
 
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
     virtual void dump(int indent) const override;
 
     bool is_computed() const { return m_computed; }
@@ -629,6 +715,7 @@ public:
     const Expression& property() const { return *m_property; }
 
     FlyString computed_property_name(Interpreter&) const;
+    Optional<Value> get_property(Interpreter&, Object&) const;
 
 private:
     virtual bool is_member_expression() const override { return true; }
@@ -637,6 +724,7 @@ private:
     NonnullRefPtr<Expression> m_object;
     NonnullRefPtr<Expression> m_property;
     bool m_computed { false };
+    mutable PropertyCache m_property_cache;
 };
 
 class CatchClause final : public ASTNode {
@@ -652,6 +740,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&) const override;
+    virtual void resolve(ScopeResolver&) override;
 
 private:
     virtual const char* class_name() const override { return "CatchClause"; }
@@ -675,6 +764,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&) const override;
+    virtual void resolve(ScopeResolver&) override;
 
 private:
     virtual const char* class_name() const override { return "TryStatement"; }
@@ -695,6 +785,8 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&) const override;
+    virtual Bytecode::Register generate_bytecode(Bytecode::Generator&) const override;
+    virtual void resolve(ScopeResolver&) override;
 
 private:
     virtual const char* class_name() const override { return "ThrowStatement"; }
@@ -715,6 +807,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&) const override;
+    virtual void resolve(ScopeResolver&) override;
 
 private:
     virtual const char* class_name() const override { return "SwitchCase"; }
@@ -733,6 +826,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&) const override;
+    virtual void resolve(ScopeResolver&) override;
 
 private:
     virtual const char* class_name() const override { return "SwitchStatement"; }
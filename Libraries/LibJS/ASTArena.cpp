@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Assertions.h>
+#include <AK/kmalloc.h>
+#include <LibJS/ASTArena.h>
+#include <sys/mman.h>
+
+namespace JS {
+
+ASTArena::~ASTArena()
+{
+    if (m_current_chunk)
+        release_chunk(m_current_chunk);
+}
+
+ASTArena::Chunk* ASTArena::create_chunk()
+{
+#ifdef __serenity__
+    auto* chunk = (Chunk*)serenity_mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, chunk_size, "LibJS: ASTArena");
+    ASSERT(chunk != MAP_FAILED);
+#else
+    auto* chunk = (Chunk*)aligned_alloc(chunk_size, chunk_size);
+    ASSERT(chunk);
+#endif
+    new (chunk) Chunk;
+    // The arena holds a reference to its current chunk until it moves on.
+    chunk->live_allocations = 1;
+    return chunk;
+}
+
+void ASTArena::release_chunk(Chunk* chunk)
+{
+    ASSERT(chunk->live_allocations);
+    if (--chunk->live_allocations)
+        return;
+#ifdef __serenity__
+    int rc = munmap(chunk, chunk_size);
+    ASSERT(rc == 0);
+#else
+    free(chunk);
+#endif
+}
+
+void* ASTArena::allocate(size_t size)
+{
+    size = (size + alignment - 1) & ~(alignment - 1);
+    if (!m_current_chunk || m_current_chunk->used + size > m_current_chunk->capacity()) {
+        ASSERT(size <= chunk_size - sizeof(Chunk));
+        if (m_current_chunk)
+            release_chunk(m_current_chunk);
+        m_current_chunk = create_chunk();
+        ++m_chunk_count;
+    }
+    void* ptr = &m_current_chunk->storage[m_current_chunk->used];
+    m_current_chunk->used += size;
+    ++m_current_chunk->live_allocations;
+    m_bytes_allocated += size;
+    return ptr;
+}
+
+void ASTArena::deallocate(void* ptr)
+{
+    release_chunk(Chunk::from_allocation(ptr));
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+
+namespace JS {
+
+// Bump allocator for AST nodes. Memory is carved out of chunk_size-aligned
+// chunks, each of which counts its live nodes and is freed as a whole once
+// the last of them goes away. This keeps chunks alive for as long as any
+// node in them is referenced (e.g. a function body held by a ScriptFunction),
+// without tying the nodes' lifetime to the ASTArena that handed them out.
+class ASTArena {
+    AK_MAKE_NONCOPYABLE(ASTArena);
+
+public:
+    static constexpr size_t chunk_size = 64 * KB;
+    static constexpr size_t alignment = sizeof(void*);
+
+    ASTArena() {}
+    ~ASTArena();
+
+    void* allocate(size_t);
+    static void deallocate(void*);
+
+    size_t bytes_allocated() const { return m_bytes_allocated; }
+    size_t chunk_count() const { return m_chunk_count; }
+
+private:
+    struct Chunk {
+        size_t live_allocations { 0 };
+        size_t used { 0 };
+        u8 storage[];
+
+        static Chunk* from_allocation(void* ptr) { return reinterpret_cast<Chunk*>((FlatPtr)ptr & ~(chunk_size - 1)); }
+        size_t capacity() const { return chunk_size - sizeof(Chunk); }
+    };
+
+    static Chunk* create_chunk();
+    static void release_chunk(Chunk*);
+
+    Chunk* m_current_chunk { nullptr };
+    size_t m_bytes_allocated { 0 };
+    size_t m_chunk_count { 0 };
+};
+
+}
@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Register.h>
+
+namespace JS {
+
+using Bytecode::Generator;
+using Bytecode::Opcode;
+using Bytecode::Register;
+
+// Locals are read in place, so a later operand with side effects (like `i + i++`)
+// could change one under our feet. Snapshot it into a temporary in that case.
+static Register protect(Generator& generator, Register reg, const Expression& next_operand)
+{
+    if (reg.is_temporary() || next_operand.is_identifier() || next_operand.is_literal())
+        return reg;
+    auto copy = generator.allocate_register();
+    generator.emit(Opcode::Move, copy, reg);
+    return copy;
+}
+
+static Register load_constant(Generator& generator, Value value)
+{
+    auto dst = generator.allocate_register();
+    generator.emit(Opcode::LoadConstant, dst.index(), generator.add_constant(value));
+    return dst;
+}
+
+static void clear_completion(Generator& generator)
+{
+    if (generator.is_generating_function())
+        return;
+    generator.emit(Opcode::LoadConstant, generator.completion_register().index(), generator.add_constant(js_undefined()));
+}
+
+Register ASTNode::generate_bytecode(Generator& generator) const
+{
+    generator.fail(class_name());
+    return {};
+}
+
+Register ScopeNode::generate_bytecode(Generator& generator) const
+{
+    generator.begin_scope();
+    for (auto& child : children()) {
+        auto mark = generator.temporary_mark();
+        child.generate_bytecode(generator);
+        generator.release_temporaries(mark);
+        if (generator.has_failed())
+            break;
+    }
+    generator.end_scope();
+    return generator.completion_register();
+}
+
+Register ExpressionStatement::generate_bytecode(Generator& generator) const
+{
+    auto value = m_expression->generate_bytecode(generator);
+    if (!generator.is_generating_function())
+        generator.emit(Opcode::Move, generator.completion_register(), value);
+    return value;
+}
+
+Register FunctionDeclaration::generate_bytecode(Generator& generator) const
+{
+    // Nested functions would need to see our locals, which only live in registers.
+    if (generator.is_generating_function() || !generator.is_at_top_level())
+        return ASTNode::generate_bytecode(generator);
+    auto function = generator.allocate_register();
+    generator.emit(Opcode::NewFunction, function.index(), generator.add_function(*this));
+    generator.emit(Opcode::SetVariable, generator.add_identifier(name()), function.index(), false);
+    clear_completion(generator);
+    return function;
+}
+
+Register FunctionExpression::generate_bytecode(Generator& generator) const
+{
+    if (generator.is_generating_function() || !generator.is_at_top_level())
+        return ASTNode::generate_bytecode(generator);
+    auto function = generator.allocate_register();
+    generator.emit(Opcode::NewFunction, function.index(), generator.add_function(*this));
+    return function;
+}
+
+Register ReturnStatement::generate_bytecode(Generator& generator) const
+{
+    if (!generator.is_generating_function())
+        return ASTNode::generate_bytecode(generator);
+    auto value = m_argument ? m_argument->generate_bytecode(generator) : load_constant(generator, js_undefined());
+    generator.emit(Opcode::Return, value);
+    return value;
+}
+
+Register IfStatement::generate_bytecode(Generator& generator) const
+{
+    auto predicate = m_predicate->generate_bytecode(generator);
+    auto jump_to_alternate = generator.emit_jump(Opcode::JumpIfFalse, predicate);
+    m_consequent->generate_bytecode(generator);
+    if (m_alternate) {
+        auto jump_to_end = generator.emit_jump(Opcode::Jump);
+        generator.patch_jump(jump_to_alternate, generator.current_position());
+        m_alternate->generate_bytecode(generator);
+        generator.patch_jump(jump_to_end, generator.current_position());
+    } else {
+        generator.patch_jump(jump_to_alternate, generator.current_position());
+    }
+    return generator.completion_register();
+}
+
+Register WhileStatement::generate_bytecode(Generator& generator) const
+{
+    auto loop_start = generator.current_position();
+    auto predicate = m_predicate->generate_bytecode(generator);
+    auto jump_to_end = generator.emit_jump(Opcode::JumpIfFalse, predicate);
+    m_body->generate_bytecode(generator);
+    generator.patch_jump(generator.emit_jump(Opcode::Jump), loop_start);
+    generator.patch_jump(jump_to_end, generator.current_position());
+    return generator.completion_register();
+}
+
+Register ForStatement::generate_bytecode(Generator& generator) const
+{
+    bool has_lexical_init = m_init && m_init->is_variable_declaration() && static_cast<const VariableDeclaration&>(*m_init).declaration_type() != DeclarationType::Var;
+    if (has_lexical_init)
+        generator.begin_scope();
+
+    if (m_init)
+        m_init->generate_bytecode(generator);
+
+    auto loop_start = generator.current_position();
+    Optional<size_t> jump_to_end;
+    if (m_test)
+        jump_to_end = generator.emit_jump(Opcode::JumpIfFalse, m_test->generate_bytecode(generator));
+    m_body->generate_bytecode(generator);
+    if (m_update)
+        m_update->generate_bytecode(generator);
+    generator.patch_jump(generator.emit_jump(Opcode::Jump), loop_start);
+    if (jump_to_end.has_value())
+        generator.patch_jump(jump_to_end.value(), generator.current_position());
+
+    if (has_lexical_init)
+        generator.end_scope();
+    return generator.completion_register();
+}
+
+static Opcode opcode_for(BinaryOp op)
+{
+    switch (op) {
+    case BinaryOp::Plus:
+        return Opcode::Add;
+    case BinaryOp::Minus:
+        return Opcode::Sub;
+    case BinaryOp::Asterisk:
+        return Opcode::Mul;
+    case BinaryOp::Slash:
+        return Opcode::Div;
+    case BinaryOp::TypedEquals:
+        return Opcode::TypedEquals;
+    case BinaryOp::TypedInequals:
+        return Opcode::TypedInequals;
+    case BinaryOp::AbstractEquals:
+        return Opcode::AbstractEquals;
+    case BinaryOp::AbstractInequals:
+        return Opcode::AbstractInequals;
+    case BinaryOp::GreaterThan:
+        return Opcode::GreaterThan;
+    case BinaryOp::GreaterThanEquals:
+        return Opcode::GreaterThanEquals;
+    case BinaryOp::LessThan:
+        return Opcode::LessThan;
+    case BinaryOp::LessThanEquals:
+        return Opcode::LessThanEquals;
+    case BinaryOp::BitwiseAnd:
+        return Opcode::BitwiseAnd;
+    case BinaryOp::BitwiseOr:
+        return Opcode::BitwiseOr;
+    case BinaryOp::BitwiseXor:
+        return Opcode::BitwiseXor;
+    case BinaryOp::LeftShift:
+        return Opcode::LeftShift;
+    case BinaryOp::RightShift:
+        return Opcode::RightShift;
+    case BinaryOp::InstanceOf:
+        return Opcode::InstanceOf;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+Register BinaryExpression::generate_bytecode(Generator& generator) const
+{
+    auto lhs = protect(generator, m_lhs->generate_bytecode(generator), *m_rhs);
+    auto rhs = m_rhs->generate_bytecode(generator);
+    auto dst = generator.allocate_register();
+    generator.emit(opcode_for(m_op), dst, lhs, rhs);
+    return dst;
+}
+
+Register LogicalExpression::generate_bytecode(Generator& generator) const
+{
+    // NOTE: Like LogicalExpression::execute(), this evaluates both sides and yields a boolean.
+    auto lhs = protect(generator, m_lhs->generate_bytecode(generator), *m_rhs);
+    auto rhs = m_rhs->generate_bytecode(generator);
+    auto dst = generator.allocate_register();
+    generator.emit(m_op == LogicalOp::And ? Opcode::LogicalAnd : Opcode::LogicalOr, dst, lhs, rhs);
+    return dst;
+}
+
+Register UnaryExpression::generate_bytecode(Generator& generator) const
+{
+    auto src = m_lhs->generate_bytecode(generator);
+    auto dst = generator.allocate_register();
+    Opcode opcode = Opcode::Not;
+    switch (m_op) {
+    case UnaryOp::BitwiseNot:
+        opcode = Opcode::BitwiseNot;
+        break;
+    case UnaryOp::Not:
+        opcode = Opcode::Not;
+        break;
+    case UnaryOp::Plus:
+        opcode = Opcode::UnaryPlus;
+        break;
+    case UnaryOp::Minus:
+        opcode = Opcode::UnaryMinus;
+        break;
+    case UnaryOp::Typeof:
+        opcode = Opcode::Typeof;
+        break;
+    }
+    generator.emit(opcode, dst, src);
+    return dst;
+}
+
+Register BooleanLiteral::generate_bytecode(Generator& generator) const
+{
+    return load_constant(generator, Value(m_value));
+}
+
+Register NumericLiteral::generate_bytecode(Generator& generator) const
+{
+    return load_constant(generator, Value(m_value));
+}
+
+Register NullLiteral::generate_bytecode(Generator& generator) const
+{
+    return load_constant(generator, js_null());
+}
+
+Register StringLiteral::generate_bytecode(Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit(Opcode::LoadString, dst.index(), generator.add_string(m_value));
+    return dst;
+}
+
+Register Identifier::generate_bytecode(Generator& generator) const
+{
+    if (auto local = generator.find_local(m_string); local.has_value())
+        return local.value();
+    auto dst = generator.allocate_register();
+    if (m_string == "this")
+        generator.emit(Opcode::LoadThis, dst);
+    else
+        generator.emit(Opcode::GetVariable, dst.index(), generator.add_identifier(m_string));
+    return dst;
+}
+
+Register CallExpression::generate_bytecode(Generator& generator) const
+{
+    auto this_and_arguments = generator.allocate_registers(m_arguments.size() + 1);
+    auto this_register = this_and_arguments;
+
+    Register callee;
+    if (is_new_expression()) {
+        callee = m_callee->generate_bytecode(generator);
+    } else if (m_callee->is_member_expression()) {
+        auto& member_expression = static_cast<const MemberExpression&>(*m_callee);
+        auto object = member_expression.object().generate_bytecode(generator);
+        generator.emit(Opcode::ToObject, this_register, object);
+        callee = generator.allocate_register();
+        if (member_expression.is_computed()) {
+            auto key = member_expression.property().generate_bytecode(generator);
+            generator.emit(Opcode::GetComputedProperty, callee, this_register, key);
+        } else {
+            auto& name = static_cast<const Identifier&>(member_expression.property()).string();
+            generator.emit(Opcode::GetProperty, callee.index(), this_register.index(), generator.add_identifier(name), generator.add_property_cache());
+        }
+    } else {
+        callee = m_callee->generate_bytecode(generator);
+        generator.emit(Opcode::LoadGlobalObject, this_register);
+    }
+
+    if (!m_arguments.is_empty())
+        callee = protect(generator, callee, m_arguments.first());
+
+    for (size_t i = 0; i < m_arguments.size(); ++i) {
+        auto argument = m_arguments[i].generate_bytecode(generator);
+        generator.emit(Opcode::Move, this_and_arguments.offset_by(i + 1), argument);
+    }
+
+    auto dst = generator.allocate_register();
+    generator.emit(is_new_expression() ? Opcode::New : Opcode::Call, dst.index(), callee.index(), this_and_arguments.index(), m_arguments.size());
+    return dst;
+}
+
+static Opcode opcode_for(AssignmentOp op)
+{
+    switch (op) {
+    case AssignmentOp::AdditionAssignment:
+        return Opcode::Add;
+    case AssignmentOp::SubtractionAssignment:
+        return Opcode::Sub;
+    case AssignmentOp::MultiplicationAssignment:
+        return Opcode::Mul;
+    case AssignmentOp::DivisionAssignment:
+        return Opcode::Div;
+    case AssignmentOp::Assignment:
+        break;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+Register AssignmentExpression::generate_bytecode(Generator& generator) const
+{
+    if (m_lhs->is_identifier()) {
+        auto& name = static_cast<const Identifier&>(*m_lhs).string();
+        auto local = generator.find_local(name);
+        auto value = m_rhs->generate_bytecode(generator);
+        if (m_op != AssignmentOp::Assignment) {
+            auto current = m_lhs->generate_bytecode(generator);
+            auto result = generator.allocate_register();
+            generator.emit(opcode_for(m_op), result, current, value);
+            value = result;
+        }
+        if (local.has_value()) {
+            generator.emit(Opcode::Move, local.value(), value);
+            return local.value();
+        }
+        generator.emit(Opcode::SetVariable, generator.add_identifier(name), value.index(), false);
+        return value;
+    }
+
+    if (m_lhs->is_member_expression()) {
+        auto& member_expression = static_cast<const MemberExpression&>(*m_lhs);
+        auto object = member_expression.object().generate_bytecode(generator);
+        Register key;
+        if (member_expression.is_computed()) {
+            object = protect(generator, object, member_expression.property());
+            key = member_expression.property().generate_bytecode(generator);
+            key = protect(generator, key, *m_rhs);
+        } else {
+            object = protect(generator, object, *m_rhs);
+        }
+        u32 identifier = member_expression.is_computed() ? 0 : generator.add_identifier(static_cast<const Identifier&>(member_expression.property()).string());
+
+        auto value = m_rhs->generate_bytecode(generator);
+        if (m_op != AssignmentOp::Assignment) {
+            auto current = generator.allocate_register();
+            if (member_expression.is_computed())
+                generator.emit(Opcode::GetComputedProperty, current, object, key);
+            else
+                generator.emit(Opcode::GetProperty, current.index(), object.index(), identifier, generator.add_property_cache());
+            auto result = generator.allocate_register();
+            generator.emit(opcode_for(m_op), result, current, value);
+            value = result;
+        }
+
+        if (member_expression.is_computed())
+            generator.emit(Opcode::PutComputedProperty, object, key, value);
+        else
+            generator.emit(Opcode::PutProperty, object.index(), identifier, value.index(), generator.add_property_cache());
+        return value;
+    }
+
+    return ASTNode::generate_bytecode(generator);
+}
+
+Register UpdateExpression::generate_bytecode(Generator& generator) const
+{
+    if (!m_argument->is_identifier())
+        return ASTNode::generate_bytecode(generator);
+
+    auto opcode = m_op == UpdateOp::Increment ? Opcode::Increment : Opcode::Decrement;
+    auto& name = m_argument->string();
+
+    if (auto local = generator.find_local(name); local.has_value()) {
+        if (m_prefixed) {
+            generator.emit(opcode, local.value(), local.value());
+            return local.value();
+        }
+        auto previous = generator.allocate_register();
+        generator.emit(Opcode::ToNumber, previous, local.value());
+        generator.emit(opcode, local.value(), previous);
+        return previous;
+    }
+
+    auto previous = generator.allocate_register();
+    generator.emit(Opcode::GetVariable, previous.index(), generator.add_identifier(name));
+    generator.emit(Opcode::ToNumber, previous, previous);
+    auto updated = generator.allocate_register();
+    generator.emit(opcode, updated, previous);
+    generator.emit(Opcode::SetVariable, generator.add_identifier(name), updated.index(), false);
+    return m_prefixed ? updated : previous;
+}
+
+Register VariableDeclaration::generate_bytecode(Generator& generator) const
+{
+    auto& name = m_name->string();
+
+    // Top-level declarations of a Program (and all of its vars) must stay visible
+    // to other functions by name, so they go through the scope stack like before.
+    bool is_dynamic = !generator.is_generating_function() && (generator.is_at_top_level() || m_declaration_type == DeclarationType::Var);
+    if (is_dynamic) {
+        auto identifier = generator.add_identifier(name);
+        generator.emit(Opcode::DeclareVariable, identifier, (u32)m_declaration_type);
+        if (m_initializer) {
+            auto value = m_initializer->generate_bytecode(generator);
+            generator.emit(Opcode::SetVariable, identifier, value.index(), true);
+        }
+        clear_completion(generator);
+        return generator.completion_register();
+    }
+
+    auto local = generator.declare_local(name, m_declaration_type);
+    if (m_initializer) {
+        auto value = m_initializer->generate_bytecode(generator);
+        generator.emit(Opcode::Move, local, value);
+    } else if (m_declaration_type != DeclarationType::Var) {
+        generator.emit(Opcode::LoadConstant, local.index(), generator.add_constant(js_undefined()));
+    }
+    clear_completion(generator);
+    return local;
+}
+
+Register ObjectExpression::generate_bytecode(Generator& generator) const
+{
+    auto object = generator.allocate_register();
+    generator.emit(Opcode::NewObject, object);
+    for (auto& it : m_properties) {
+        auto value = it.value->generate_bytecode(generator);
+        generator.emit(Opcode::PutProperty, object.index(), generator.add_identifier(it.key), value.index(), generator.add_property_cache());
+    }
+    return object;
+}
+
+Register ArrayExpression::generate_bytecode(Generator& generator) const
+{
+    auto elements = generator.allocate_registers(m_elements.size());
+    for (size_t i = 0; i < m_elements.size(); ++i) {
+        auto element = m_elements[i].generate_bytecode(generator);
+        generator.emit(Opcode::Move, elements.offset_by(i), element);
+    }
+    auto array = generator.allocate_register();
+    generator.emit(Opcode::NewArray, array.index(), elements.index(), m_elements.size());
+    return array;
+}
+
+Register MemberExpression::generate_bytecode(Generator& generator) const
+{
+    auto object = m_object->generate_bytecode(generator);
+    auto dst = generator.allocate_register();
+    if (is_computed()) {
+        object = protect(generator, object, *m_property);
+        auto key = m_property->generate_bytecode(generator);
+        generator.emit(Opcode::GetComputedProperty, dst, object, key);
+    } else {
+        auto& name = static_cast<const Identifier&>(*m_property).string();
+        generator.emit(Opcode::GetProperty, dst.index(), object.index(), generator.add_identifier(name), generator.add_property_cache());
+    }
+    return dst;
+}
+
+Register ThrowStatement::generate_bytecode(Generator& generator) const
+{
+    auto value = m_argument->generate_bytecode(generator);
+    generator.emit(Opcode::Throw, value);
+    return value;
+}
+
+}
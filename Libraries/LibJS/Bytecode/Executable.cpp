@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Bytecode/Executable.h>
+#include <stdio.h>
+
+namespace JS::Bytecode {
+
+const char* to_string(Opcode opcode)
+{
+    switch (opcode) {
+#define __ENUMERATE_BYTECODE_OPCODE(name) \
+    case Opcode::name:                    \
+        return #name;
+        ENUMERATE_BYTECODE_OPCODES(__ENUMERATE_BYTECODE_OPCODE)
+#undef __ENUMERATE_BYTECODE_OPCODE
+    }
+    ASSERT_NOT_REACHED();
+}
+
+void Executable::dump() const
+{
+    printf("Executable (%zu registers, %zu parameters)\n", register_count, parameter_count);
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        auto& instruction = instructions[i];
+        printf("  [%4zu] %-20s %u, %u, %u, %u\n", i, to_string(instruction.opcode),
+            instruction.operands[0], instruction.operands[1], instruction.operands[2], instruction.operands[3]);
+    }
+    for (size_t i = 0; i < identifiers.size(); ++i)
+        printf("  identifier %zu: %s\n", i, identifiers[i].characters());
+    for (size_t i = 0; i < constants.size(); ++i)
+        printf("  constant %zu: %s\n", i, constants[i].to_string().characters());
+}
+
+}
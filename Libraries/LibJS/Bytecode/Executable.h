@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/PropertyCache.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// A compiled Program or function body, ready to run on Bytecode::Interpreter.
+struct Executable {
+    Vector<Instruction> instructions;
+
+    // Only non-cell values (numbers, booleans, null, undefined) live here,
+    // so the constant table never needs to be visited by the GC.
+    Vector<Value> constants;
+    Vector<String> strings;
+    Vector<FlyString> identifiers;
+    Vector<const FunctionNode*> functions;
+
+    // One per GetProperty/PutProperty instruction, updated as the code runs.
+    mutable Vector<PropertyCache> property_caches;
+
+    size_t register_count { 0 };
+    size_t parameter_count { 0 };
+
+    void dump() const;
+};
+
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+
+//#define BYTECODE_DEBUG
+
+namespace JS::Bytecode {
+
+Generator::Generator(bool is_function)
+    : m_executable(make<Executable>())
+    , m_is_function(is_function)
+{
+}
+
+OwnPtr<Executable> Generator::generate_program(const Program& program)
+{
+    Generator generator(false);
+    generator.m_completion_register = Register::local(generator.m_local_count++);
+    program.generate_bytecode(generator);
+    generator.emit(Opcode::Return, generator.m_completion_register);
+    return generator.finish();
+}
+
+OwnPtr<Executable> Generator::generate_function(const ScopeNode& body, const Vector<FlyString>& parameters)
+{
+    Generator generator(true);
+    generator.begin_scope();
+    for (auto& parameter : parameters)
+        generator.declare_local(parameter, DeclarationType::Var);
+    generator.m_executable->parameter_count = parameters.size();
+    // Hoist the function's vars (ScopeResolver collected them on the body) so
+    // that uses before the declaration refer to the local as well.
+    for (auto& variable : body.variables()) {
+        if (variable.declaration_type == DeclarationType::Var)
+            generator.declare_local(variable.name, DeclarationType::Var);
+    }
+    body.generate_bytecode(generator);
+    generator.end_scope();
+    auto undefined = generator.allocate_register();
+    generator.emit(Opcode::LoadConstant, undefined.index(), generator.add_constant(js_undefined()));
+    generator.emit(Opcode::Return, undefined);
+    return generator.finish();
+}
+
+OwnPtr<Executable> Generator::finish()
+{
+    if (m_failed)
+        return nullptr;
+
+    // Now that we know how many locals there are, move the temporaries behind them.
+    for (auto& instruction : m_executable->instructions) {
+        for (auto& operand : instruction.operands) {
+            if (operand & Register::temporary_flag)
+                operand = m_local_count + (operand & ~Register::temporary_flag);
+        }
+    }
+    m_executable->register_count = m_local_count + m_temporary_count;
+
+#ifdef BYTECODE_DEBUG
+    m_executable->dump();
+#endif
+    return move(m_executable);
+}
+
+Register Generator::allocate_register()
+{
+    return allocate_registers(1);
+}
+
+Register Generator::allocate_registers(size_t count)
+{
+    auto first = Register::temporary(m_next_temporary);
+    m_next_temporary += count;
+    if (m_next_temporary > m_temporary_count)
+        m_temporary_count = m_next_temporary;
+    return first;
+}
+
+void Generator::begin_scope()
+{
+    m_scopes.append(Scope {});
+}
+
+void Generator::end_scope()
+{
+    m_scopes.take_last();
+}
+
+Register Generator::declare_local(const FlyString& name, DeclarationType declaration_type)
+{
+    auto& scope = declaration_type == DeclarationType::Var ? m_scopes.first() : m_scopes.last();
+    if (declaration_type == DeclarationType::Var) {
+        auto existing = scope.locals.get(name);
+        if (existing.has_value())
+            return existing.value();
+    }
+    auto local = Register::local(m_local_count++);
+    scope.locals.set(name, local);
+    return local;
+}
+
+Optional<Register> Generator::find_local(const FlyString& name) const
+{
+    for (ssize_t i = m_scopes.size() - 1; i >= 0; --i) {
+        auto local = m_scopes[i].locals.get(name);
+        if (local.has_value())
+            return local;
+    }
+    return {};
+}
+
+size_t Generator::emit(Opcode opcode, u32 a, u32 b, u32 c, u32 d)
+{
+    m_executable->instructions.append({ opcode, { a, b, c, d } });
+    return m_executable->instructions.size() - 1;
+}
+
+size_t Generator::emit_jump(Opcode opcode)
+{
+    ASSERT(opcode == Opcode::Jump);
+    return emit(opcode);
+}
+
+size_t Generator::emit_jump(Opcode opcode, Register condition)
+{
+    ASSERT(opcode == Opcode::JumpIfTrue || opcode == Opcode::JumpIfFalse);
+    return emit(opcode, condition.index());
+}
+
+void Generator::patch_jump(size_t jump_index, size_t target)
+{
+    auto& jump = m_executable->instructions[jump_index];
+    if (jump.opcode == Opcode::Jump)
+        jump.operands[0] = target;
+    else
+        jump.operands[1] = target;
+}
+
+u32 Generator::add_constant(Value value)
+{
+    ASSERT(!value.is_cell());
+    m_executable->constants.append(value);
+    return m_executable->constants.size() - 1;
+}
+
+u32 Generator::add_string(const String& string)
+{
+    m_executable->strings.append(string);
+    return m_executable->strings.size() - 1;
+}
+
+u32 Generator::add_identifier(const FlyString& identifier)
+{
+    auto existing = m_identifier_indices.get(identifier);
+    if (existing.has_value())
+        return existing.value();
+    m_executable->identifiers.append(identifier);
+    u32 index = m_executable->identifiers.size() - 1;
+    m_identifier_indices.set(identifier, index);
+    return index;
+}
+
+u32 Generator::add_function(const FunctionNode& function)
+{
+    m_executable->functions.append(&function);
+    return m_executable->functions.size() - 1;
+}
+
+u32 Generator::add_property_cache()
+{
+    m_executable->property_caches.append(PropertyCache {});
+    return m_executable->property_caches.size() - 1;
+}
+
+void Generator::fail(const char* reason)
+{
+#ifdef BYTECODE_DEBUG
+    dbg() << "Bytecode::Generator: Can't lower " << reason << ", falling back to the AST interpreter";
+#else
+    (void)reason;
+#endif
+    m_failed = true;
+}
+
+}
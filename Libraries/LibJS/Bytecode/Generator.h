@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+// Lowers a Program or a function body into an Executable.
+//
+// Function parameters and declarations are resolved to local registers at
+// compile time. Top-level declarations of a Program stay dynamic, since other
+// functions look them up by name at runtime. Anything the generator doesn't
+// know how to lower makes it give up, and the caller falls back to the AST
+// interpreter.
+class Generator {
+public:
+    static OwnPtr<Executable> generate_program(const Program&);
+    static OwnPtr<Executable> generate_function(const ScopeNode& body, const Vector<FlyString>& parameters);
+
+    bool is_generating_function() const { return m_is_function; }
+    bool is_at_top_level() const { return m_scopes.size() == 1; }
+
+    Register allocate_register();
+    Register allocate_registers(size_t count);
+    size_t temporary_mark() const { return m_next_temporary; }
+    void release_temporaries(size_t mark) { m_next_temporary = mark; }
+
+    void begin_scope();
+    void end_scope();
+    Register declare_local(const FlyString& name, DeclarationType);
+    Optional<Register> find_local(const FlyString& name) const;
+
+    Register completion_register() const { return m_completion_register; }
+
+    size_t emit(Opcode, u32 = 0, u32 = 0, u32 = 0, u32 = 0);
+    size_t emit(Opcode opcode, Register a) { return emit(opcode, a.index()); }
+    size_t emit(Opcode opcode, Register a, Register b) { return emit(opcode, a.index(), b.index()); }
+    size_t emit(Opcode opcode, Register a, Register b, Register c) { return emit(opcode, a.index(), b.index(), c.index()); }
+
+    size_t emit_jump(Opcode);
+    size_t emit_jump(Opcode, Register condition);
+    void patch_jump(size_t jump_index, size_t target);
+    size_t current_position() const { return m_executable->instructions.size(); }
+
+    u32 add_constant(Value);
+    u32 add_string(const String&);
+    u32 add_identifier(const FlyString&);
+    u32 add_function(const FunctionNode&);
+    u32 add_property_cache();
+
+    void fail(const char* reason);
+    bool has_failed() const { return m_failed; }
+
+private:
+    explicit Generator(bool is_function);
+
+    OwnPtr<Executable> finish();
+
+    struct Scope {
+        HashMap<FlyString, Register> locals;
+    };
+
+    OwnPtr<Executable> m_executable;
+    Vector<Scope> m_scopes;
+    HashMap<FlyString, u32> m_identifier_indices;
+
+    Register m_completion_register;
+
+    u32 m_local_count { 0 };
+    u32 m_next_temporary { 0 };
+    u32 m_temporary_count { 0 };
+    bool m_is_function { false };
+    bool m_failed { false };
+};
+
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// Operands are listed destination register first, then sources:
+//
+//   LoadConstant dst, constant         GetProperty dst, object, identifier, cache
+//   LoadString dst, string             GetComputedProperty dst, object, key
+//   GetVariable dst, identifier        PutProperty object, identifier, src, cache
+//   SetVariable identifier, src, first_assignment
+//   DeclareVariable identifier, declaration_type
+//   <binary op> dst, lhs, rhs          PutComputedProperty object, key, src
+//   <unary op> dst, src                NewArray dst, first, count
+//   Jump target                        NewFunction dst, function
+//   JumpIf{True,False} condition, target
+//   Call/New dst, callee, first, argument_count
+//
+// Call and New expect |this| in register |first|, followed by the arguments.
+// Identifier, string, constant and function operands index into the tables
+// of the Executable.
+#define ENUMERATE_BYTECODE_OPCODES(O) \
+    O(LoadConstant)                   \
+    O(LoadString)                     \
+    O(LoadThis)                       \
+    O(LoadGlobalObject)               \
+    O(Move)                           \
+    O(GetVariable)                    \
+    O(SetVariable)                    \
+    O(DeclareVariable)                \
+    O(Add)                            \
+    O(Sub)                            \
+    O(Mul)                            \
+    O(Div)                            \
+    O(TypedEquals)                    \
+    O(TypedInequals)                  \
+    O(AbstractEquals)                 \
+    O(AbstractInequals)               \
+    O(GreaterThan)                    \
+    O(GreaterThanEquals)              \
+    O(LessThan)                       \
+    O(LessThanEquals)                 \
+    O(BitwiseAnd)                     \
+    O(BitwiseOr)                      \
+    O(BitwiseXor)                     \
+    O(LeftShift)                      \
+    O(RightShift)                     \
+    O(InstanceOf)                     \
+    O(LogicalAnd)                     \
+    O(LogicalOr)                      \
+    O(Not)                            \
+    O(BitwiseNot)                     \
+    O(UnaryPlus)                      \
+    O(UnaryMinus)                     \
+    O(Typeof)                         \
+    O(ToNumber)                       \
+    O(ToObject)                       \
+    O(Increment)                      \
+    O(Decrement)                      \
+    O(Jump)                           \
+    O(JumpIfTrue)                     \
+    O(JumpIfFalse)                    \
+    O(GetProperty)                    \
+    O(GetComputedProperty)            \
+    O(PutProperty)                    \
+    O(PutComputedProperty)            \
+    O(NewObject)                      \
+    O(NewArray)                       \
+    O(NewFunction)                    \
+    O(Call)                           \
+    O(New)                            \
+    O(Throw)                          \
+    O(Return)
+
+namespace JS::Bytecode {
+
+enum class Opcode : u32 {
+#define __ENUMERATE_BYTECODE_OPCODE(name) name,
+    ENUMERATE_BYTECODE_OPCODES(__ENUMERATE_BYTECODE_OPCODE)
+#undef __ENUMERATE_BYTECODE_OPCODE
+};
+
+const char* to_string(Opcode);
+
+struct Instruction {
+    Opcode opcode;
+    u32 operands[4];
+};
+
+}
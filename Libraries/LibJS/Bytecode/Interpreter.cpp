@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ScopeGuard.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/NativeFunction.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/PrimitiveString.h>
+#include <LibJS/Runtime/ScriptFunction.h>
+
+namespace JS::Bytecode {
+
+static Value call_function(JS::Interpreter& interpreter, Value callee, const Value* this_and_arguments, size_t argument_count, bool is_new)
+{
+    if (is_new) {
+        if (!callee.is_object()
+            || !callee.as_object().is_function()
+            || (callee.as_object().is_native_function()
+                && !static_cast<NativeFunction&>(callee.as_object()).has_constructor()))
+            return interpreter.throw_exception<Error>("TypeError", String::format("%s is not a constructor", callee.to_string().characters()));
+    }
+
+    if (!callee.is_object() || !callee.as_object().is_function())
+        return interpreter.throw_exception<Error>("TypeError", String::format("%s is not a function", callee.to_string().characters()));
+
+    auto& function = static_cast<Function&>(callee.as_object());
+
+    auto& call_frame = interpreter.push_call_frame();
+    call_frame.arguments.ensure_capacity(argument_count);
+    for (size_t i = 0; i < argument_count; ++i)
+        call_frame.arguments.unchecked_append(this_and_arguments[i + 1]);
+
+    Object* new_object = nullptr;
+    Value result;
+    if (is_new) {
+        new_object = interpreter.heap().allocate<Object>();
+        auto prototype = function.get("prototype");
+        if (prototype.has_value() && prototype.value().is_object())
+            new_object->set_prototype(&prototype.value().as_object());
+        call_frame.this_value = new_object;
+        result = function.construct(interpreter);
+    } else {
+        call_frame.this_value = this_and_arguments[0];
+        result = function.call(interpreter);
+    }
+
+    interpreter.pop_call_frame();
+
+    if (is_new && !result.is_object())
+        return new_object;
+    return result;
+}
+
+Value Interpreter::run(const Executable& executable, const Vector<Value>& arguments)
+{
+    Vector<Value> registers;
+    registers.ensure_capacity(executable.register_count);
+    for (size_t i = 0; i < executable.register_count; ++i)
+        registers.unchecked_append(js_undefined());
+    for (size_t i = 0; i < executable.parameter_count && i < arguments.size(); ++i)
+        registers[i] = arguments[i];
+
+    m_interpreter.push_register_window({}, registers);
+    ScopeGuard pop_register_window([&] { m_interpreter.pop_register_window({}); });
+
+    auto& heap = m_interpreter.heap();
+    auto* instructions = executable.instructions.data();
+    size_t pc = 0;
+
+#define REG(n) registers[instruction.operands[n]]
+
+    for (;;) {
+        auto& instruction = instructions[pc++];
+        switch (instruction.opcode) {
+        case Opcode::LoadConstant:
+            REG(0) = executable.constants[instruction.operands[1]];
+            break;
+        case Opcode::LoadString:
+            REG(0) = js_string(heap, executable.strings[instruction.operands[1]]);
+            break;
+        case Opcode::LoadThis:
+            REG(0) = m_interpreter.this_value();
+            break;
+        case Opcode::LoadGlobalObject:
+            REG(0) = &m_interpreter.global_object();
+            break;
+        case Opcode::Move:
+            REG(0) = REG(1);
+            break;
+        case Opcode::GetVariable: {
+            auto& name = executable.identifiers[instruction.operands[1]];
+            auto variable = m_interpreter.get_variable(name);
+            if (!variable.has_value()) {
+                m_interpreter.throw_exception<Error>("ReferenceError", String::format("'%s' not known", name.characters()));
+                return {};
+            }
+            REG(0) = variable.value();
+            break;
+        }
+        case Opcode::SetVariable:
+            m_interpreter.set_variable(executable.identifiers[instruction.operands[0]], REG(1), instruction.operands[2]);
+            break;
+        case Opcode::DeclareVariable:
+            m_interpreter.declare_variable(executable.identifiers[instruction.operands[0]], static_cast<DeclarationType>(instruction.operands[1]));
+            break;
+        case Opcode::Add:
+            REG(0) = add(REG(1), REG(2));
+            break;
+        case Opcode::Sub:
+            REG(0) = sub(REG(1), REG(2));
+            break;
+        case Opcode::Mul:
+            REG(0) = mul(REG(1), REG(2));
+            break;
+        case Opcode::Div:
+            REG(0) = div(REG(1), REG(2));
+            break;
+        case Opcode::TypedEquals:
+            REG(0) = typed_eq(REG(1), REG(2));
+            break;
+        case Opcode::TypedInequals:
+            REG(0) = Value(!typed_eq(REG(1), REG(2)).as_bool());
+            break;
+        case Opcode::AbstractEquals:
+            REG(0) = eq(REG(1), REG(2));
+            break;
+        case Opcode::AbstractInequals:
+            REG(0) = Value(!eq(REG(1), REG(2)).as_bool());
+            break;
+        case Opcode::GreaterThan:
+            REG(0) = greater_than(REG(1), REG(2));
+            break;
+        case Opcode::GreaterThanEquals:
+            REG(0) = greater_than_equals(REG(1), REG(2));
+            break;
+        case Opcode::LessThan:
+            REG(0) = less_than(REG(1), REG(2));
+            break;
+        case Opcode::LessThanEquals:
+            REG(0) = less_than_equals(REG(1), REG(2));
+            break;
+        case Opcode::BitwiseAnd:
+            REG(0) = bitwise_and(REG(1), REG(2));
+            break;
+        case Opcode::BitwiseOr:
+            REG(0) = bitwise_or(REG(1), REG(2));
+            break;
+        case Opcode::BitwiseXor:
+            REG(0) = bitwise_xor(REG(1), REG(2));
+            break;
+        case Opcode::LeftShift:
+            REG(0) = left_shift(REG(1), REG(2));
+            break;
+        case Opcode::RightShift:
+            REG(0) = right_shift(REG(1), REG(2));
+            break;
+        case Opcode::InstanceOf:
+            REG(0) = instance_of(REG(1), REG(2));
+            break;
+        case Opcode::LogicalAnd:
+            REG(0) = Value(REG(1).to_boolean() && REG(2).to_boolean());
+            break;
+        case Opcode::LogicalOr:
+            REG(0) = Value(REG(1).to_boolean() || REG(2).to_boolean());
+            break;
+        case Opcode::Not:
+            REG(0) = Value(!REG(1).to_boolean());
+            break;
+        case Opcode::BitwiseNot:
+            REG(0) = bitwise_not(REG(1));
+            break;
+        case Opcode::UnaryPlus:
+            REG(0) = unary_plus(REG(1));
+            break;
+        case Opcode::UnaryMinus:
+            REG(0) = unary_minus(REG(1));
+            break;
+        case Opcode::Typeof:
+            REG(0) = js_typeof(heap, REG(1));
+            break;
+        case Opcode::ToNumber:
+            REG(0) = REG(1).to_number();
+            break;
+        case Opcode::ToObject:
+            REG(0) = REG(1).to_object(heap);
+            break;
+        case Opcode::Increment:
+            REG(0) = Value(REG(1).to_number().as_double() + 1);
+            break;
+        case Opcode::Decrement:
+            REG(0) = Value(REG(1).to_number().as_double() - 1);
+            break;
+        case Opcode::Jump:
+            pc = instruction.operands[0];
+            break;
+        case Opcode::JumpIfTrue:
+            if (REG(0).to_boolean())
+                pc = instruction.operands[1];
+            break;
+        case Opcode::JumpIfFalse:
+            if (!REG(0).to_boolean())
+                pc = instruction.operands[1];
+            break;
+        case Opcode::GetProperty:
+            if (auto* object = REG(1).to_object(heap))
+                REG(0) = executable.property_caches[instruction.operands[3]].get(*object, executable.identifiers[instruction.operands[2]]).value_or({});
+            break;
+        case Opcode::GetComputedProperty:
+            if (auto* object = REG(1).to_object(heap))
+                REG(0) = object->get_computed(REG(2)).value_or({});
+            break;
+        case Opcode::PutProperty:
+            if (auto* object = REG(0).to_object(heap))
+                executable.property_caches[instruction.operands[3]].put(*object, executable.identifiers[instruction.operands[1]], REG(2));
+            break;
+        case Opcode::PutComputedProperty:
+            if (auto* object = REG(0).to_object(heap))
+                object->put_computed(REG(1), REG(2));
+            break;
+        case Opcode::NewObject:
+            REG(0) = heap.allocate<Object>();
+            break;
+        case Opcode::NewArray: {
+            auto* array = heap.allocate<Array>();
+            for (size_t i = 0; i < instruction.operands[2]; ++i)
+                array->push(registers[instruction.operands[1] + i]);
+            REG(0) = array;
+            break;
+        }
+        case Opcode::NewFunction: {
+            auto& function = *executable.functions[instruction.operands[1]];
+            REG(0) = heap.allocate<ScriptFunction>(function.body(), function.parameters());
+            break;
+        }
+        case Opcode::Call:
+        case Opcode::New:
+            REG(0) = call_function(m_interpreter, REG(1), &REG(2), instruction.operands[3], instruction.opcode == Opcode::New);
+            break;
+        case Opcode::Throw:
+            m_interpreter.throw_exception(REG(0));
+            return {};
+        case Opcode::Return:
+            return REG(0);
+        }
+
+        if (m_interpreter.exception())
+            return {};
+    }
+
+#undef REG
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace JS::Bytecode {
+
+class Register {
+public:
+    // Temporaries are numbered separately while generating code and get
+    // placed after all the locals once the final local count is known.
+    static constexpr u32 temporary_flag = 0x80000000;
+
+    static Register local(u32 index) { return Register(index); }
+    static Register temporary(u32 index) { return Register(index | temporary_flag); }
+
+    Register() {}
+
+    u32 index() const { return m_index; }
+    bool is_temporary() const { return m_index & temporary_flag; }
+
+    // For addressing the registers of a block from allocate_registers().
+    Register offset_by(u32 offset) const { return Register(m_index + offset); }
+
+    bool operator==(const Register& other) const { return m_index == other.m_index; }
+    bool operator!=(const Register& other) const { return m_index != other.m_index; }
+
+private:
+    explicit Register(u32 index)
+        : m_index(index)
+    {
+    }
+
+    u32 m_index { 0 };
+};
+
+}
@@ -35,14 +35,18 @@ class Error;
 class Exception;
 class Expression;
 class Function;
+class FunctionNode;
 class GlobalObject;
 class HandleImpl;
 class Heap;
 class HeapBlock;
 class Interpreter;
+class MarkedValueList;
 class Object;
 class PrimitiveString;
+class Program;
 class ScopeNode;
+class ScopeResolver;
 class Shape;
 class Statement;
 class Value;
@@ -51,4 +55,11 @@ enum class DeclarationType;
 template<class T>
 class Handle;
 
+namespace Bytecode {
+class Generator;
+class Interpreter;
+class Register;
+struct Executable;
+}
+
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NonnullOwnPtr.h>
+#include <LibJS/Heap/CellAllocator.h>
+#include <LibJS/Heap/HeapBlock.h>
+
+namespace JS {
+
+CellAllocator::CellAllocator(size_t cell_size)
+    : m_cell_size(cell_size)
+{
+}
+
+CellAllocator::~CellAllocator()
+{
+    for_each_block([this](auto& block) {
+        destroy_block(block);
+    });
+}
+
+Cell* CellAllocator::allocate_cell(Heap& heap, HeapBlock*& block, bool& was_block_created)
+{
+    was_block_created = false;
+    if (m_usable_blocks.is_empty()) {
+        m_usable_blocks.append(HeapBlock::create_with_cell_size(heap, m_cell_size).leak_ptr());
+        ++m_block_count;
+        was_block_created = true;
+    }
+    block = m_usable_blocks.head();
+    auto* cell = block->allocate();
+    ASSERT(cell);
+    if (block->is_full()) {
+        m_usable_blocks.remove(block);
+        m_full_blocks.append(block);
+    }
+    return cell;
+}
+
+void CellAllocator::block_did_become_usable(HeapBlock& block)
+{
+    ASSERT(!block.is_full());
+    m_full_blocks.remove(&block);
+    m_usable_blocks.append(&block);
+}
+
+void CellAllocator::destroy_block(HeapBlock& block)
+{
+    if (block.is_full())
+        m_full_blocks.remove(&block);
+    else
+        m_usable_blocks.remove(&block);
+    --m_block_count;
+    delete &block;
+}
+
+}
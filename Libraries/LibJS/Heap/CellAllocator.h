@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/InlineLinkedList.h>
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Heap/HeapBlock.h>
+
+namespace JS {
+
+// Owns all the HeapBlocks of one cell size. Blocks with at least one free
+// cell are kept on a separate list, so allocation never has to look at a
+// full block.
+class CellAllocator {
+    AK_MAKE_NONCOPYABLE(CellAllocator);
+    AK_MAKE_NONMOVABLE(CellAllocator);
+
+public:
+    explicit CellAllocator(size_t cell_size);
+    ~CellAllocator();
+
+    size_t cell_size() const { return m_cell_size; }
+    size_t block_count() const { return m_block_count; }
+
+    // Returns the cell and the block it was allocated from. The block is new if was_block_created is set.
+    Cell* allocate_cell(Heap&, HeapBlock*& block, bool& was_block_created);
+
+    template<typename Callback>
+    void for_each_block(Callback callback)
+    {
+        for (auto* block = m_usable_blocks.head(); block;) {
+            auto* next = block->next();
+            callback(*block);
+            block = next;
+        }
+        for (auto* block = m_full_blocks.head(); block;) {
+            auto* next = block->next();
+            callback(*block);
+            block = next;
+        }
+    }
+
+    // Called after sweeping a block that was full before the sweep freed some of its cells.
+    void block_did_become_usable(HeapBlock&);
+    void destroy_block(HeapBlock&);
+
+private:
+    size_t m_cell_size { 0 };
+    size_t m_block_count { 0 };
+    InlineLinkedList<HeapBlock> m_usable_blocks;
+    InlineLinkedList<HeapBlock> m_full_blocks;
+};
+
+}
@@ -29,10 +29,13 @@
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Heap/HeapBlock.h>
+#include <LibJS/Heap/MarkedValueList.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/Shape.h>
 #include <setjmp.h>
 #include <stdio.h>
+#include <time.h>
 
 #ifdef __serenity__
 #    include <serenity.h>
@@ -49,6 +52,11 @@ namespace JS {
 Heap::Heap(Interpreter& interpreter)
     : m_interpreter(interpreter)
 {
+    // Sizes in between powers of two keep common cells like Array (80 bytes)
+    // and Shape (152 bytes) from wasting a third of their block.
+    static constexpr size_t cell_sizes[] = { 32, 64, 96, 128, 192, 256, 384, 512, 1024, 2048, 3072 };
+    for (auto cell_size : cell_sizes)
+        m_allocators.append(make<CellAllocator>(cell_size));
 }
 
 Heap::~Heap()
@@ -58,31 +66,67 @@ Heap::~Heap()
 
 Cell* Heap::allocate_cell(size_t size)
 {
-    if (should_collect_on_every_allocation())
-        collect_garbage();
-
-    for (auto& block : m_blocks) {
-        if (size > block->cell_size())
-            continue;
-        if (auto* cell = block->allocate())
-            return cell;
+    if (should_collect_on_every_allocation() || m_bytes_allocated_since_last_collection >= young_generation_budget)
+        collect_garbage(CollectionType::CollectYoungGarbage);
+
+    HeapBlock* block_to_allocate_from = nullptr;
+    bool was_block_created = false;
+    auto* cell = allocator_for_size(size).allocate_cell(*this, block_to_allocate_from, was_block_created);
+    if (was_block_created)
+        m_block_addresses.set(block_to_allocate_from);
+
+    if (!block_to_allocate_from->is_in_nursery()) {
+        block_to_allocate_from->set_in_nursery(true);
+        m_nursery_blocks.append(block_to_allocate_from);
     }
-
-    size_t cell_size = round_up_to_power_of_two(size, 16);
-    auto block = HeapBlock::create_with_cell_size(*this, cell_size);
-    auto* cell = block->allocate();
-    m_blocks.append(move(block));
+    m_bytes_allocated_since_last_collection += block_to_allocate_from->cell_size();
     return cell;
 }
 
+static u64 current_time_in_microseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 void Heap::collect_garbage(CollectionType collection_type)
 {
-    if (collection_type == CollectionType::CollectGarbage) {
-        HashTable<Cell*> roots;
-        gather_roots(roots);
-        mark_live_cells(roots);
+    if (collection_type == CollectionType::CollectEverything) {
+        forget_remembered_cells();
+        sweep_dead_cells();
+        return;
+    }
+
+    if (collection_type == CollectionType::CollectYoungGarbage && m_old_generation_bytes >= m_old_generation_budget)
+        collection_type = CollectionType::CollectGarbage;
+    bool young_only = collection_type == CollectionType::CollectYoungGarbage;
+
+    auto start_time = current_time_in_microseconds();
+
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+    mark_live_cells(roots, young_only);
+    remove_dead_prototype_transitions(young_only);
+
+    // Property caches may point at Shapes and Objects that are about to be freed.
+    m_interpreter.invalidate_property_caches();
+
+    forget_remembered_cells();
+    if (young_only) {
+        sweep_young_cells();
+    } else {
+        sweep_dead_cells();
+        m_old_generation_budget = max(m_old_generation_bytes * old_generation_growth_factor, min_old_generation_budget);
     }
-    sweep_dead_cells();
+    m_bytes_allocated_since_last_collection = 0;
+
+    auto pause = current_time_in_microseconds() - start_time;
+    auto& statistics = young_only ? m_young_collection_statistics : m_full_collection_statistics;
+    ++statistics.collections;
+    statistics.total_microseconds += pause;
+    statistics.max_microseconds = max(statistics.max_microseconds, pause);
+    statistics.last_microseconds = pause;
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -94,6 +138,13 @@ void Heap::gather_roots(HashTable<Cell*>& roots)
     for (auto* handle : m_handles)
         roots.set(handle->cell());
 
+    for (auto* list : m_marked_value_lists) {
+        for (auto& value : *list) {
+            if (value.is_cell())
+                roots.set(value.as_cell());
+        }
+    }
+
 #ifdef HEAP_DEBUG
     dbg() << "gather_roots:";
     for (auto* root : roots) {
@@ -113,12 +164,10 @@ void Heap::gather_conservative_roots(HashTable<Cell*>& roots)
     jmp_buf buf;
     setjmp(buf);
 
-    HashTable<FlatPtr> possible_pointers;
-
     const FlatPtr* raw_jmp_buf = reinterpret_cast<const FlatPtr*>(buf);
 
-    for (size_t i = 0; i < sizeof(buf) / sizeof(FlatPtr); i += sizeof(FlatPtr))
-        possible_pointers.set(raw_jmp_buf[i]);
+    for (size_t i = 0; i < sizeof(buf) / sizeof(FlatPtr); ++i)
+        add_possible_root(roots, raw_jmp_buf[i]);
 
     FlatPtr stack_base;
     size_t stack_size;
@@ -144,67 +193,126 @@ void Heap::gather_conservative_roots(HashTable<Cell*>& roots)
     FlatPtr stack_reference = reinterpret_cast<FlatPtr>(&dummy);
     FlatPtr stack_top = stack_base + stack_size;
 
-    for (FlatPtr stack_address = stack_reference; stack_address < stack_top; stack_address += sizeof(FlatPtr)) {
-        auto data = *reinterpret_cast<FlatPtr*>(stack_address);
-        possible_pointers.set(data);
-    }
+    for (FlatPtr stack_address = stack_reference; stack_address < stack_top; stack_address += sizeof(FlatPtr))
+        add_possible_root(roots, *reinterpret_cast<FlatPtr*>(stack_address));
+}
 
-    for (auto possible_pointer : possible_pointers) {
-        if (!possible_pointer)
-            continue;
+void Heap::add_possible_root(HashTable<Cell*>& roots, FlatPtr possible_pointer)
+{
+#ifdef JS_VALUE_NAN_BOXING
+    // A NaN-boxed Value on the stack keeps its Cell pointer in the low bits.
+    if (((u64)possible_pointer & Value::nan_box_prefix) == Value::nan_box_prefix)
+        possible_pointer = (FlatPtr)((u64)possible_pointer & Value::nan_box_payload_mask);
+#endif
+    if (!possible_pointer)
+        return;
 #ifdef HEAP_DEBUG
-        dbg() << "  ? " << (const void*)possible_pointer;
+    dbg() << "  ? " << (const void*)possible_pointer;
 #endif
-        if (auto* cell = cell_from_possible_pointer(possible_pointer)) {
-            if (cell->is_live()) {
+    // HeapBlocks are aligned to their size, so masking off the low bits gives
+    // us the only block this could possibly point into.
+    auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(possible_pointer));
+    if (!m_block_addresses.contains(possible_heap_block))
+        return;
+    auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer);
+    if (!cell)
+        return;
+    if (cell->is_live()) {
 #ifdef HEAP_DEBUG
-                dbg() << "  ?-> " << (const void*)cell;
+        dbg() << "  ?-> " << (const void*)cell;
 #endif
-                roots.set(cell);
-            } else {
+        roots.set(cell);
+    } else {
 #ifdef HEAP_DEBUG
-                dbg() << "  #-> " << (const void*)cell;
+        dbg() << "  #-> " << (const void*)cell;
 #endif
-            }
-        }
     }
 }
 
-Cell* Heap::cell_from_possible_pointer(FlatPtr pointer)
+CellAllocator& Heap::allocator_for_size(size_t size)
+{
+    for (auto& allocator : m_allocators) {
+        if (allocator->cell_size() >= size)
+            return *allocator;
+    }
+    ASSERT_NOT_REACHED();
+}
+
+size_t Heap::block_count() const
 {
-    auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(pointer));
-    if (m_blocks.find([possible_heap_block](auto& block) { return block.ptr() == possible_heap_block; }) == m_blocks.end())
-        return nullptr;
-    return possible_heap_block->cell_from_possible_pointer(pointer);
+    size_t count = 0;
+    for (auto& allocator : m_allocators)
+        count += allocator->block_count();
+    return count;
+}
+
+void Heap::did_sweep_block(HeapBlock& block, bool was_full, bool has_live_cells)
+{
+    auto& allocator = allocator_for_size(block.cell_size());
+    if (was_full && !block.is_full())
+        allocator.block_did_become_usable(block);
+    if (!has_live_cells) {
+#ifdef HEAP_DEBUG
+        dbg() << " - Reclaim HeapBlock @ " << &block << ": cell_size=" << block.cell_size();
+#endif
+        m_block_addresses.remove(&block);
+        allocator.destroy_block(block);
+    }
 }
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() {}
+    explicit MarkingVisitor(bool young_only)
+        : m_young_only(young_only)
+    {
+    }
 
     virtual void visit(Cell* cell)
     {
-        if (cell->is_marked())
+        if (!cell || cell->is_marked())
+            return;
+        // In a young collection, old cells are live by definition. Any young
+        // cells they point to are found through the remembered set instead.
+        if (m_young_only && cell->is_old())
             return;
 #ifdef HEAP_DEBUG
         dbg() << "  ! " << cell;
 #endif
         cell->set_marked(true);
-        cell->visit_children(*this);
+        m_work_queue.append(cell);
+    }
+
+    void drain()
+    {
+        while (!m_work_queue.is_empty())
+            m_work_queue.take_last()->visit_children(*this);
     }
+
+private:
+    bool m_young_only { false };
+    Vector<Cell*> m_work_queue;
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+void Heap::mark_live_cells(const HashTable<Cell*>& roots, bool young_only)
 {
 #ifdef HEAP_DEBUG
     dbg() << "mark_live_cells:";
 #endif
-    MarkingVisitor visitor;
-    for (auto* root : roots) {
-        if (!root)
-            continue;
+    MarkingVisitor visitor(young_only);
+    for (auto* root : roots)
         visitor.visit(root);
+    if (young_only) {
+        for (auto* cell : m_remembered_cells)
+            cell->visit_children(visitor);
     }
+    visitor.drain();
+}
+
+void Heap::forget_remembered_cells()
+{
+    for (auto* cell : m_remembered_cells)
+        cell->set_remembered(false);
+    m_remembered_cells.clear();
 }
 
 void Heap::sweep_dead_cells()
@@ -212,39 +320,71 @@ void Heap::sweep_dead_cells()
 #ifdef HEAP_DEBUG
     dbg() << "sweep_dead_cells:";
 #endif
-    Vector<HeapBlock*, 32> empty_blocks;
+    for (auto* block : m_nursery_blocks)
+        block->set_in_nursery(false);
+    m_nursery_blocks.clear();
+    m_old_generation_bytes = 0;
 
-    for (auto& block : m_blocks) {
+    for_each_block([&](HeapBlock& block) {
+        bool was_full = block.is_full();
         bool block_has_live_cells = false;
-        block->for_each_cell([&](Cell* cell) {
+        block.for_each_cell([&](Cell* cell) {
             if (cell->is_live()) {
                 if (!cell->is_marked()) {
 #ifdef HEAP_DEBUG
                     dbg() << "  ~ " << cell;
 #endif
-                    block->deallocate(cell);
+                    block.deallocate(cell);
                 } else {
                     cell->set_marked(false);
+                    cell->set_old(true);
+                    m_old_generation_bytes += block.cell_size();
                     block_has_live_cells = true;
                 }
             }
         });
-        if (!block_has_live_cells)
-            empty_blocks.append(block);
-    }
+        did_sweep_block(block, was_full, block_has_live_cells);
+    });
 
-    for (auto* block : empty_blocks) {
 #ifdef HEAP_DEBUG
-        dbg() << " - Reclaim HeapBlock @ " << block << ": cell_size=" << block->cell_size();
+    for_each_block([](HeapBlock& block) {
+        dbg() << " > Live HeapBlock @ " << &block << ": cell_size=" << block.cell_size();
+    });
 #endif
-        m_blocks.remove_first_matching([block](auto& entry) { return entry == block; });
-    }
+}
 
+void Heap::sweep_young_cells()
+{
 #ifdef HEAP_DEBUG
-    for (auto& block : m_blocks) {
-        dbg() << " > Live HeapBlock @ " << block << ": cell_size=" << block->cell_size();
-    }
+    dbg() << "sweep_young_cells:";
+#endif
+    // Young cells only ever live in nursery blocks, so those are the only ones we need to look at.
+    for (auto* block : m_nursery_blocks) {
+        block->set_in_nursery(false);
+        bool was_full = block->is_full();
+        bool block_has_live_cells = false;
+        block->for_each_cell([&](Cell* cell) {
+            if (!cell->is_live())
+                return;
+            if (cell->is_old()) {
+                block_has_live_cells = true;
+                return;
+            }
+            if (!cell->is_marked()) {
+#ifdef HEAP_DEBUG
+                dbg() << "  ~ " << cell;
 #endif
+                block->deallocate(cell);
+                return;
+            }
+            cell->set_marked(false);
+            cell->set_old(true);
+            m_old_generation_bytes += block->cell_size();
+            block_has_live_cells = true;
+        });
+        did_sweep_block(*block, was_full, block_has_live_cells);
+    }
+    m_nursery_blocks.clear();
 }
 
 void Heap::did_create_handle(Badge<HandleImpl>, HandleImpl& impl)
@@ -259,4 +399,43 @@ void Heap::did_destroy_handle(Badge<HandleImpl>, HandleImpl& impl)
     m_handles.remove(&impl);
 }
 
+void Heap::remove_dead_prototype_transitions(bool young_only)
+{
+    // Old cells aren't marked by a young collection, but they survive it all the same.
+    auto survives = [young_only](Cell* cell) {
+        return cell->is_marked() || (young_only && cell->is_old());
+    };
+    for (auto* shape : m_shapes_with_prototype_transitions) {
+        if (!survives(shape))
+            continue;
+        shape->remove_prototype_transitions_if({}, [&](Object* prototype, Shape* new_shape) {
+            return (prototype && !survives(prototype)) || !survives(new_shape);
+        });
+    }
+}
+
+void Heap::did_create_prototype_transitions(Badge<Shape>, Shape& shape)
+{
+    ASSERT(!m_shapes_with_prototype_transitions.contains(&shape));
+    m_shapes_with_prototype_transitions.set(&shape);
+}
+
+void Heap::did_destroy_prototype_transitions(Badge<Shape>, Shape& shape)
+{
+    ASSERT(m_shapes_with_prototype_transitions.contains(&shape));
+    m_shapes_with_prototype_transitions.remove(&shape);
+}
+
+void Heap::did_create_marked_value_list(Badge<MarkedValueList>, MarkedValueList& list)
+{
+    ASSERT(!m_marked_value_lists.contains(&list));
+    m_marked_value_lists.set(&list);
+}
+
+void Heap::did_destroy_marked_value_list(Badge<MarkedValueList>, MarkedValueList& list)
+{
+    ASSERT(m_marked_value_lists.contains(&list));
+    m_marked_value_lists.remove(&list);
+}
+
 }
@@ -32,6 +32,7 @@
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Runtime/Cell.h>
 
@@ -54,35 +55,91 @@ public:
     }
 
     enum class CollectionType {
+        // Only collects cells allocated since the last collection.
+        CollectYoungGarbage,
         CollectGarbage,
         CollectEverything,
     };
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage);
 
+    struct PauseStatistics {
+        size_t collections { 0 };
+        u64 total_microseconds { 0 };
+        u64 max_microseconds { 0 };
+        u64 last_microseconds { 0 };
+    };
+
+    const PauseStatistics& young_collection_statistics() const { return m_young_collection_statistics; }
+    const PauseStatistics& full_collection_statistics() const { return m_full_collection_statistics; }
+
     Interpreter& interpreter() { return m_interpreter; }
 
+    size_t block_count() const;
+
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
     void set_should_collect_on_every_allocation(bool b) { m_should_collect_on_every_allocation = b; }
 
     void did_create_handle(Badge<HandleImpl>, HandleImpl&);
     void did_destroy_handle(Badge<HandleImpl>, HandleImpl&);
 
+    void did_create_marked_value_list(Badge<MarkedValueList>, MarkedValueList&);
+    void did_destroy_marked_value_list(Badge<MarkedValueList>, MarkedValueList&);
+
+    void did_remember_cell(Badge<Cell>, Cell& cell) { m_remembered_cells.append(&cell); }
+
+    void did_create_prototype_transitions(Badge<Shape>, Shape&);
+    void did_destroy_prototype_transitions(Badge<Shape>, Shape&);
+
 private:
+    // Allocating this much since the last collection triggers a young collection.
+    static constexpr size_t young_generation_budget = 1 * MB;
+    // A full collection happens once the old generation has grown this much
+    // (relative to its size after the previous full collection).
+    static constexpr size_t old_generation_growth_factor = 2;
+    static constexpr size_t min_old_generation_budget = 4 * MB;
+
     Cell* allocate_cell(size_t);
 
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
+    void mark_live_cells(const HashTable<Cell*>& live_cells, bool young_only);
+    void remove_dead_prototype_transitions(bool young_only);
     void sweep_dead_cells();
+    void sweep_young_cells();
+    void forget_remembered_cells();
+
+    void add_possible_root(HashTable<Cell*>& roots, FlatPtr);
 
-    Cell* cell_from_possible_pointer(FlatPtr);
+    CellAllocator& allocator_for_size(size_t);
+    void did_sweep_block(HeapBlock&, bool was_full, bool has_live_cells);
+
+    template<typename Callback>
+    void for_each_block(Callback callback)
+    {
+        for (auto& allocator : m_allocators)
+            allocator->for_each_block(callback);
+    }
 
     bool m_should_collect_on_every_allocation { false };
 
     Interpreter& m_interpreter;
-    Vector<NonnullOwnPtr<HeapBlock>> m_blocks;
+    // One allocator per size class, ordered by cell size.
+    Vector<NonnullOwnPtr<CellAllocator>> m_allocators;
+    // All blocks owned by the allocators, for checking whether an address is a HeapBlock in O(1).
+    HashTable<HeapBlock*> m_block_addresses;
+    Vector<HeapBlock*> m_nursery_blocks;
+    Vector<Cell*> m_remembered_cells;
     HashTable<HandleImpl*> m_handles;
+    HashTable<MarkedValueList*> m_marked_value_lists;
+    HashTable<Shape*> m_shapes_with_prototype_transitions;
+
+    size_t m_bytes_allocated_since_last_collection { 0 };
+    size_t m_old_generation_bytes { 0 };
+    size_t m_old_generation_budget { min_old_generation_budget };
+
+    PauseStatistics m_young_collection_statistics;
+    PauseStatistics m_full_collection_statistics;
 };
 
 }
@@ -26,13 +26,16 @@
 
 #pragma once
 
+#include <AK/InlineLinkedList.h>
 #include <AK/Types.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Runtime/Cell.h>
 
 namespace JS {
 
-class HeapBlock {
+class HeapBlock : public InlineLinkedListNode<HeapBlock> {
+    friend class InlineLinkedListNode<HeapBlock>;
+
 public:
     static constexpr size_t block_size = 16 * KB;
     static NonnullOwnPtr<HeapBlock> create_with_cell_size(Heap&, size_t);
@@ -47,6 +50,8 @@ public:
     Cell* allocate();
     void deallocate(Cell*);
 
+    bool is_full() const { return !m_freelist; }
+
     template<typename Callback>
     void for_each_cell(Callback callback)
     {
@@ -56,6 +61,10 @@ public:
 
     Heap& heap() { return m_heap; }
 
+    // A block is in the nursery if cells were allocated in it since the last collection.
+    bool is_in_nursery() const { return m_in_nursery; }
+    void set_in_nursery(bool b) { m_in_nursery = b; }
+
     static HeapBlock* from_cell(const Cell* cell)
     {
         return reinterpret_cast<HeapBlock*>((FlatPtr)cell & ~(block_size - 1));
@@ -66,6 +75,8 @@ public:
         if (pointer < reinterpret_cast<FlatPtr>(m_storage))
             return nullptr;
         size_t cell_index = (pointer - reinterpret_cast<FlatPtr>(m_storage)) / m_cell_size;
+        if (cell_index >= cell_count())
+            return nullptr;
         return cell(cell_index);
     }
 
@@ -79,6 +90,9 @@ private:
     Heap& m_heap;
     size_t m_cell_size { 0 };
     FreelistEntry* m_freelist { nullptr };
+    bool m_in_nursery { false };
+    HeapBlock* m_prev { nullptr };
+    HeapBlock* m_next { nullptr };
     u8 m_storage[];
 };
 
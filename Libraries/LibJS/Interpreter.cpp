@@ -26,6 +26,9 @@
 
 #include <AK/Badge.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/ArrayPrototype.h>
 #include <LibJS/Runtime/DatePrototype.h>
@@ -63,6 +66,18 @@ Value Interpreter::run(const Statement& statement, Vector<Argument> arguments, S
         return statement.execute(*this);
 
     auto& block = static_cast<const ScopeNode&>(statement);
+
+    if (m_bytecode_enabled && block.is_program()) {
+        if (auto executable = Bytecode::Generator::generate_program(static_cast<const Program&>(block))) {
+            enter_scope(block, move(arguments), scope_type);
+            auto result = Bytecode::Interpreter(*this).run(*executable);
+            if (m_unwind_until == scope_type)
+                m_unwind_until = ScopeType::None;
+            exit_scope(block);
+            return result;
+        }
+    }
+
     enter_scope(block, move(arguments), scope_type);
 
     Value last_value = js_undefined();
@@ -81,11 +96,17 @@ Value Interpreter::run(const Statement& statement, Vector<Argument> arguments, S
 
 void Interpreter::enter_scope(const ScopeNode& scope_node, Vector<Argument> arguments, ScopeType scope_type)
 {
-    HashMap<FlyString, Variable> scope_variables_with_declaration_type;
+    Vector<Value> variables;
+    variables.ensure_capacity(scope_node.variables().size());
+    for (size_t i = 0; i < scope_node.variables().size(); ++i)
+        variables.unchecked_append(js_undefined());
+
     for (auto& argument : arguments) {
-        scope_variables_with_declaration_type.set(argument.name, { argument.value, DeclarationType::Var });
+        auto index = scope_node.variable_index(argument.name);
+        ASSERT(index.has_value());
+        variables[index.value()] = argument.value;
     }
-    m_scope_stack.append({ scope_type, scope_node, move(scope_variables_with_declaration_type) });
+    m_scope_stack.append({ scope_type, scope_node, move(variables) });
 }
 
 void Interpreter::exit_scope(const ScopeNode& scope_node)
@@ -108,10 +129,13 @@ void Interpreter::declare_variable(const FlyString& name, DeclarationType declar
         for (ssize_t i = m_scope_stack.size() - 1; i >= 0; --i) {
             auto& scope = m_scope_stack.at(i);
             if (scope.type == ScopeType::Function) {
-                if (scope.variables.get(name).has_value() && scope.variables.get(name).value().declaration_type != DeclarationType::Var)
+                auto index = scope.scope_node->variable_index(name);
+                if (!index.has_value())
+                    break;
+                if (scope.scope_node->variables()[index.value()].declaration_type != DeclarationType::Var)
                     ASSERT_NOT_REACHED();
 
-                scope.variables.set(move(name), { js_undefined(), declaration_type });
+                scope.variables[index.value()] = js_undefined();
                 return;
             }
         }
@@ -119,13 +143,14 @@ void Interpreter::declare_variable(const FlyString& name, DeclarationType declar
         global_object().put(move(name), js_undefined());
         break;
     case DeclarationType::Let:
-    case DeclarationType::Const:
-        if (m_scope_stack.last().variables.get(name).has_value())
-            ASSERT_NOT_REACHED();
-
-        m_scope_stack.last().variables.set(move(name), { js_undefined(), declaration_type });
+    case DeclarationType::Const: {
+        auto& scope = m_scope_stack.last();
+        auto index = scope.scope_node->variable_index(name);
+        ASSERT(index.has_value());
+        scope.variables[index.value()] = js_undefined();
         break;
     }
+    }
 }
 
 void Interpreter::set_variable(const FlyString& name, Value value, bool first_assignment)
@@ -133,12 +158,12 @@ void Interpreter::set_variable(const FlyString& name, Value value, bool first_as
     for (ssize_t i = m_scope_stack.size() - 1; i >= 0; --i) {
         auto& scope = m_scope_stack.at(i);
 
-        auto possible_match = scope.variables.get(name);
-        if (possible_match.has_value()) {
-            if (!first_assignment && possible_match.value().declaration_type == DeclarationType::Const)
+        auto index = scope.scope_node->variable_index(name);
+        if (index.has_value()) {
+            if (!first_assignment && scope.scope_node->variables()[index.value()].declaration_type == DeclarationType::Const)
                 ASSERT_NOT_REACHED();
 
-            scope.variables.set(move(name), { move(value), possible_match.value().declaration_type });
+            scope.variables[index.value()] = move(value);
             return;
         }
     }
@@ -146,6 +171,14 @@ void Interpreter::set_variable(const FlyString& name, Value value, bool first_as
     global_object().put(move(name), move(value));
 }
 
+void Interpreter::set_variable_in_slot(size_t depth, size_t index, Value value, bool first_assignment)
+{
+    auto& scope = m_scope_stack[m_scope_stack.size() - 1 - depth];
+    if (!first_assignment && scope.scope_node->variables()[index].declaration_type == DeclarationType::Const)
+        ASSERT_NOT_REACHED();
+    scope.variables[index] = move(value);
+}
+
 Optional<Value> Interpreter::get_variable(const FlyString& name)
 {
     if (name == "this")
@@ -153,9 +186,9 @@ Optional<Value> Interpreter::get_variable(const FlyString& name)
 
     for (ssize_t i = m_scope_stack.size() - 1; i >= 0; --i) {
         auto& scope = m_scope_stack.at(i);
-        auto value = scope.variables.get(name);
-        if (value.has_value())
-            return value.value().value;
+        auto index = scope.scope_node->variable_index(name);
+        if (index.has_value())
+            return scope.variables[index.value()];
     }
 
     return global_object().get(name);
@@ -175,9 +208,16 @@ void Interpreter::gather_roots(Badge<Heap>, HashTable<Cell*>& roots)
     roots.set(m_exception);
 
     for (auto& scope : m_scope_stack) {
-        for (auto& it : scope.variables) {
-            if (it.value.value.is_cell())
-                roots.set(it.value.value.as_cell());
+        for (auto& value : scope.variables) {
+            if (value.is_cell())
+                roots.set(value.as_cell());
+        }
+    }
+
+    for (auto* registers : m_register_windows) {
+        for (auto& value : *registers) {
+            if (value.is_cell())
+                roots.set(value.as_cell());
         }
     }
 
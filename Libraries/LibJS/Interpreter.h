@@ -33,6 +33,7 @@
 #include <LibJS/Forward.h>
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Runtime/Exception.h>
+#include <LibJS/Runtime/PropertyCache.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS {
@@ -45,15 +46,11 @@ enum class ScopeType {
     Breakable,
 };
 
-struct Variable {
-    Value value;
-    DeclarationType declaration_type;
-};
-
 struct ScopeFrame {
     ScopeType type;
     NonnullRefPtr<ScopeNode> scope_node;
-    HashMap<FlyString, Variable> variables;
+    // One value per ScopeNode::variables() entry.
+    Vector<Value> variables;
 };
 
 struct CallFrame {
@@ -85,6 +82,12 @@ public:
 
     Heap& heap() { return m_heap; }
 
+    bool is_bytecode_enabled() const { return m_bytecode_enabled; }
+    void set_bytecode_enabled(bool enabled) { m_bytecode_enabled = enabled; }
+
+    void push_register_window(Badge<Bytecode::Interpreter>, Vector<Value>& registers) { m_register_windows.append(&registers); }
+    void pop_register_window(Badge<Bytecode::Interpreter>) { m_register_windows.take_last(); }
+
     void unwind(ScopeType type) { m_unwind_until = type; }
     bool should_unwind() const { return m_unwind_until != ScopeType::None; }
 
@@ -92,6 +95,12 @@ public:
     void set_variable(const FlyString& name, Value, bool first_assignment = false);
     void declare_variable(const FlyString& name, DeclarationType);
 
+    Value get_variable_in_slot(size_t depth, size_t index) const
+    {
+        return m_scope_stack[m_scope_stack.size() - 1 - depth].variables[index];
+    }
+    void set_variable_in_slot(size_t depth, size_t index, Value, bool first_assignment = false);
+
     void gather_roots(Badge<Heap>, HashTable<Cell*>&);
 
     void enter_scope(const ScopeNode&, Vector<Argument>, ScopeType);
@@ -131,6 +140,10 @@ public:
 
     Shape* empty_object_shape() { return m_empty_object_shape; }
 
+    u64 property_cache_epoch() const { return m_property_cache_epoch; }
+    void invalidate_property_caches() { ++m_property_cache_epoch; }
+    PropertyCache::Statistics& property_cache_statistics() { return m_property_cache_statistics; }
+
     Object* string_prototype() { return m_string_prototype; }
     Object* object_prototype() { return m_object_prototype; }
     Object* array_prototype() { return m_array_prototype; }
@@ -159,6 +172,7 @@ private:
 
     Vector<ScopeFrame> m_scope_stack;
     Vector<CallFrame> m_call_stack;
+    Vector<Vector<Value>*> m_register_windows;
 
     Shape* m_empty_object_shape { nullptr };
 
@@ -172,6 +186,11 @@ private:
     Exception* m_exception { nullptr };
 
     ScopeType m_unwind_until { ScopeType::None };
+
+    u64 m_property_cache_epoch { 1 };
+    PropertyCache::Statistics m_property_cache_statistics;
+
+    bool m_bytecode_enabled { false };
 };
 
 }
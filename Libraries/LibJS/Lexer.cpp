@@ -32,9 +32,9 @@
 
 namespace JS {
 
-HashMap<String, TokenType> Lexer::s_keywords;
-HashMap<String, TokenType> Lexer::s_three_char_tokens;
-HashMap<String, TokenType> Lexer::s_two_char_tokens;
+HashMap<StringView, TokenType> Lexer::s_keywords;
+HashMap<StringView, TokenType> Lexer::s_three_char_tokens;
+HashMap<StringView, TokenType> Lexer::s_two_char_tokens;
 HashMap<char, TokenType> Lexer::s_single_char_tokens;
 
 Lexer::Lexer(StringView source)
@@ -273,8 +273,8 @@ Token Lexer::next()
         if (!found_four_char_token && m_position + 1 < m_source.length()) {
             char second_char = m_source[m_position];
             char third_char = m_source[m_position + 1];
-            char three_chars[] { (char)m_current_char, second_char, third_char, 0 };
-            auto it = s_three_char_tokens.find(three_chars);
+            char three_chars[] { (char)m_current_char, second_char, third_char };
+            auto it = s_three_char_tokens.find(StringView(three_chars, 3));
             if (it != s_three_char_tokens.end()) {
                 found_three_char_token = true;
                 consume();
@@ -287,8 +287,8 @@ Token Lexer::next()
         bool found_two_char_token = false;
         if (!found_four_char_token && !found_three_char_token && m_position < m_source.length()) {
             char second_char = m_source[m_position];
-            char two_chars[] { (char)m_current_char, second_char, 0 };
-            auto it = s_two_char_tokens.find(two_chars);
+            char two_chars[] { (char)m_current_char, second_char };
+            auto it = s_two_char_tokens.find(StringView(two_chars, 2));
             if (it != s_two_char_tokens.end()) {
                 found_two_char_token = true;
                 consume();
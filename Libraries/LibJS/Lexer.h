@@ -57,9 +57,9 @@ private:
     int m_current_char;
     bool m_has_errors = false;
 
-    static HashMap<String, TokenType> s_keywords;
-    static HashMap<String, TokenType> s_three_char_tokens;
-    static HashMap<String, TokenType> s_two_char_tokens;
+    static HashMap<StringView, TokenType> s_keywords;
+    static HashMap<StringView, TokenType> s_three_char_tokens;
+    static HashMap<StringView, TokenType> s_two_char_tokens;
     static HashMap<char, TokenType> s_single_char_tokens;
 };
 
@@ -25,6 +25,7 @@
  */
 
 #include "Parser.h"
+#include "ScopeResolver.h"
 #include <AK/HashMap.h>
 #include <AK/StdLibExtras.h>
 #include <stdio.h>
@@ -170,7 +171,7 @@ Associativity Parser::operator_associativity(TokenType type) const
 
 NonnullRefPtr<Program> Parser::parse_program()
 {
-    auto program = adopt(*new Program);
+    auto program = create_ast_node<Program>();
     while (!done()) {
         if (match(TokenType::Semicolon)) {
             consume();
@@ -181,6 +182,7 @@ NonnullRefPtr<Program> Parser::parse_program()
             consume();
         }
     }
+    ScopeResolver::resolve(program);
     return program;
 }
 
@@ -212,7 +214,7 @@ NonnullRefPtr<Statement> Parser::parse_statement()
         return parse_switch_statement();
     default:
         if (match_expression())
-            return adopt(*new ExpressionStatement(parse_expression(0)));
+            return create_ast_node<ExpressionStatement>(parse_expression(0));
         m_parser_state.m_has_errors = true;
         expected("statement (missing switch case)");
         consume();
@@ -279,7 +281,7 @@ RefPtr<FunctionExpression> Parser::try_parse_arrow_function_expression(bool expe
             // with a "body" property.
             auto return_expression = parse_expression(0);
             auto return_block = create_ast_node<BlockStatement>();
-            return_block->append<ReturnStatement>(move(return_expression));
+            return_block->append(create_ast_node<ReturnStatement>(move(return_expression)));
             return return_block;
         }
         // Invalid arrow function body
@@ -792,7 +794,11 @@ NonnullRefPtr<ForStatement> Parser::parse_for_statement()
 
     auto body = parse_block_statement();
 
-    return create_ast_node<ForStatement>(move(init), move(test), move(update), move(body));
+    RefPtr<BlockStatement> init_scope;
+    if (init && init->is_variable_declaration() && static_cast<const VariableDeclaration&>(*init).declaration_type() != DeclarationType::Var)
+        init_scope = create_ast_node<BlockStatement>();
+
+    return create_ast_node<ForStatement>(move(init), move(test), move(update), move(body), move(init_scope));
 }
 
 bool Parser::match(TokenType type) const
@@ -71,7 +71,15 @@ public:
 
     bool has_errors() const { return m_parser_state.m_has_errors; }
 
+    const ASTArena& arena() const { return m_arena; }
+
 private:
+    template<typename T, typename... Args>
+    NonnullRefPtr<T> create_ast_node(Args&&... args)
+    {
+        return JS::create_ast_node<T>(m_arena, forward<Args>(args)...);
+    }
+
     int operator_precedence(TokenType) const;
     Associativity operator_associativity(TokenType) const;
     bool match_expression() const;
@@ -97,5 +105,6 @@ private:
 
     ParserState m_parser_state;
     Optional<ParserState> m_saved_state;
+    ASTArena m_arena;
 };
 }
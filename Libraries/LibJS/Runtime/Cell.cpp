@@ -50,6 +50,12 @@ Interpreter& Cell::interpreter()
     return heap().interpreter();
 }
 
+void Cell::remember()
+{
+    m_remembered = true;
+    heap().did_remember_cell({}, *this);
+}
+
 const LogStream& operator<<(const LogStream& stream, const Cell* cell)
 {
     if (!cell)
@@ -45,6 +45,22 @@ public:
     bool is_live() const { return m_live; }
     void set_live(bool b) { m_live = b; }
 
+    // A cell becomes old once it has survived a garbage collection.
+    bool is_old() const { return m_old; }
+    void set_old(bool b) { m_old = b; }
+
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    // Call this after storing a pointer to |cell| inside this cell. Young
+    // collections don't trace through old cells, so an old cell that points
+    // to a young one has to be put in the heap's remembered set.
+    void write_barrier(const Cell* cell)
+    {
+        if (m_old && !m_remembered && cell && !cell->m_old)
+            remember();
+    }
+
     virtual const char* class_name() const = 0;
 
     class Visitor {
@@ -62,8 +78,12 @@ protected:
     Cell() {}
 
 private:
+    void remember();
+
     bool m_mark { false };
     bool m_live { true };
+    bool m_old { false };
+    bool m_remembered { false };
 };
 
 const LogStream& operator<<(const LogStream&, const Cell*);
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/QuickSort.h>
+#include <LibJS/Runtime/IndexedProperties.h>
+
+namespace JS {
+
+Optional<Value> IndexedProperties::get_sparse(u32 index) const
+{
+    return m_sparse_elements.get(index);
+}
+
+void IndexedProperties::put_slow(u32 index, Value value)
+{
+    if (m_kind != Kind::Sparse && index >= m_packed_elements.size() + max_holey_gap)
+        switch_to_sparse();
+
+    if (m_kind == Kind::Sparse) {
+        m_sparse_elements.set(index, value);
+        m_array_size = max(m_array_size, (size_t)index + 1);
+        return;
+    }
+
+    if (index > m_packed_elements.size())
+        m_kind = Kind::Holey;
+    if (index >= m_packed_elements.size()) {
+        m_packed_elements.ensure_capacity(index + 1);
+        while (m_packed_elements.size() < index)
+            m_packed_elements.unchecked_append(Value(Value::Type::Empty));
+        m_packed_elements.unchecked_append(value);
+        m_array_size = m_packed_elements.size();
+        return;
+    }
+    m_packed_elements[index] = value;
+}
+
+void IndexedProperties::append(Value value)
+{
+    if (m_kind == Kind::Sparse) {
+        put_slow(m_array_size, value);
+        return;
+    }
+    m_packed_elements.append(value);
+    m_array_size = m_packed_elements.size();
+}
+
+Value IndexedProperties::take_first()
+{
+    if (m_array_size == 0)
+        return js_undefined();
+
+    if (m_kind != Kind::Sparse) {
+        auto value = m_packed_elements.take_first();
+        m_array_size = m_packed_elements.size();
+        return value.is_empty() ? js_undefined() : value;
+    }
+
+    auto value = get_sparse(0).value_or(js_undefined());
+    HashMap<u32, Value> shifted_elements;
+    for (auto& it : m_sparse_elements) {
+        if (it.key != 0)
+            shifted_elements.set(it.key - 1, it.value);
+    }
+    m_sparse_elements = move(shifted_elements);
+    --m_array_size;
+    return value;
+}
+
+Value IndexedProperties::take_last()
+{
+    if (m_array_size == 0)
+        return js_undefined();
+
+    if (m_kind != Kind::Sparse) {
+        auto value = m_packed_elements.take_last();
+        m_array_size = m_packed_elements.size();
+        return value.is_empty() ? js_undefined() : value;
+    }
+
+    --m_array_size;
+    auto value = get_sparse(m_array_size).value_or(js_undefined());
+    m_sparse_elements.remove(m_array_size);
+    return value;
+}
+
+Vector<u32> IndexedProperties::indices() const
+{
+    Vector<u32> indices;
+    if (m_kind == Kind::Sparse) {
+        for (auto& it : m_sparse_elements)
+            indices.append(it.key);
+        quick_sort(indices.data(), indices.data() + indices.size());
+        return indices;
+    }
+    for (size_t i = 0; i < m_packed_elements.size(); ++i) {
+        if (!m_packed_elements[i].is_empty())
+            indices.append(i);
+    }
+    return indices;
+}
+
+void IndexedProperties::switch_to_sparse()
+{
+    for (size_t i = 0; i < m_packed_elements.size(); ++i) {
+        if (!m_packed_elements[i].is_empty())
+            m_sparse_elements.set(i, m_packed_elements[i]);
+    }
+    m_packed_elements.clear();
+    m_kind = Kind::Sparse;
+}
+
+}
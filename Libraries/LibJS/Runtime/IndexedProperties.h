@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS {
+
+// Storage for the integer-indexed properties ("elements") of an Object.
+//
+// Elements start out Packed: a Vector with no holes. A store past the end
+// makes them Holey, with the gap filled by empty values. A store so far past
+// the end that filling the gap would waste a lot of memory (e.g. a[1e9] = 1)
+// moves everything into a HashMap, and the elements stay Sparse from then on.
+class IndexedProperties {
+public:
+    enum class Kind {
+        Packed,
+        Holey,
+        Sparse,
+    };
+
+    // Index stores at least this far past the end switch to sparse storage.
+    static constexpr size_t max_holey_gap = 1024;
+
+    Kind kind() const { return m_kind; }
+    bool is_empty() const { return m_array_size == 0; }
+
+    // One more than the highest index that was stored to, i.e. an Array's "length".
+    size_t array_like_size() const { return m_array_size; }
+
+    Optional<Value> get(u32 index) const
+    {
+        if (m_kind != Kind::Sparse) {
+            if (index >= m_packed_elements.size())
+                return {};
+            auto value = m_packed_elements[index];
+            if (value.is_empty())
+                return {};
+            return value;
+        }
+        return get_sparse(index);
+    }
+
+    void put(u32 index, Value value)
+    {
+        if (m_kind == Kind::Packed && index < m_packed_elements.size()) {
+            m_packed_elements[index] = value;
+            return;
+        }
+        put_slow(index, value);
+    }
+
+    void append(Value);
+    Value take_first();
+    Value take_last();
+
+    template<typename Callback>
+    void for_each_value(Callback callback) const
+    {
+        if (m_kind == Kind::Sparse) {
+            for (auto& it : m_sparse_elements)
+                callback(it.value);
+            return;
+        }
+        for (auto& value : m_packed_elements) {
+            if (!value.is_empty())
+                callback(value);
+        }
+    }
+
+    // The indices that hold a value, in ascending order.
+    Vector<u32> indices() const;
+
+private:
+    Optional<Value> get_sparse(u32 index) const;
+    void put_slow(u32 index, Value);
+    void switch_to_sparse();
+
+    Kind m_kind { Kind::Packed };
+    size_t m_array_size { 0 };
+    Vector<Value> m_packed_elements;
+    HashMap<u32, Value> m_sparse_elements;
+};
+
+}
@@ -36,10 +36,36 @@
 
 namespace JS {
 
+// Property names like "3" refer to the indexed properties. Names that merely
+// parse as a number (like "03" or "-1") are ordinary named properties.
+static Optional<u32> property_name_to_index(const FlyString& property_name)
+{
+    auto length = property_name.length();
+    if (length == 0 || length > 10)
+        return {};
+    auto* characters = property_name.characters();
+    if (characters[0] == '0' && length > 1)
+        return {};
+    u64 index = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (characters[i] < '0' || characters[i] > '9')
+            return {};
+        index = index * 10 + (characters[i] - '0');
+    }
+    if (index >= 4294967295)
+        return {};
+    return (u32)index;
+}
+
 Object::Object()
 {
     m_shape = interpreter().empty_object_shape();
-    m_shape->set_prototype_without_transition(interpreter().object_prototype());
+    if (auto* object_prototype = interpreter().object_prototype(); m_shape->prototype() != object_prototype) {
+        m_shape->set_prototype_without_transition(object_prototype);
+        if (object_prototype)
+            object_prototype->m_is_used_as_prototype = true;
+        interpreter().invalidate_property_caches();
+    }
 }
 
 Object::~Object()
@@ -58,7 +84,18 @@ const Object* Object::prototype() const
 
 void Object::set_prototype(Object* new_prototype)
 {
+    if (new_prototype)
+        new_prototype->m_is_used_as_prototype = true;
     m_shape = m_shape->create_prototype_transition(new_prototype);
+    write_barrier(m_shape);
+    invalidate_property_caches_if_prototype();
+}
+
+void Object::invalidate_property_caches_if_prototype()
+{
+    // Property caches may have looked through this object on the way up the prototype chain.
+    if (m_is_used_as_prototype)
+        interpreter().invalidate_property_caches();
 }
 
 bool Object::has_prototype(const Object* prototype) const
@@ -72,11 +109,18 @@ bool Object::has_prototype(const Object* prototype) const
 
 Optional<Value> Object::get_own_property(const Object& this_object, const FlyString& property_name) const
 {
+    if (auto index = property_name_to_index(property_name); index.has_value())
+        return m_indexed_properties.get(index.value());
+
     auto metadata = shape().lookup(property_name);
     if (!metadata.has_value())
         return {};
+    return get_own_property_at(this_object, metadata.value().offset);
+}
 
-    auto value_here = m_storage[metadata.value().offset];
+Value Object::get_own_property_at(const Object& this_object, size_t offset) const
+{
+    auto value_here = m_storage[offset];
     if (value_here.is_object() && value_here.as_object().is_native_property()) {
         auto& native_property = static_cast<const NativeProperty&>(value_here.as_object());
         auto& interpreter = const_cast<Object*>(this)->interpreter();
@@ -93,10 +137,17 @@ void Object::set_shape(Shape& new_shape)
 {
     m_storage.resize(new_shape.property_count());
     m_shape = &new_shape;
+    write_barrier(m_shape);
+    invalidate_property_caches_if_prototype();
 }
 
 bool Object::put_own_property(Object& this_object, const FlyString& property_name, Value value)
 {
+    if (auto index = property_name_to_index(property_name); index.has_value()) {
+        put_by_index(index.value(), value);
+        return true;
+    }
+
     auto metadata = shape().lookup(property_name);
     if (!metadata.has_value()) {
         auto* new_shape = m_shape->create_put_transition(property_name, 0);
@@ -114,13 +165,16 @@ bool Object::put_own_property(Object& this_object, const FlyString& property_nam
         native_property.set(interpreter, value);
         interpreter.pop_call_frame();
     } else {
-        m_storage[metadata.value().offset] = value;
+        put_direct(metadata.value().offset, value);
     }
     return true;
 }
 
 Optional<Value> Object::get(const FlyString& property_name) const
 {
+    if (auto index = property_name_to_index(property_name); index.has_value())
+        return get_by_index(index.value());
+
     const Object* object = this;
     while (object) {
         auto value = object->get_own_property(*this, property_name);
@@ -133,6 +187,11 @@ Optional<Value> Object::get(const FlyString& property_name) const
 
 void Object::put(const FlyString& property_name, Value value)
 {
+    if (auto index = property_name_to_index(property_name); index.has_value()) {
+        put_by_index(index.value(), value);
+        return;
+    }
+
     // If there's a setter in the prototype chain, we go to the setter.
     // Otherwise, it goes in the own property storage.
     Object* object = this;
@@ -155,6 +214,39 @@ void Object::put(const FlyString& property_name, Value value)
     put_own_property(*this, property_name, value);
 }
 
+Optional<Value> Object::get_by_index(u32 index) const
+{
+    for (auto* object = this; object; object = object->prototype()) {
+        auto value = object->m_indexed_properties.get(index);
+        if (value.has_value())
+            return value;
+    }
+    return {};
+}
+
+void Object::put_by_index(u32 index, Value value)
+{
+    // Indexed properties can't have native setters, so this always stores into our own elements.
+    m_indexed_properties.put(index, value);
+    write_barrier(value);
+}
+
+Optional<Value> Object::get_computed(Value key) const
+{
+    if (key.is_array_index())
+        return get_by_index(key.as_array_index());
+    return get(key.to_string());
+}
+
+void Object::put_computed(Value key, Value value)
+{
+    if (key.is_array_index()) {
+        put_by_index(key.as_array_index(), value);
+        return;
+    }
+    put(key.to_string(), value);
+}
+
 void Object::put_native_function(const FlyString& property_name, AK::Function<Value(Interpreter&)> native_function)
 {
     put(property_name, heap().allocate<NativeFunction>(move(native_function)));
@@ -163,16 +255,24 @@ void Object::put_native_function(const FlyString& property_name, AK::Function<Va
 void Object::put_native_property(const FlyString& property_name, AK::Function<Value(Interpreter&)> getter, AK::Function<void(Interpreter&, Value)> setter)
 {
     put(property_name, heap().allocate<NativeProperty>(move(getter), move(setter)));
+    invalidate_property_caches_if_prototype();
 }
 
 void Object::visit_children(Cell::Visitor& visitor)
 {
     Cell::visit_children(visitor);
     visitor.visit(m_shape);
+    for (auto& value : m_storage)
+        visitor.visit(value);
+    m_indexed_properties.for_each_value([&](auto& value) {
+        visitor.visit(value);
+    });
 }
 
 bool Object::has_own_property(const FlyString& property_name) const
 {
+    if (auto index = property_name_to_index(property_name); index.has_value())
+        return m_indexed_properties.get(index.value()).has_value();
     return shape().lookup(property_name).has_value();
 }
 
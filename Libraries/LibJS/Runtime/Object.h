@@ -30,6 +30,7 @@
 #include <AK/String.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Runtime/Cell.h>
+#include <LibJS/Runtime/IndexedProperties.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/Value.h>
 
@@ -46,6 +47,17 @@ public:
     Optional<Value> get(const FlyString& property_name) const;
     void put(const FlyString& property_name, Value);
 
+    Optional<Value> get_by_index(u32 index) const;
+    void put_by_index(u32 index, Value);
+
+    // For a[key]: goes straight to the indexed properties if the key is an array index,
+    // and only converts it to a property name otherwise.
+    Optional<Value> get_computed(Value key) const;
+    void put_computed(Value key, Value);
+
+    IndexedProperties& indexed_properties() { return m_indexed_properties; }
+    const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
+
     virtual Optional<Value> get_own_property(const Object& this_object, const FlyString& property_name) const;
     virtual bool put_own_property(Object& this_object, const FlyString& property_name, Value);
 
@@ -63,10 +75,18 @@ public:
     virtual const char* class_name() const override { return "Object"; }
     virtual void visit_children(Cell::Visitor&) override;
 
+    using Cell::write_barrier;
+    void write_barrier(Value value)
+    {
+        if (value.is_cell())
+            Cell::write_barrier(value.as_cell());
+    }
+
     Object* prototype();
     const Object* prototype() const;
     void set_prototype(Object*);
     bool has_prototype(const Object* prototype) const;
+    bool is_used_as_prototype() const { return m_is_used_as_prototype; }
 
     bool has_own_property(const FlyString& property_name) const;
     enum class PreferredType {
@@ -80,12 +100,25 @@ public:
     virtual Value to_string() const;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value)
+    {
+        m_storage[index] = value;
+        write_barrier(value);
+    }
+
+    // Like get_own_property(), but for a property whose offset is already known.
+    Value get_own_property_at(const Object& this_object, size_t offset) const;
 
 private:
+    friend class PropertyCache;
+
     void set_shape(Shape&);
+    void invalidate_property_caches_if_prototype();
 
     Shape* m_shape { nullptr };
     Vector<Value> m_storage;
+    IndexedProperties m_indexed_properties;
+    bool m_is_used_as_prototype { false };
 };
 
 }
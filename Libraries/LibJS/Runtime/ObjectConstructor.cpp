@@ -64,11 +64,8 @@ Value ObjectConstructor::get_own_property_names(Interpreter& interpreter)
     if (interpreter.exception())
         return {};
     auto* result = interpreter.heap().allocate<Array>();
-    if (object->is_array()) {
-        auto* array = static_cast<const Array*>(object);
-        for (i32 i = 0; i < array->length(); ++i)
-            result->push(js_string(interpreter.heap(), String::number(i)));
-    }
+    for (auto index : object->indexed_properties().indices())
+        result->push(js_string(interpreter.heap(), String::number(index)));
     for (auto& it : object->shape().property_table())
         result->push(js_string(interpreter.heap(), it.key));
     return result;
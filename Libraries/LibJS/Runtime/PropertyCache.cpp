@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/PropertyCache.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS {
+
+static bool is_native_property(Value value)
+{
+    return value.is_object() && value.as_object().is_native_property();
+}
+
+PropertyCache::Entry& PropertyCache::entry_for_fill(const Shape& shape, u64 epoch)
+{
+    for (auto& entry : m_entries) {
+        if (entry.shape == &shape || entry.epoch != epoch)
+            return entry;
+    }
+    auto& entry = m_entries[m_next_victim];
+    m_next_victim = (m_next_victim + 1) % max_entries;
+    return entry;
+}
+
+Optional<Value> PropertyCache::get(Object& object, const FlyString& property_name)
+{
+    auto& interpreter = object.interpreter();
+    auto& statistics = interpreter.property_cache_statistics();
+    auto epoch = interpreter.property_cache_epoch();
+    auto& shape = object.shape();
+
+    for (auto& entry : m_entries) {
+        if (entry.shape != &shape || entry.epoch != epoch)
+            continue;
+        ++statistics.get_hits;
+        auto* holder = entry.holder ? entry.holder : &object;
+        return holder->get_own_property_at(object, entry.offset);
+    }
+
+    ++statistics.get_misses;
+    for (auto* holder = &object; holder; holder = holder->prototype()) {
+        auto metadata = holder->shape().lookup(property_name);
+        if (!metadata.has_value())
+            continue;
+        auto& entry = entry_for_fill(shape, epoch);
+        entry = { &shape, holder == &object ? nullptr : holder, nullptr, (u32)metadata.value().offset, epoch };
+        return holder->get_own_property_at(object, metadata.value().offset);
+    }
+    return {};
+}
+
+void PropertyCache::put(Object& object, const FlyString& property_name, Value value)
+{
+    auto& interpreter = object.interpreter();
+    auto& statistics = interpreter.property_cache_statistics();
+    auto epoch = interpreter.property_cache_epoch();
+    auto& shape = object.shape();
+
+    for (auto& entry : m_entries) {
+        if (entry.shape != &shape || entry.epoch != epoch)
+            continue;
+        if (entry.new_shape) {
+            object.set_shape(*entry.new_shape);
+        } else if (is_native_property(object.get_direct(entry.offset))) {
+            // Shapes don't know about native properties, so objects of the same
+            // shape may have a setter here; let the slow path handle it.
+            break;
+        }
+        ++statistics.put_hits;
+        object.put_direct(entry.offset, value);
+        return;
+    }
+
+    ++statistics.put_misses;
+
+    // A native property anywhere on the prototype chain takes the put (see Object::put()).
+    for (auto* holder = &object; holder; holder = holder->prototype()) {
+        auto metadata = holder->shape().lookup(property_name);
+        if (metadata.has_value() && is_native_property(holder->get_direct(metadata.value().offset))) {
+            object.put(property_name, value);
+            return;
+        }
+    }
+
+    auto metadata = shape.lookup(property_name);
+    if (metadata.has_value()) {
+        auto& entry = entry_for_fill(shape, epoch);
+        entry = { &shape, nullptr, nullptr, (u32)metadata.value().offset, epoch };
+        object.put_direct(metadata.value().offset, value);
+        return;
+    }
+
+    object.put(property_name, value);
+
+    // Adding a property to a prototype invalidates every cache, including this one.
+    epoch = interpreter.property_cache_epoch();
+    metadata = object.shape().lookup(property_name);
+    if (!metadata.has_value() || &object.shape() == &shape)
+        return;
+    auto& entry = entry_for_fill(shape, epoch);
+    entry = { &shape, nullptr, &object.shape(), (u32)metadata.value().offset, epoch };
+}
+
+}
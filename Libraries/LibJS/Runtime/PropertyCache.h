@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS {
+
+// A polymorphic inline cache for accessing a named property at one site in
+// the program. Each entry remembers where the property was found for objects
+// of one Shape, so a hit costs a Shape compare and an indexed load/store.
+//
+// Entries are tagged with Interpreter::property_cache_epoch(), which is bumped
+// whenever a cached answer may have become wrong: when an object that serves
+// as a prototype changes its properties or its own prototype, and on every
+// garbage collection (since Shapes may be freed and their addresses reused).
+class PropertyCache {
+public:
+    static constexpr size_t max_entries = 4;
+
+    struct Statistics {
+        size_t get_hits { 0 };
+        size_t get_misses { 0 };
+        size_t put_hits { 0 };
+        size_t put_misses { 0 };
+    };
+
+    Optional<Value> get(Object&, const FlyString& property_name);
+    void put(Object&, const FlyString& property_name, Value);
+
+private:
+    struct Entry {
+        const Shape* shape { nullptr };
+        // For gets: the prototype that holds the property, or nullptr if the object itself does.
+        Object* holder { nullptr };
+        // For puts that add a property: the shape the object transitions to.
+        Shape* new_shape { nullptr };
+        u32 offset { 0 };
+        u64 epoch { 0 };
+    };
+
+    Entry& entry_for_fill(const Shape&, u64 epoch);
+
+    Entry m_entries[max_entries];
+    u8 m_next_victim { 0 };
+};
+
+}
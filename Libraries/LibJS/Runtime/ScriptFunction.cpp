@@ -25,6 +25,8 @@
  */
 
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/ScriptFunction.h>
 #include <LibJS/Runtime/Value.h>
@@ -44,6 +46,16 @@ ScriptFunction::~ScriptFunction()
 Value ScriptFunction::call(Interpreter& interpreter)
 {
     auto& argument_values = interpreter.call_frame().arguments;
+
+    if (interpreter.is_bytecode_enabled()) {
+        if (!m_tried_to_generate_bytecode) {
+            m_bytecode_executable = Bytecode::Generator::generate_function(m_body, m_parameters);
+            m_tried_to_generate_bytecode = true;
+        }
+        if (m_bytecode_executable)
+            return Bytecode::Interpreter(interpreter).run(*m_bytecode_executable, argument_values);
+    }
+
     Vector<Argument> arguments;
     for (size_t i = 0; i < m_parameters.size(); ++i) {
         auto name = parameters()[i];
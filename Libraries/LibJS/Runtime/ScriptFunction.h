@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/OwnPtr.h>
+#include <LibJS/Bytecode/Executable.h>
 #include <LibJS/Runtime/Function.h>
 
 namespace JS {
@@ -47,6 +49,9 @@ private:
 
     NonnullRefPtr<ScopeNode> m_body;
     const Vector<FlyString> m_parameters;
+
+    OwnPtr<Bytecode::Executable> m_bytecode_executable;
+    bool m_tried_to_generate_bytecode { false };
 };
 
 }
@@ -1,4 +1,5 @@
 #include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Object.h>
 #include <LibJS/Runtime/Shape.h>
 
 namespace JS {
@@ -10,12 +11,27 @@ Shape* Shape::create_put_transition(const FlyString& property_name, u8 property_
         return new_shape;
     new_shape = heap().allocate<Shape>(this, property_name, property_attributes);
     m_forward_transitions.set(property_name, new_shape);
+    write_barrier(new_shape);
     return new_shape;
 }
 
 Shape* Shape::create_prototype_transition(Object* new_prototype)
 {
-    return heap().allocate<Shape>(this, new_prototype);
+    if (auto existing_shape = m_prototype_transitions.get(new_prototype); existing_shape.has_value())
+        return existing_shape.value();
+    auto* new_shape = heap().allocate<Shape>(this, new_prototype);
+    if (!m_has_prototype_transitions) {
+        heap().did_create_prototype_transitions({}, *this);
+        m_has_prototype_transitions = true;
+    }
+    m_prototype_transitions.set(new_prototype, new_shape);
+    return new_shape;
+}
+
+void Shape::set_prototype_without_transition(Object* new_prototype)
+{
+    m_prototype = new_prototype;
+    write_barrier(new_prototype);
 }
 
 Shape::Shape()
@@ -38,6 +54,8 @@ Shape::Shape(Shape* previous_shape, Object* new_prototype)
 
 Shape::~Shape()
 {
+    if (m_has_prototype_transitions)
+        heap().did_destroy_prototype_transitions({}, *this);
 }
 
 void Shape::visit_children(Cell::Visitor& visitor)
@@ -49,6 +67,7 @@ void Shape::visit_children(Cell::Visitor& visitor)
         visitor.visit(m_previous);
     for (auto& it : m_forward_transitions)
         visitor.visit(it.value);
+    // NOTE: Prototype transitions are weak, see Heap::remove_dead_prototype_transitions().
 }
 
 Optional<PropertyMetadata> Shape::lookup(const FlyString& property_name) const
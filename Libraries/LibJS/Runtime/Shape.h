@@ -26,9 +26,11 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
 #include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Runtime/Cell.h>
 #include <LibJS/Runtime/Value.h>
@@ -58,7 +60,19 @@ public:
     const HashMap<FlyString, PropertyMetadata>& property_table() const;
     size_t property_count() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype);
+
+    template<typename Callback>
+    void remove_prototype_transitions_if(Badge<Heap>, Callback callback)
+    {
+        Vector<Object*, 8> dead_prototypes;
+        for (auto& it : m_prototype_transitions) {
+            if (callback(it.key, it.value))
+                dead_prototypes.append(it.key);
+        }
+        for (auto* prototype : dead_prototypes)
+            m_prototype_transitions.remove(prototype);
+    }
 
 private:
     virtual const char* class_name() const override { return "Shape"; }
@@ -69,6 +83,9 @@ private:
     mutable OwnPtr<HashMap<FlyString, PropertyMetadata>> m_property_table;
 
     HashMap<FlyString, Shape*> m_forward_transitions;
+    // Neither the prototypes nor the shapes they lead to are kept alive by this, the heap removes dead ones before sweeping.
+    HashMap<Object*, Shape*> m_prototype_transitions;
+    bool m_has_prototype_transitions { false };
     Shape* m_previous { nullptr };
     FlyString m_property_name;
     u8 m_property_attributes { 0 };
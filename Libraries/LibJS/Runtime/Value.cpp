@@ -70,18 +70,18 @@ String Value::to_string() const
         return as_object().to_primitive(Object::PreferredType::String).to_string();
 
     if (is_string())
-        return m_value.as_string->string();
+        return as_string()->string();
 
     ASSERT_NOT_REACHED();
 }
 
 bool Value::to_boolean() const
 {
-    switch (m_type) {
+    switch (type()) {
     case Type::Boolean:
-        return m_value.as_bool;
+        return as_bool();
     case Type::Number:
-        return !(m_value.as_double == 0 || m_value.as_double == -0);
+        return !(as_double() == 0 || as_double() == -0);
     case Type::Null:
     case Type::Undefined:
         return false;
@@ -100,7 +100,7 @@ Object* Value::to_object(Heap& heap) const
         return &const_cast<Object&>(as_object());
 
     if (is_string())
-        return heap.allocate<StringObject>(m_value.as_string);
+        return heap.allocate<StringObject>(const_cast<PrimitiveString*>(as_string()));
 
     if (is_null() || is_undefined()) {
         heap.interpreter().throw_exception<Error>("TypeError", "ToObject on null or undefined.");
@@ -112,11 +112,11 @@ Object* Value::to_object(Heap& heap) const
 
 Value Value::to_number() const
 {
-    switch (m_type) {
+    switch (type()) {
     case Type::Boolean:
-        return Value(m_value.as_bool ? 1 : 0);
+        return Value(as_bool() ? 1 : 0);
     case Type::Number:
-        return Value(m_value.as_double);
+        return Value(as_double());
     case Type::Null:
         return Value(0);
     case Type::String: {
@@ -134,16 +134,18 @@ Value Value::to_number() const
     case Type::Undefined:
         return js_nan();
     case Type::Object:
-        if (m_value.as_object->is_array()) {
-            auto& array = *static_cast<Array*>(m_value.as_object);
+        if (as_object().is_array()) {
+            auto& array = static_cast<const Array&>(as_object());
             if (array.length() == 0)
                 return Value(0);
             if (array.length() > 1)
                 return js_nan();
-            return array.elements()[0].to_number();
+            return array.indexed_properties().get(0).value_or(js_undefined()).to_number();
         } else {
-            return m_value.as_object->to_primitive(Object::PreferredType::Number).to_number();
+            return as_object().to_primitive(Object::PreferredType::Number).to_number();
         }
+    case Type::Empty:
+        break;
     }
 
     ASSERT_NOT_REACHED();
@@ -257,6 +259,8 @@ Value typed_eq(Value lhs, Value rhs)
         return Value(lhs.as_bool() == rhs.as_bool());
     case Value::Type::Object:
         return Value(&lhs.as_object() == &rhs.as_object());
+    case Value::Type::Empty:
+        break;
     }
 
     ASSERT_NOT_REACHED();
@@ -303,6 +307,30 @@ Value instance_of(Value lhs, Value rhs)
     return Value(lhs.as_object().has_prototype(&constructor_prototype_property.value().as_object()));
 }
 
+Value js_typeof(Heap& heap, Value value)
+{
+    switch (value.type()) {
+    case Value::Type::Undefined:
+        return js_string(heap, "undefined");
+    case Value::Type::Null:
+        // yes, this is on purpose. yes, this is how javascript works.
+        // yes, it's silly.
+        return js_string(heap, "object");
+    case Value::Type::Number:
+        return js_string(heap, "number");
+    case Value::Type::String:
+        return js_string(heap, "string");
+    case Value::Type::Object:
+        return js_string(heap, "object");
+    case Value::Type::Boolean:
+        return js_string(heap, "boolean");
+    case Value::Type::Empty:
+        break;
+    }
+
+    ASSERT_NOT_REACHED();
+}
+
 const LogStream& operator<<(const LogStream& stream, const Value& value)
 {
     return stream << value.to_string();
@@ -33,9 +33,17 @@
 
 namespace JS {
 
+// Values are normally a Type tag plus a union, which is 16 bytes with padding.
+// Building with JS_VALUE_NAN_BOXING defined packs them into 8 bytes instead:
+// doubles are stored as-is (with every NaN canonicalized to one bit pattern),
+// and all other types live in the payload of negative quiet NaNs, which no
+// double we store can have. The top 16 bits hold 0xfff8 plus a 3-bit tag,
+// and the low 48 bits hold the boolean or the Cell pointer.
 class Value {
 public:
     enum class Type {
+        // Marks a hole in element storage. Never visible to scripts.
+        Empty,
         Undefined,
         Null,
         Number,
@@ -44,100 +52,130 @@ public:
         Boolean,
     };
 
-    bool is_undefined() const { return m_type == Type::Undefined; }
-    bool is_null() const { return m_type == Type::Null; }
-    bool is_number() const { return m_type == Type::Number; }
-    bool is_string() const { return m_type == Type::String; }
-    bool is_object() const { return m_type == Type::Object; }
-    bool is_boolean() const { return m_type == Type::Boolean; }
+#ifdef JS_VALUE_NAN_BOXING
+    static constexpr u64 nan_box_prefix = 0xfff8000000000000;
+    static constexpr u64 nan_box_tag_mask = 0xffff000000000000;
+    static constexpr u64 nan_box_payload_mask = 0x0000ffffffffffff;
+    static constexpr u64 canonical_nan = 0x7ff8000000000000;
+#endif
+
+    bool is_empty() const { return has_type(Type::Empty); }
+    bool is_undefined() const { return has_type(Type::Undefined); }
+    bool is_null() const { return has_type(Type::Null); }
+    bool is_number() const { return has_type(Type::Number); }
+    bool is_string() const { return has_type(Type::String); }
+    bool is_object() const { return has_type(Type::Object); }
+    bool is_boolean() const { return has_type(Type::Boolean); }
     bool is_cell() const { return is_string() || is_object(); }
     bool is_array() const;
 
+    // Whether this is a number that can be used directly as an element index, e.g. the 3 in a[3].
+    bool is_array_index() const
+    {
+        if (!is_number())
+            return false;
+        auto number = decode_double();
+        return number >= 0 && number < 4294967295.0 && number == (double)(u32)number;
+    }
+
     bool is_nan() const { return is_number() && __builtin_isnan(as_double()); }
     bool is_infinity() const { return is_number() && __builtin_isinf(as_double()); }
 
     Value()
-        : m_type(Type::Undefined)
     {
+        encode_type(Type::Undefined);
     }
 
     explicit Value(bool value)
-        : m_type(Type::Boolean)
     {
-        m_value.as_bool = value;
+        encode_bool(value);
     }
 
     explicit Value(double value)
-        : m_type(Type::Number)
     {
-        m_value.as_double = value;
+        encode_double(value);
     }
 
     explicit Value(i32 value)
-        : m_type(Type::Number)
     {
-        m_value.as_double = value;
+        encode_double(value);
     }
 
     Value(Object* object)
-        : m_type(object ? Type::Object : Type::Null)
     {
-        m_value.as_object = object;
+        if (object)
+            encode_cell(Type::Object, reinterpret_cast<Cell*>(object));
+        else
+            encode_type(Type::Null);
     }
 
     Value(PrimitiveString* string)
-        : m_type(Type::String)
     {
-        m_value.as_string = string;
+        encode_cell(Type::String, reinterpret_cast<Cell*>(string));
     }
 
     explicit Value(Type type)
-        : m_type(type)
     {
+        encode_type(type);
     }
 
+#ifdef JS_VALUE_NAN_BOXING
+    Type type() const
+    {
+        if ((m_bits & nan_box_prefix) != nan_box_prefix)
+            return Type::Number;
+        return static_cast<Type>(((m_bits >> 48) & 7) - 1);
+    }
+#else
     Type type() const { return m_type; }
+#endif
 
     double as_double() const
     {
         ASSERT(type() == Type::Number);
-        return m_value.as_double;
+        return decode_double();
+    }
+
+    u32 as_array_index() const
+    {
+        ASSERT(is_array_index());
+        return (u32)decode_double();
     }
 
     bool as_bool() const
     {
         ASSERT(type() == Type::Boolean);
-        return m_value.as_bool;
+        return decode_bool();
     }
 
     Object& as_object()
     {
         ASSERT(type() == Type::Object);
-        return *m_value.as_object;
+        return *reinterpret_cast<Object*>(decode_cell());
     }
 
     const Object& as_object() const
     {
         ASSERT(type() == Type::Object);
-        return *m_value.as_object;
+        return *reinterpret_cast<const Object*>(decode_cell());
     }
 
     PrimitiveString* as_string()
     {
         ASSERT(is_string());
-        return m_value.as_string;
+        return reinterpret_cast<PrimitiveString*>(decode_cell());
     }
 
     const PrimitiveString* as_string() const
     {
         ASSERT(is_string());
-        return m_value.as_string;
+        return reinterpret_cast<const PrimitiveString*>(decode_cell());
     }
 
     Cell* as_cell()
     {
         ASSERT(is_cell());
-        return m_value.as_cell;
+        return decode_cell();
     }
 
     String to_string() const;
@@ -148,17 +186,75 @@ public:
     Object* to_object(Heap&) const;
 
 private:
+#ifdef JS_VALUE_NAN_BOXING
+    static constexpr u64 tag_for_type(Type type) { return nan_box_prefix | (((u64)type + 1) << 48); }
+
+    bool has_type(Type type) const
+    {
+        if (type == Type::Number)
+            return (m_bits & nan_box_prefix) != nan_box_prefix;
+        return (m_bits & nan_box_tag_mask) == tag_for_type(type);
+    }
+
+    void encode_type(Type type) { m_bits = type == Type::Number ? 0 : tag_for_type(type); }
+    void encode_bool(bool value) { m_bits = tag_for_type(Type::Boolean) | value; }
+    void encode_cell(Type type, Cell* cell) { m_bits = tag_for_type(type) | ((u64)(FlatPtr)cell & nan_box_payload_mask); }
+    void encode_double(double value)
+    {
+        if (__builtin_isnan(value))
+            m_bits = canonical_nan;
+        else
+            __builtin_memcpy(&m_bits, &value, sizeof(m_bits));
+    }
+
+    double decode_double() const
+    {
+        double value;
+        __builtin_memcpy(&value, &m_bits, sizeof(value));
+        return value;
+    }
+    bool decode_bool() const { return m_bits & 1; }
+    Cell* decode_cell() const { return reinterpret_cast<Cell*>((FlatPtr)(m_bits & nan_box_payload_mask)); }
+
+    u64 m_bits { 0 };
+#else
+    bool has_type(Type type) const { return m_type == type; }
+
+    void encode_type(Type type) { m_type = type; }
+    void encode_bool(bool value)
+    {
+        m_type = Type::Boolean;
+        m_value.as_bool = value;
+    }
+    void encode_cell(Type type, Cell* cell)
+    {
+        m_type = type;
+        m_value.as_cell = cell;
+    }
+    void encode_double(double value)
+    {
+        m_type = Type::Number;
+        m_value.as_double = value;
+    }
+
+    double decode_double() const { return m_value.as_double; }
+    bool decode_bool() const { return m_value.as_bool; }
+    Cell* decode_cell() const { return m_value.as_cell; }
+
     Type m_type { Type::Undefined };
 
     union {
         bool as_bool;
         double as_double;
-        PrimitiveString* as_string;
-        Object* as_object;
         Cell* as_cell;
     } m_value;
+#endif
 };
 
+#ifdef JS_VALUE_NAN_BOXING
+static_assert(sizeof(Value) == 8);
+#endif
+
 inline Value js_undefined()
 {
     return Value(Value::Type::Undefined);
@@ -198,6 +294,7 @@ Value div(Value lhs, Value rhs);
 Value eq(Value lhs, Value rhs);
 Value typed_eq(Value lhs, Value rhs);
 Value instance_of(Value lhs, Value rhs);
+Value js_typeof(Heap&, Value);
 
 const LogStream& operator<<(const LogStream&, const Value&);
 
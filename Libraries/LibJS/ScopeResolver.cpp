@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/ScopeResolver.h>
+
+namespace JS {
+
+void ScopeResolver::resolve(Program& program)
+{
+    ScopeResolver resolver;
+    program.resolve(resolver);
+    ASSERT(!resolver.m_current_scope);
+    resolver.resolve_references();
+}
+
+void ScopeResolver::enter_scope(ScopeNode& node, ScopeKind kind)
+{
+    m_scopes.append(make<Scope>(Scope { node, kind, m_current_scope }));
+    m_current_scope = &m_scopes.last();
+}
+
+void ScopeResolver::exit_scope()
+{
+    ASSERT(m_current_scope);
+    m_current_scope = m_current_scope->parent;
+}
+
+void ScopeResolver::declare_variable(const FlyString& name, DeclarationType declaration_type)
+{
+    ASSERT(m_current_scope);
+    auto* scope = m_current_scope;
+    if (declaration_type == DeclarationType::Var) {
+        while (scope && scope->kind != ScopeKind::Function)
+            scope = scope->parent;
+        if (!scope)
+            return;
+    }
+    scope->node.add_variable(name, declaration_type);
+}
+
+void ScopeResolver::add_reference(Identifier& identifier)
+{
+    ASSERT(m_current_scope);
+    m_references.append({ identifier, *m_current_scope });
+}
+
+void ScopeResolver::resolve_references()
+{
+    // This happens after the whole tree has been visited, so a reference
+    // also sees declarations that come after it in the same scope.
+    for (auto& reference : m_references) {
+        size_t depth = 0;
+        for (auto* scope = &reference.scope; scope; scope = scope->parent) {
+            auto index = scope->node.variable_index(reference.identifier.string());
+            if (index.has_value()) {
+                reference.identifier.set_slot(depth, index.value());
+                break;
+            }
+            if (scope->kind == ScopeKind::Function)
+                break;
+            ++depth;
+        }
+    }
+}
+
+size_t ScopeNode::add_variable(const FlyString& name, DeclarationType declaration_type)
+{
+    if (auto index = variable_index(name); index.has_value())
+        return index.value();
+    m_variables.append({ name, declaration_type });
+    m_variable_indices.set(name, m_variables.size() - 1);
+    return m_variables.size() - 1;
+}
+
+void ScopeNode::resolve(ScopeResolver& resolver)
+{
+    resolver.enter_scope(*this);
+    resolve_children(resolver);
+    resolver.exit_scope();
+}
+
+void ScopeNode::resolve_children(ScopeResolver& resolver)
+{
+    for (auto& child : m_children)
+        child.resolve(resolver);
+}
+
+void FunctionNode::resolve_function(ScopeResolver& resolver)
+{
+    resolver.enter_scope(*m_body, ScopeResolver::ScopeKind::Function);
+    for (auto& parameter : m_parameters)
+        resolver.declare_variable(parameter, DeclarationType::Var);
+    m_body->resolve_children(resolver);
+    resolver.exit_scope();
+}
+
+void FunctionDeclaration::resolve(ScopeResolver& resolver)
+{
+    resolve_function(resolver);
+}
+
+void FunctionExpression::resolve(ScopeResolver& resolver)
+{
+    resolve_function(resolver);
+}
+
+void ExpressionStatement::resolve(ScopeResolver& resolver)
+{
+    m_expression->resolve(resolver);
+}
+
+void ReturnStatement::resolve(ScopeResolver& resolver)
+{
+    if (m_argument)
+        m_argument->resolve(resolver);
+}
+
+void IfStatement::resolve(ScopeResolver& resolver)
+{
+    m_predicate->resolve(resolver);
+    m_consequent->resolve(resolver);
+    if (m_alternate)
+        m_alternate->resolve(resolver);
+}
+
+void WhileStatement::resolve(ScopeResolver& resolver)
+{
+    m_predicate->resolve(resolver);
+    m_body->resolve(resolver);
+}
+
+void ForStatement::resolve(ScopeResolver& resolver)
+{
+    if (m_init_scope)
+        resolver.enter_scope(*m_init_scope);
+    if (m_init)
+        m_init->resolve(resolver);
+    if (m_test)
+        m_test->resolve(resolver);
+    if (m_update)
+        m_update->resolve(resolver);
+    m_body->resolve(resolver);
+    if (m_init_scope)
+        resolver.exit_scope();
+}
+
+void BinaryExpression::resolve(ScopeResolver& resolver)
+{
+    m_lhs->resolve(resolver);
+    m_rhs->resolve(resolver);
+}
+
+void LogicalExpression::resolve(ScopeResolver& resolver)
+{
+    m_lhs->resolve(resolver);
+    m_rhs->resolve(resolver);
+}
+
+void UnaryExpression::resolve(ScopeResolver& resolver)
+{
+    m_lhs->resolve(resolver);
+}
+
+void Identifier::resolve(ScopeResolver& resolver)
+{
+    resolver.add_reference(*this);
+}
+
+void CallExpression::resolve(ScopeResolver& resolver)
+{
+    m_callee->resolve(resolver);
+    for (auto& argument : m_arguments)
+        argument.resolve(resolver);
+}
+
+void AssignmentExpression::resolve(ScopeResolver& resolver)
+{
+    m_lhs->resolve(resolver);
+    m_rhs->resolve(resolver);
+}
+
+void UpdateExpression::resolve(ScopeResolver& resolver)
+{
+    m_argument->resolve(resolver);
+}
+
+void VariableDeclaration::resolve(ScopeResolver& resolver)
+{
+    resolver.declare_variable(m_name->string(), m_declaration_type);
+    m_name->resolve(resolver);
+    if (m_initializer)
+        m_initializer->resolve(resolver);
+}
+
+void ObjectExpression::resolve(ScopeResolver& resolver)
+{
+    for (auto& it : m_properties)
+        it.value->resolve(resolver);
+}
+
+void ArrayExpression::resolve(ScopeResolver& resolver)
+{
+    for (auto& element : m_elements)
+        element.resolve(resolver);
+}
+
+void MemberExpression::resolve(ScopeResolver& resolver)
+{
+    m_object->resolve(resolver);
+    // A non-computed property is a name, not a variable reference.
+    if (m_computed)
+        m_property->resolve(resolver);
+}
+
+void CatchClause::resolve(ScopeResolver& resolver)
+{
+    // The catch body's ScopeFrame receives the exception as an argument.
+    resolver.enter_scope(*m_body);
+    resolver.declare_variable(m_parameter, DeclarationType::Let);
+    m_body->resolve_children(resolver);
+    resolver.exit_scope();
+}
+
+void TryStatement::resolve(ScopeResolver& resolver)
+{
+    m_block->resolve(resolver);
+    if (m_handler)
+        m_handler->resolve(resolver);
+    if (m_finalizer)
+        m_finalizer->resolve(resolver);
+}
+
+void ThrowStatement::resolve(ScopeResolver& resolver)
+{
+    m_argument->resolve(resolver);
+}
+
+void SwitchCase::resolve(ScopeResolver& resolver)
+{
+    if (m_test)
+        m_test->resolve(resolver);
+    for (auto& statement : m_consequent)
+        statement.resolve(resolver);
+}
+
+void SwitchStatement::resolve(ScopeResolver& resolver)
+{
+    m_discriminant->resolve(resolver);
+    for (auto& switch_case : m_cases)
+        switch_case.resolve(resolver);
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Vector.h>
+#include <LibJS/Forward.h>
+
+namespace JS {
+
+// Runs once over a freshly parsed Program and gives every variable a slot in
+// the ScopeFrame of the ScopeNode it lives in. Identifiers that refer to one
+// of those variables are annotated with (depth, slot) so the interpreter can
+// access them without a name lookup.
+//
+// Variables are dynamically scoped across function calls, so resolution never
+// crosses a function boundary. Program-level "var" declarations live on the
+// global object and are not given a slot either. Identifiers that can't be
+// resolved fall back to the name lookup at runtime.
+class ScopeResolver {
+public:
+    enum class ScopeKind {
+        Block,
+        Function,
+    };
+
+    static void resolve(Program&);
+
+    void enter_scope(ScopeNode&, ScopeKind = ScopeKind::Block);
+    void exit_scope();
+
+    void declare_variable(const FlyString& name, DeclarationType);
+    void add_reference(Identifier&);
+
+private:
+    ScopeResolver() {}
+
+    void resolve_references();
+
+    struct Scope {
+        ScopeNode& node;
+        ScopeKind kind;
+        Scope* parent;
+    };
+
+    struct Reference {
+        Identifier& identifier;
+        Scope& scope;
+    };
+
+    NonnullOwnPtrVector<Scope> m_scopes;
+    Scope* m_current_scope { nullptr };
+    Vector<Reference> m_references;
+};
+
+}
@@ -0,0 +1,34 @@
+function assert(x) { if (!x) throw 1; }
+
+function sum(n) {
+    var total = 0;
+    for (let i = 0; i < n; ++i) {
+        let i2 = i * 2;
+        total += i2;
+    }
+    return total;
+}
+
+function shadow(a) {
+    let result = a;
+    if (a > 0) {
+        let a = 100;
+        result = result + a;
+    }
+    return result + a;
+}
+
+function update(x) {
+    var y = x + x++;
+    return y * 10 + x;
+}
+
+try {
+    assert(sum(10) === 90);
+    assert(shadow(1) === 102);
+    assert(shadow(-1) === -2);
+    assert(update(3) === 64);
+    console.log("PASS");
+} catch (e) {
+    console.log("FAIL: " + e);
+}
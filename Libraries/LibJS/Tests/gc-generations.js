@@ -0,0 +1,33 @@
+function assert(x) { if (!x) throw 1; }
+
+function churn() {
+    // Allocate enough to cause several young collections.
+    for (var i = 0; i < 10000; ++i) {
+        var garbage = { a: i, b: "x" + i };
+    }
+}
+
+try {
+    var old = { list: [] };
+    churn();
+
+    // These are young cells that are only reachable through old ones.
+    for (var i = 0; i < 100; ++i) {
+        old.list.push({ value: i });
+        old["p" + i] = { value: i * 2 };
+    }
+
+    churn();
+
+    for (var i = 0; i < 100; ++i) {
+        assert(old.list[i].value === i);
+        assert(old["p" + i].value === i * 2);
+    }
+
+    churn();
+    assert(old.list[99].value === 99);
+
+    console.log("PASS");
+} catch (e) {
+    console.log("FAIL: " + e);
+}
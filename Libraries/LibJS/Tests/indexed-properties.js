@@ -0,0 +1,60 @@
+function assert(x) { if (!x) throw 1; }
+
+try {
+    var a = [1, 2, 3];
+    a[5] = 6;
+    assert(a.length === 6);
+    assert(a[3] === undefined);
+    assert(a[5] === 6);
+    assert(a["5"] === 6);
+    assert(a.hasOwnProperty("5"));
+    assert(!a.hasOwnProperty("3"));
+
+    // Names that merely look like numbers are ordinary properties.
+    a["05"] = "x";
+    assert(a["05"] === "x");
+    assert(a[5] === 6);
+    assert(a.length === 6);
+
+    // Huge indices don't allocate all the elements in between.
+    var s = [];
+    s[1000000000] = "far";
+    assert(s.length === 1000000001);
+    assert(s[1000000000] === "far");
+    assert(s[999999999] === undefined);
+    s.push("farther");
+    assert(s[1000000001] === "farther");
+    assert(s.pop() === "farther");
+    assert(s.length === 1000000001);
+
+    var holey = [7];
+    holey[2] = 9;
+    var names = Object.getOwnPropertyNames(holey);
+    assert(names[0] === "0");
+    assert(names[1] === "2");
+
+    // Plain objects have indexed properties too.
+    var o = {};
+    for (var i = 0; i < 100; ++i) {
+        o[i] = i * i;
+    }
+    assert(o[9] === 81);
+    assert(o["99"] === 9801);
+    assert(o.length === undefined);
+
+    var sum = 0;
+    var b = [];
+    for (var i = 0; i < 1000; ++i) {
+        b.push(i);
+    }
+    for (var i = 0; i < b.length; ++i) {
+        sum += b[i];
+    }
+    assert(sum === 499500);
+    assert(b.shift() === 0);
+    assert(b[0] === 1);
+
+    console.log("PASS");
+} catch (e) {
+    console.log("FAIL: " + e);
+}
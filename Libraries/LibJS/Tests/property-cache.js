@@ -0,0 +1,64 @@
+function assert(x) { if (!x) throw 1; }
+
+function getX(o) { return o.x; }
+function setX(o, v) { o.x = v; }
+
+try {
+    // Polymorphic site: more shapes than the cache has entries.
+    var objects = [{ x: 1 }, { a: 0, x: 2 }, { b: 0, x: 3 }, { c: 0, x: 4 }, { d: 0, x: 5 }, { e: 0, x: 6 }];
+    for (var round = 0; round < 3; ++round) {
+        var sum = 0;
+        for (var i = 0; i < objects.length; ++i) {
+            sum = sum + getX(objects[i]);
+        }
+        assert(sum === 21);
+    }
+
+    // Writes that add a property reuse the cached transition.
+    var a = {};
+    var b = {};
+    setX(a, 1);
+    setX(b, 2);
+    assert(a.x === 1);
+    assert(b.x === 2);
+    setX(a, 3);
+    assert(a.x === 3);
+    assert(b.x === 2);
+
+    // Properties found on a prototype, then shadowed or replaced.
+    function Thing() {}
+    Thing.prototype.x = "proto";
+    var t = new Thing();
+    assert(getX(t) === "proto");
+    assert(getX(t) === "proto");
+    Thing.prototype.x = "changed";
+    assert(getX(t) === "changed");
+    t.x = "own";
+    assert(getX(t) === "own");
+    assert(getX(new Thing()) === "changed");
+
+    // Changing the prototype chain further up than the object itself.
+    function getY(o) { return o.y; }
+    var base = { y: "base" };
+    var middle = {};
+    var leaf = {};
+    Object.setPrototypeOf(leaf, middle);
+    assert(getY(leaf) === undefined);
+    Object.setPrototypeOf(middle, base);
+    assert(getY(leaf) === "base");
+    middle.y = "middle";
+    assert(getY(leaf) === "middle");
+
+    // Native properties are still called through the cache.
+    var arr = [1, 2, 3];
+    function length(o) { return o.length; }
+    assert(length(arr) === 3);
+    arr.push(4);
+    assert(length(arr) === 4);
+    assert(length("hello") === 5);
+    assert(length({ length: 7 }) === 7);
+
+    console.log("PASS");
+} catch (e) {
+    console.log("FAIL: " + e);
+}
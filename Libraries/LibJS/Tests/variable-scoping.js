@@ -0,0 +1,68 @@
+function assert(x) { if (!x) throw 1; }
+
+function hoisted() {
+    x = 5;
+    {
+        var x;
+    }
+    return x;
+}
+
+function nested(n) {
+    let a = 1;
+    {
+        let b = 2;
+        {
+            let c = 3;
+            a = a + b + c + n;
+        }
+    }
+    return a;
+}
+
+function caught() {
+    let result = 0;
+    try {
+        throw 7;
+    } catch (e) {
+        {
+            result = e * 2;
+        }
+    }
+    return result;
+}
+
+function loops() {
+    var total = 0;
+    for (let i = 0; i < 3; ++i) {
+        for (let i = 0; i < 2; ++i) {
+            total += 10;
+        }
+        total += i;
+    }
+    return total;
+}
+
+var globalValue = 40;
+function readsGlobal() {
+    return globalValue + 2;
+}
+
+try {
+    assert(hoisted() === 5);
+    assert(nested(4) === 10);
+    assert(caught() === 14);
+    assert(loops() === 63);
+    assert(readsGlobal() === 42);
+
+    let outer = 1;
+    {
+        let inner = outer + 1;
+        outer = inner * 10;
+    }
+    assert(outer === 20);
+
+    console.log("PASS");
+} catch (e) {
+    console.log("FAIL: " + e);
+}
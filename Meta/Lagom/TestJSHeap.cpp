@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Heap/HeapBlock.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/Object.h>
+
+static constexpr size_t benchmark_block_count = 10000;
+static constexpr size_t benchmark_stack_size = 1 * MB;
+
+static JS::Array* fill_heap(JS::Interpreter& interpreter, size_t block_count)
+{
+    auto* array = interpreter.heap().allocate<JS::Array>();
+    interpreter.global_object().put("cells", array);
+    while (interpreter.heap().block_count() < block_count)
+        array->push(interpreter.heap().allocate<JS::Object>());
+    return array;
+}
+
+// Collect garbage with a stack frame full of words that look like they could be heap pointers.
+[[gnu::noinline]] static void collect_garbage_with_big_stack(JS::Heap& heap, FlatPtr pointer_like_base)
+{
+    volatile FlatPtr words[benchmark_stack_size / sizeof(FlatPtr)];
+    for (size_t i = 0; i < benchmark_stack_size / sizeof(FlatPtr); ++i)
+        words[i] = pointer_like_base + i * 72;
+    heap.collect_garbage();
+    (void)words[0];
+}
+
+TEST_CASE(conservative_roots_keep_cells_alive)
+{
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>();
+    auto* object = interpreter->heap().allocate<JS::Object>();
+    object->put("x", JS::Value(42));
+    interpreter->heap().collect_garbage();
+    EXPECT(object->is_live());
+    EXPECT_EQ(object->get("x").value().as_double(), 42);
+}
+
+BENCHMARK_CASE(collect_garbage_with_many_blocks_and_big_stack)
+{
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>();
+    auto* cells = fill_heap(*interpreter, benchmark_block_count);
+    auto* some_cell = cells->indexed_properties().get(0).value().as_cell();
+    for (int round = 0; round < 10; ++round)
+        collect_garbage_with_big_stack(interpreter->heap(), reinterpret_cast<FlatPtr>(some_cell));
+    EXPECT(interpreter->heap().block_count() >= benchmark_block_count);
+
+    auto& statistics = interpreter->heap().full_collection_statistics();
+    fprintf(stderr, "%zu blocks, 10 collections with a %zu KB stack: %llu us average pause\n",
+        interpreter->heap().block_count(), benchmark_stack_size / KB, (unsigned long long)(statistics.total_microseconds / statistics.collections));
+}
+
+BENCHMARK_CASE(allocate_small_objects)
+{
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>();
+    for (size_t i = 0; i < 10'000'000; ++i)
+        interpreter->heap().allocate<JS::Object>();
+    auto& statistics = interpreter->heap().young_collection_statistics();
+    EXPECT(statistics.collections > 0);
+    fprintf(stderr, "10M allocations: %zu young collections, %zu blocks at the end\n", statistics.collections, interpreter->heap().block_count());
+}
+
+TEST_MAIN(JSHeap)
@@ -32,6 +32,7 @@
 #include <LibCore/File.h>
 #include <LibCore/HttpRequest.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -119,7 +120,43 @@ void Client::handle_request(ByteBuffer raw_request)
         return;
     }
 
-    send_response(file->read_all(), request);
+    send_file(*file, request);
+}
+
+void Client::send_file(Core::File& file, const Core::HttpRequest& request)
+{
+    struct stat st;
+    if (fstat(file.fd(), &st) < 0) {
+        perror("fstat");
+        send_error_response(500, "Internal server error, bro!", request);
+        return;
+    }
+
+    StringBuilder builder;
+    builder.append("HTTP/1.0 200 OK\r\n");
+    builder.append("Server: WebServer (SerenityOS)\r\n");
+    builder.append("Content-Type: text/html\r\n");
+    builder.appendf("Content-Length: %d\r\n", st.st_size);
+    builder.append("\r\n");
+
+    // The accepted socket is non-blocking, but we send the whole response before returning to the event loop anyway.
+    m_socket->set_blocking(true);
+    m_socket->write(builder.to_string());
+
+    // Let the kernel move the file into the socket a chunk at a time, instead of reading all of it into memory first.
+    static constexpr off_t chunk_size = 64 * KB;
+    off_t offset = 0;
+    while (offset < st.st_size) {
+        ssize_t nsent = sendfile(m_socket->fd(), file.fd(), &offset, min(chunk_size, st.st_size - offset));
+        if (nsent < 0) {
+            perror("sendfile");
+            break;
+        }
+        if (nsent == 0)
+            break;
+    }
+
+    log_response(200, request);
 }
 
 void Client::send_response(StringView response, const Core::HttpRequest& request)
@@ -37,6 +37,7 @@
 #include <unistd.h>
 
 static bool flag_human_readable = false;
+static bool flag_cache_statistics = false;
 
 struct FileSystem {
     String fs;
@@ -71,6 +72,7 @@ int main(int argc, char** argv)
 {
     Core::ArgsParser args_parser;
     args_parser.add_option(flag_human_readable, "Print human-readable sizes", "human-readable", 'h');
+    args_parser.add_option(flag_cache_statistics, "Print block cache statistics", "cache", 'c');
     args_parser.parse(argc, argv);
 
     auto file = Core::File::construct("/proc/df");
@@ -87,7 +89,7 @@ int main(int argc, char** argv)
 
     auto file_contents = file->read_all();
     auto json = JsonValue::from_string(file_contents).as_array();
-    json.for_each([](auto& value) {
+    json.for_each([](const JsonValue& value) {
         auto fs_object = value.as_object();
         auto fs = fs_object.get("class_name").to_string();
         auto total_block_count = fs_object.get("total_block_count").to_u32();
@@ -114,6 +116,16 @@ int main(int argc, char** argv)
 
         printf("%s", mount_point.characters());
         printf("\n");
+
+        if (flag_cache_statistics && fs_object.has("cache_entry_count")) {
+            printf("          cache: %u entries, %llu hits, %llu misses, %llu evictions, %llu writebacks, %llu read ahead\n",
+                fs_object.get("cache_entry_count").to_u32(),
+                fs_object.get("cache_hits").to_number<u64>(),
+                fs_object.get("cache_misses").to_number<u64>(),
+                fs_object.get("cache_evictions").to_number<u64>(),
+                fs_object.get("cache_writebacks").to_number<u64>(),
+                fs_object.get("cache_read_ahead_blocks").to_number<u64>());
+        }
     });
 
     return 0;
@@ -59,11 +59,12 @@ Result average_result(const Vector<Result>& results)
 
 void exit_with_usage(int rc)
 {
-    fprintf(stderr, "Usage: disk_benchmark [-h] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]\n");
+    fprintf(stderr, "Usage: disk_benchmark [-h] [-c] [-s] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]\n");
     exit(rc);
 }
 
 Result benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache);
+void sequential_read_benchmarks(const String& filename, int file_size, const Vector<int>& block_sizes, int time_per_benchmark, bool allow_cache);
 
 int main(int argc, char** argv)
 {
@@ -72,9 +73,10 @@ int main(int argc, char** argv)
     Vector<int> file_sizes;
     Vector<int> block_sizes;
     bool allow_cache = false;
+    bool sequential_reads = false;
 
     int opt;
-    while ((opt = getopt(argc, argv, "chd:t:f:b:")) != -1) {
+    while ((opt = getopt(argc, argv, "chsd:t:f:b:")) != -1) {
         switch (opt) {
         case 'h':
             exit_with_usage(0);
@@ -82,6 +84,9 @@ int main(int argc, char** argv)
         case 'c':
             allow_cache = true;
             break;
+        case 's':
+            sequential_reads = true;
+            break;
         case 'd':
             directory = strdup(optarg);
             break;
@@ -103,13 +108,24 @@ int main(int argc, char** argv)
         file_sizes = { 131072, 262144, 524288, 1048576, 5242880 };
     }
     if (block_sizes.size() == 0) {
-        block_sizes = { 8192, 32768, 65536 };
+        if (sequential_reads)
+            block_sizes = { 4096, 65536, 1048576 };
+        else
+            block_sizes = { 8192, 32768, 65536 };
     }
 
     umask(0644);
 
     auto filename = String::format("%s/disk_benchmark.tmp", directory);
 
+    if (sequential_reads) {
+        int file_size = 0;
+        for (auto size : file_sizes)
+            file_size = max(file_size, size);
+        sequential_read_benchmarks(filename, file_size, block_sizes, time_per_benchmark, allow_cache);
+        return 0;
+    }
+
     for (auto file_size : file_sizes) {
         for (auto block_size : block_sizes) {
             if (block_size > file_size)
@@ -206,3 +222,76 @@ Result benchmark(const String& filename, int file_size, int block_size, ByteBuff
 
     return res;
 }
+
+// Reads one file from start to end with each of the given read sizes, and reports
+// the throughput of each relative to the first one. With large reads the kernel
+// can turn runs of contiguous blocks into a few large device requests.
+void sequential_read_benchmarks(const String& filename, int file_size, const Vector<int>& block_sizes, int time_per_benchmark, bool allow_cache)
+{
+    int flags = O_RDWR;
+    if (!allow_cache)
+        flags |= O_DIRECT;
+
+    int fd = open(filename.characters(), flags | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("open");
+        exit(1);
+    }
+
+    auto cleanup_and_exit = [fd, filename]() {
+        close(fd);
+        unlink(filename.characters());
+        exit(1);
+    };
+
+    auto write_buffer = ByteBuffer::create_zeroed(65536);
+    for (int nwritten = 0; nwritten < file_size;) {
+        int n = write(fd, write_buffer.data(), min(file_size - nwritten, (int)write_buffer.size()));
+        if (n <= 0) {
+            perror("write");
+            cleanup_and_exit();
+        }
+        nwritten += n;
+    }
+
+    u64 baseline_bps = 0;
+    int baseline_block_size = 0;
+    for (auto block_size : block_sizes) {
+        if (block_size > file_size)
+            continue;
+
+        auto buffer = ByteBuffer::create_uninitialized(block_size);
+
+        printf("Running: sequential reads file_size=%d block_size=%d\n", file_size, block_size);
+        u64 total_bytes = 0;
+        Core::ElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < time_per_benchmark * 1000) {
+            if (lseek(fd, 0, SEEK_SET) < 0) {
+                perror("lseek");
+                cleanup_and_exit();
+            }
+            for (int nread = 0; nread < file_size;) {
+                int n = read(fd, buffer.data(), block_size);
+                if (n <= 0) {
+                    perror("read");
+                    cleanup_and_exit();
+                }
+                nread += n;
+            }
+            total_bytes += file_size;
+            printf(".");
+            fflush(stdout);
+        }
+
+        u64 read_bps = timer.elapsed() ? total_bytes * 1000 / timer.elapsed() : total_bytes * 1000;
+        if (!baseline_bps) {
+            baseline_bps = read_bps;
+            baseline_block_size = block_size;
+        }
+        printf("\nFinished: time=%dms read_bps=%llu (%llu%% of block_size=%d)\n", timer.elapsed(), read_bps, baseline_bps ? read_bps * 100 / baseline_bps : 0, baseline_block_size);
+    }
+
+    close(fd);
+    unlink(filename.characters());
+}
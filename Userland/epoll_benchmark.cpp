@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: epoll_benchmark [-h] [-n idle_sockets] [-r round_trips]\n");
+    exit(rc);
+}
+
+struct PingPong {
+    int to_peer[2];
+    int from_peer[2];
+};
+
+static void* ponger(void* argument)
+{
+    auto& pipes = *reinterpret_cast<PingPong*>(argument);
+    char byte;
+    while (read(pipes.to_peer[0], &byte, 1) == 1) {
+        if (write(pipes.from_peer[1], &byte, 1) != 1)
+            break;
+    }
+    return nullptr;
+}
+
+enum class WaitMethod {
+    Poll,
+    EPoll,
+};
+
+// Bounces a byte off a peer thread, waiting for the reply together with all the idle sockets,
+// the way an event loop would. Returns the average round trip time.
+static float measure_round_trip_us(WaitMethod method, const Vector<int>& idle_fds, int round_trips)
+{
+    PingPong pipes;
+    if (pipe(pipes.to_peer) < 0 || pipe(pipes.from_peer) < 0) {
+        perror("pipe");
+        exit(1);
+    }
+
+    pthread_t peer;
+    if (pthread_create(&peer, nullptr, ponger, &pipes) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+
+    Vector<pollfd> pollfds;
+    int epoll_fd = -1;
+    if (method == WaitMethod::Poll) {
+        for (int fd : idle_fds)
+            pollfds.append({ fd, POLLIN, 0 });
+        pollfds.append({ pipes.from_peer[0], POLLIN, 0 });
+    } else {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            perror("epoll_create1");
+            exit(1);
+        }
+        auto add = [&](int fd) {
+            epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+                perror("epoll_ctl");
+                exit(1);
+            }
+        };
+        for (int fd : idle_fds)
+            add(fd);
+        add(pipes.from_peer[0]);
+    }
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    char byte = 0;
+    for (int i = 0; i < round_trips; ++i) {
+        if (write(pipes.to_peer[1], &byte, 1) != 1) {
+            perror("write");
+            exit(1);
+        }
+        if (method == WaitMethod::Poll) {
+            if (poll(pollfds.data(), pollfds.size(), -1) != 1 || !(pollfds.last().revents & POLLIN)) {
+                perror("poll");
+                exit(1);
+            }
+        } else {
+            epoll_event event;
+            if (epoll_wait(epoll_fd, &event, 1, -1) != 1 || event.data.fd != pipes.from_peer[0]) {
+                perror("epoll_wait");
+                exit(1);
+            }
+        }
+        if (read(pipes.from_peer[0], &byte, 1) != 1) {
+            perror("read");
+            exit(1);
+        }
+    }
+    int ms = timer.elapsed();
+
+    if (epoll_fd >= 0)
+        close(epoll_fd);
+    close(pipes.to_peer[1]);
+    pthread_join(peer, nullptr);
+    close(pipes.to_peer[0]);
+    close(pipes.from_peer[0]);
+    close(pipes.from_peer[1]);
+
+    return (float)ms * 1000 / round_trips;
+}
+
+int main(int argc, char** argv)
+{
+    int idle_socket_count = 1000;
+    int round_trips = 10000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:r:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            idle_socket_count = atoi(optarg);
+            break;
+        case 'r':
+            round_trips = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (idle_socket_count < 0 || round_trips < 1)
+        exit_with_usage(1);
+
+    auto socket_path = String::format("/tmp/epoll_benchmark.%d", getpid());
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_LOCAL;
+    strncpy(address.sun_path, socket_path.characters(), sizeof(address.sun_path) - 1);
+
+    int listen_fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, 16) < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    // The other ends of the idle sockets live in a child process, so that we can have as many as our fd table allows.
+    pid_t acceptor = fork();
+    if (acceptor < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (acceptor == 0) {
+        for (;;) {
+            if (accept(listen_fd, nullptr, nullptr) < 0) {
+                perror("accept");
+                return 1;
+            }
+        }
+    }
+    close(listen_fd);
+
+    printf("idle sockets  poll round trip  epoll round trip\n");
+
+    // With poll() the cost of every wakeup grows with the number of idle sockets, with epoll it shouldn't.
+    Vector<int> idle_fds;
+    for (int target = 0;; target = min(target ? target * 10 : 10, idle_socket_count)) {
+        while (idle_fds.size() < (size_t)target) {
+            int fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+            if (fd < 0 || connect(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+                perror("connect");
+                kill(acceptor, SIGTERM);
+                return 1;
+            }
+            idle_fds.append(fd);
+        }
+        float poll_us = measure_round_trip_us(WaitMethod::Poll, idle_fds, round_trips);
+        float epoll_us = measure_round_trip_us(WaitMethod::EPoll, idle_fds, round_trips);
+        printf("%12d  %12.2f us  %13.2f us\n", (int)idle_fds.size(), poll_us, epoll_us);
+        if (target == idle_socket_count)
+            break;
+    }
+
+    kill(acceptor, SIGTERM);
+    waitpid(acceptor, nullptr, 0);
+    unlink(socket_path.characters());
+    return 0;
+}
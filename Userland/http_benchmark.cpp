@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/ProcessStatisticsReader.h>
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: http_benchmark [-h] [-a address] [-p port] [-n requests] [-s server_name] [path]\n");
+    exit(rc);
+}
+
+// Returns the number of bytes received, or -1 on failure.
+static ssize_t fetch(const sockaddr_in& address, const String& request)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (connect(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+    if (write(fd, request.characters(), request.length()) != (ssize_t)request.length()) {
+        perror("write");
+        close(fd);
+        return -1;
+    }
+
+    static char buffer[64 * KB];
+    ssize_t total = 0;
+    for (;;) {
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            close(fd);
+            return -1;
+        }
+        if (nread == 0)
+            break;
+        total += nread;
+    }
+    close(fd);
+    return total;
+}
+
+static size_t resident_size_of(const String& process_name)
+{
+    size_t resident = 0;
+    for (auto& it : Core::ProcessStatisticsReader::get_all()) {
+        if (it.value.name == process_name)
+            resident += it.value.amount_resident;
+    }
+    return resident;
+}
+
+int main(int argc, char** argv)
+{
+    const char* address_string = "127.0.0.1";
+    int port = 8000;
+    int request_count = 100;
+    const char* server_name = "WebServer";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ha:p:n:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'a':
+            address_string = optarg;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'n':
+            request_count = atoi(optarg);
+            break;
+        case 's':
+            server_name = optarg;
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (request_count < 1 || port <= 0 || port > 65535)
+        exit_with_usage(1);
+
+    const char* path = optind < argc ? argv[optind] : "/";
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, address_string, &address.sin_addr) <= 0) {
+        fprintf(stderr, "Invalid address '%s'\n", address_string);
+        return 1;
+    }
+
+    auto request = String::format("GET %s HTTP/1.0\r\n\r\n", path);
+
+    size_t resident_before = resident_size_of(server_name);
+    size_t peak_resident = resident_before;
+    u64 total_bytes = 0;
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < request_count; ++i) {
+        ssize_t nreceived = fetch(address, request);
+        if (nreceived < 0)
+            return 1;
+        total_bytes += nreceived;
+        // Reading /proc/all is expensive, so only sample the server now and then.
+        if (i % 16 == 0)
+            peak_resident = max(peak_resident, resident_size_of(server_name));
+    }
+    int ms = max(timer.elapsed(), 1);
+    peak_resident = max(peak_resident, resident_size_of(server_name));
+
+    printf("%d requests for %s in %d ms\n", request_count, path, ms);
+    printf("%d requests/s, %d KiB/s\n", (int)((u64)request_count * 1000 / ms), (int)(total_bytes * 1000 / ms / KB));
+    printf("%s resident: %d KiB before, %d KiB peak\n", server_name, (int)(resident_before / KB), (int)(peak_resident / KB));
+    return 0;
+}
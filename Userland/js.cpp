@@ -43,6 +43,7 @@
 #include <LibJS/Runtime/Value.h>
 #include <LibLine/Editor.h>
 #include <stdio.h>
+#include <time.h>
 
 class ReplObject : public JS::GlobalObject {
 public:
@@ -101,12 +102,29 @@ static void print_value(JS::Value value, HashTable<JS::Object*>& seen_objects);
 
 static void print_array(const JS::Array& array, HashTable<JS::Object*>& seen_objects)
 {
-    fputs("[ ", stdout);
-    for (size_t i = 0; i < array.elements().size(); ++i) {
-        print_value(array.elements()[i], seen_objects);
-        if (i != array.elements().size() - 1)
+    auto& elements = array.indexed_properties();
+    bool first = true;
+    auto print_separator = [&] {
+        if (!first)
             fputs(", ", stdout);
+        first = false;
+    };
+    size_t next_index = 0;
+    auto print_holes_up_to = [&](size_t index) {
+        if (index == next_index)
+            return;
+        print_separator();
+        printf("<%zu empty item%s>", index - next_index, index - next_index == 1 ? "" : "s");
+    };
+
+    fputs("[ ", stdout);
+    for (auto index : elements.indices()) {
+        print_holes_up_to(index);
+        print_separator();
+        print_value(elements.get(index).value(), seen_objects);
+        next_index = index + 1;
     }
+    print_holes_up_to(elements.array_like_size());
     fputs(" ]", stdout);
 }
 
@@ -290,32 +308,73 @@ void repl(JS::Interpreter& interpreter)
     }
 }
 
+static void print_property_cache_statistics(JS::Interpreter& interpreter)
+{
+    auto& statistics = interpreter.property_cache_statistics();
+    auto print_line = [](const char* name, size_t hits, size_t misses) {
+        size_t total = hits + misses;
+        fprintf(stderr, "%s: %zu hits, %zu misses (%.1f%% hit rate)\n", name, hits, misses, total ? 100.0 * hits / total : 0.0);
+    };
+    print_line("Property cache gets", statistics.get_hits, statistics.get_misses);
+    print_line("Property cache puts", statistics.put_hits, statistics.put_misses);
+}
+
+static void print_gc_statistics(JS::Interpreter& interpreter)
+{
+    auto print_line = [](const char* name, const JS::Heap::PauseStatistics& statistics) {
+        unsigned long long average = statistics.collections ? statistics.total_microseconds / statistics.collections : 0;
+        fprintf(stderr, "%s: %zu collections, %llu us total, %llu us max, %llu us average\n", name, statistics.collections, (unsigned long long)statistics.total_microseconds, (unsigned long long)statistics.max_microseconds, average);
+    };
+    print_line("Young GC pauses", interpreter.heap().young_collection_statistics());
+    print_line("Full GC pauses", interpreter.heap().full_collection_statistics());
+}
+
+static u64 current_time_in_microseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void print_parse_statistics(size_t source_length, u64 parse_microseconds, const JS::ASTArena& arena)
+{
+    double megabytes = (double)source_length / MB;
+    double seconds = (double)parse_microseconds / 1000000;
+    fprintf(stderr, "Parsed %zu bytes in %llu us (%.2f MB/s)\n", source_length, (unsigned long long)parse_microseconds, seconds > 0 ? megabytes / seconds : 0);
+    fprintf(stderr, "AST: %zu bytes in %zu arena chunks\n", arena.bytes_allocated(), arena.chunk_count());
+}
+
 int main(int argc, char** argv)
 {
     bool gc_on_every_allocation = false;
+    bool use_bytecode = false;
+    bool print_property_cache_stats = false;
     bool print_last_result = false;
+    bool parse_only = false;
+    bool print_timing = false;
     const char* script_path = nullptr;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(dump_ast, "Dump the AST", "dump-ast", 'A');
     args_parser.add_option(print_last_result, "Print last result", "print-last-result", 'l');
-    args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(gc_on_every_allocation, "GC on every allocation and print GC pause statistics", "gc-on-every-allocation", 'g');
+    args_parser.add_option(use_bytecode, "Run with the bytecode interpreter", "bytecode", 'b');
+    args_parser.add_option(print_property_cache_stats, "Print property cache statistics after running the script", "property-cache-stats", 's');
+    args_parser.add_option(parse_only, "Only parse the script, don't run it", "parse-only", 'p');
+    args_parser.add_option(print_timing, "Print parse throughput and run time", "time", 't');
     args_parser.add_positional_argument(script_path, "Path to script file", "script", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
     if (script_path == nullptr) {
         auto interpreter = JS::Interpreter::create<ReplObject>();
         interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        interpreter->set_bytecode_enabled(use_bytecode);
         interpreter->global_object().put("global", &interpreter->global_object());
 
         editor = make<Line::Editor>();
         editor->initialize();
         repl(*interpreter);
     } else {
-        auto interpreter = JS::Interpreter::create<JS::GlobalObject>();
-        interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
-        interpreter->global_object().put("global", &interpreter->global_object());
-
         auto file = Core::File::construct(script_path);
         if (!file->open(Core::IODevice::ReadOnly)) {
             fprintf(stderr, "Failed to open %s: %s\n", script_path, file->error_string());
@@ -329,12 +388,30 @@ int main(int argc, char** argv)
         } else {
             source = file_contents;
         }
-        auto program = JS::Parser(JS::Lexer(source)).parse_program();
+
+        JS::Parser parser { JS::Lexer(source) };
+        auto parse_start = current_time_in_microseconds();
+        auto program = parser.parse_program();
+        auto parse_microseconds = current_time_in_microseconds() - parse_start;
+
+        if (print_timing)
+            print_parse_statistics(source.length(), parse_microseconds, parser.arena());
 
         if (dump_ast)
             program->dump(0);
 
+        if (parse_only)
+            return parser.has_errors() ? 1 : 0;
+
+        auto interpreter = JS::Interpreter::create<JS::GlobalObject>();
+        interpreter->heap().set_should_collect_on_every_allocation(gc_on_every_allocation);
+        interpreter->set_bytecode_enabled(use_bytecode);
+        interpreter->global_object().put("global", &interpreter->global_object());
+
+        auto run_start = current_time_in_microseconds();
         auto result = interpreter->run(*program);
+        if (print_timing)
+            fprintf(stderr, "Ran in %llu us\n", (unsigned long long)(current_time_in_microseconds() - run_start));
 
         if (interpreter->exception()) {
             printf("Uncaught exception: ");
@@ -343,6 +420,11 @@ int main(int argc, char** argv)
         } else if (print_last_result) {
             printf("%s\n", result.to_string().characters());
         }
+
+        if (print_property_cache_stats)
+            print_property_cache_statistics(*interpreter);
+        if (gc_on_every_allocation)
+            print_gc_statistics(*interpreter);
     }
 
     return 0;
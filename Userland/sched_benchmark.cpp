@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: sched_benchmark [-h] [-n sleeping_threads] [-r round_trips]\n");
+    exit(rc);
+}
+
+static void* sleeper(void*)
+{
+    for (;;)
+        sleep(3600);
+    return nullptr;
+}
+
+struct PingPong {
+    int to_peer[2];
+    int from_peer[2];
+};
+
+static void* ponger(void* argument)
+{
+    auto& pipes = *reinterpret_cast<PingPong*>(argument);
+    char byte;
+    while (read(pipes.to_peer[0], &byte, 1) == 1) {
+        if (write(pipes.from_peer[1], &byte, 1) != 1)
+            break;
+    }
+    return nullptr;
+}
+
+// Bounces a byte between two threads through a pair of pipes. Every round trip
+// blocks and wakes each thread once, i.e. costs two context switches.
+static float measure_switch_latency_us(int round_trips)
+{
+    PingPong pipes;
+    if (pipe(pipes.to_peer) < 0 || pipe(pipes.from_peer) < 0) {
+        perror("pipe");
+        exit(1);
+    }
+
+    pthread_t peer;
+    if (pthread_create(&peer, nullptr, ponger, &pipes) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    char byte = 0;
+    for (int i = 0; i < round_trips; ++i) {
+        if (write(pipes.to_peer[1], &byte, 1) != 1 || read(pipes.from_peer[0], &byte, 1) != 1) {
+            perror("ping");
+            exit(1);
+        }
+    }
+    int ms = timer.elapsed();
+
+    close(pipes.to_peer[1]);
+    pthread_join(peer, nullptr);
+    close(pipes.to_peer[0]);
+    close(pipes.from_peer[0]);
+    close(pipes.from_peer[1]);
+
+    return (float)ms * 1000 / (round_trips * 2);
+}
+
+int main(int argc, char** argv)
+{
+    int sleeping_thread_count = 1000;
+    int round_trips = 10000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:r:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            sleeping_thread_count = atoi(optarg);
+            break;
+        case 'r':
+            round_trips = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (sleeping_thread_count < 0 || round_trips < 1)
+        exit_with_usage(1);
+
+    printf("sleepers  switch latency\n");
+    printf("%8d  %8.2f us\n", 0, measure_switch_latency_us(round_trips));
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, PTHREAD_STACK_MIN);
+
+    // Sleeping threads are never runnable, so with a scheduler that only looks at
+    // runnable threads the latency should not change as more of them are added.
+    int spawned = 0;
+    for (int target = 10; spawned < sleeping_thread_count; target *= 10) {
+        if (target > sleeping_thread_count)
+            target = sleeping_thread_count;
+        for (; spawned < target; ++spawned) {
+            pthread_t thread;
+            if (pthread_create(&thread, &attributes, sleeper, nullptr) != 0) {
+                perror("pthread_create");
+                exit(1);
+            }
+        }
+        printf("%8d  %8.2f us\n", spawned, measure_switch_latency_us(round_trips));
+    }
+
+    pthread_attr_destroy(&attributes);
+
+    // Exiting the process takes the sleeping threads down with it.
+    return 0;
+}
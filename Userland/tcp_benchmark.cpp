@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: tcp_benchmark [-h] [-p port] [-s size_in_MiB] [-b write_size_in_KiB]\n");
+    exit(rc);
+}
+
+// Connects to the receiver and writes total_size bytes in write_size chunks.
+static int send_data(const sockaddr_in& address, size_t total_size, size_t write_size)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    if (connect(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        return 1;
+    }
+
+    auto* buffer = (u8*)malloc(write_size);
+    for (size_t i = 0; i < write_size; ++i)
+        buffer[i] = i;
+
+    size_t total_sent = 0;
+    while (total_sent < total_size) {
+        size_t offset = total_sent % write_size;
+        ssize_t nwritten = write(fd, buffer + offset, min(write_size - offset, total_size - total_sent));
+        if (nwritten < 0) {
+            perror("write");
+            return 1;
+        }
+        total_sent += nwritten;
+    }
+    free(buffer);
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int port = 8001;
+    int size_in_mib = 64;
+    int write_size_in_kib = 64;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hp:s:b:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 's':
+            size_in_mib = atoi(optarg);
+            break;
+        case 'b':
+            write_size_in_kib = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (port <= 0 || port > 65535 || size_in_mib < 1 || write_size_in_kib < 1)
+        exit_with_usage(1);
+
+    size_t total_size = (size_t)size_in_mib * MB;
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    if (listen(listen_fd, 1) < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    pid_t sender_pid = fork();
+    if (sender_pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (sender_pid == 0) {
+        close(listen_fd);
+        return send_data(address, total_size, (size_t)write_size_in_kib * KB);
+    }
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        perror("accept");
+        return 1;
+    }
+    close(listen_fd);
+
+    static u8 buffer[64 * KB];
+    size_t total_received = 0;
+    bool corrupted = false;
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (;;) {
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            return 1;
+        }
+        if (nread == 0)
+            break;
+        // The sender writes the same buffer over and over, and every byte in it holds its own offset.
+        for (ssize_t i = 0; i < nread && !corrupted; ++i) {
+            if (buffer[i] != (u8)((total_received + i) % ((size_t)write_size_in_kib * KB)))
+                corrupted = true;
+        }
+        total_received += nread;
+    }
+    int ms = max(timer.elapsed(), 1);
+    close(fd);
+
+    int status = 0;
+    waitpid(sender_pid, &status, 0);
+
+    u64 kib_per_second = (u64)total_received * 1000 / ms / KB;
+    printf("%d KiB over loopback in %d ms, %d.%02d MiB/s\n", (int)(total_received / KB), ms, (int)(kib_per_second / KB), (int)(kib_per_second % KB * 100 / KB));
+    if (total_received != total_size || corrupted) {
+        fprintf(stderr, "Received %u bytes%s, expected %u\n", (u32)total_received, corrupted ? " with corruption" : "", (u32)total_size);
+        return 1;
+    }
+    return WEXITSTATUS(status);
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// A process can't have enough file descriptors open for thousands of connections (two each),
+// so they're spread over several worker processes.
+static const int connections_per_worker = 250;
+
+struct WorkerResult {
+    int packets;
+    int failed;
+};
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: tcp_connection_benchmark [-h] [-c connection_count] [-n round_trips] [-p first_port]\n");
+    exit(rc);
+}
+
+static bool write_byte(int fd)
+{
+    u8 byte = 0;
+    return write(fd, &byte, 1) == 1;
+}
+
+static bool read_byte(int fd)
+{
+    u8 byte;
+    return read(fd, &byte, 1) == 1;
+}
+
+// Opens connection_count connections to itself, waits for the other workers to do the same,
+// and then sends a byte back and forth over each connection in turn, round_trips times.
+static WorkerResult run_worker(int port, int connection_count, int round_trips, int ready_fd, int start_fd)
+{
+    WorkerResult result { 0, 0 };
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, 16) < 0) {
+        perror("listen");
+        result.failed = 1;
+        write_byte(ready_fd);
+        return result;
+    }
+
+    Vector<int> client_fds;
+    Vector<int> server_fds;
+    for (int i = 0; i < connection_count; ++i) {
+        int client_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (client_fd < 0 || connect(client_fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+            perror("connect");
+            result.failed = 1;
+            break;
+        }
+        int server_fd = accept(listen_fd, nullptr, nullptr);
+        if (server_fd < 0) {
+            perror("accept");
+            result.failed = 1;
+            break;
+        }
+        client_fds.append(client_fd);
+        server_fds.append(server_fd);
+    }
+
+    write_byte(ready_fd);
+    // The parent closes its end of the pipe once everyone is ready.
+    read_byte(start_fd);
+    if (result.failed)
+        return result;
+
+    for (int round = 0; round < round_trips; ++round) {
+        for (size_t i = 0; i < client_fds.size(); ++i) {
+            if (!write_byte(client_fds[i]) || !read_byte(server_fds[i]) || !write_byte(server_fds[i]) || !read_byte(client_fds[i])) {
+                perror("round trip");
+                result.failed = 1;
+                return result;
+            }
+            result.packets += 2;
+        }
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int connection_count = 5000;
+    int round_trips = 10;
+    int first_port = 9000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hc:n:p:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'c':
+            connection_count = atoi(optarg);
+            break;
+        case 'n':
+            round_trips = atoi(optarg);
+            break;
+        case 'p':
+            first_port = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    int worker_count = (connection_count + connections_per_worker - 1) / connections_per_worker;
+    if (connection_count < 1 || round_trips < 1 || first_port <= 0 || first_port + worker_count > 65536)
+        exit_with_usage(1);
+
+    int ready_pipe[2];
+    int start_pipe[2];
+    int result_pipe[2];
+    if (pipe(ready_pipe) < 0 || pipe(start_pipe) < 0 || pipe(result_pipe) < 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    Core::ElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < worker_count; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            close(ready_pipe[0]);
+            close(start_pipe[1]);
+            close(result_pipe[0]);
+            int count = min(connections_per_worker, connection_count - i * connections_per_worker);
+            auto result = run_worker(first_port + i, count, round_trips, ready_pipe[1], start_pipe[0]);
+            write(result_pipe[1], &result, sizeof(result));
+            // Exiting closes all the connections at once.
+            return result.failed;
+        }
+    }
+    close(ready_pipe[1]);
+    close(start_pipe[0]);
+    close(result_pipe[1]);
+
+    for (int i = 0; i < worker_count; ++i) {
+        if (!read_byte(ready_pipe[0])) {
+            fprintf(stderr, "A worker went away while connecting\n");
+            return 1;
+        }
+    }
+    int setup_ms = max(timer.elapsed(), 1);
+
+    timer.start();
+    close(start_pipe[1]);
+
+    int packets = 0;
+    int failed_workers = 0;
+    for (int i = 0; i < worker_count; ++i) {
+        WorkerResult result;
+        if (read(result_pipe[0], &result, sizeof(result)) != sizeof(result)) {
+            ++failed_workers;
+            continue;
+        }
+        packets += result.packets;
+        failed_workers += result.failed;
+    }
+    int ms = max(timer.elapsed(), 1);
+
+    for (int i = 0; i < worker_count; ++i)
+        wait(nullptr);
+
+    printf("Opened %d connections in %d ms\n", connection_count, setup_ms);
+    printf("%d packets in %d ms, %d us per packet\n", packets, ms, packets ? (int)((u64)ms * 1000 / packets) : 0);
+    if (failed_workers) {
+        printf("%d of %d workers failed\n", failed_workers, worker_count);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <LibCore/ElapsedTimer.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: udp_benchmark [-h] [-r] [-p port] [-c packet_count] [-b packet_size]\n");
+    exit(rc);
+}
+
+// Sends packet_count datagrams of packet_size bytes to the receiver as fast as it can.
+static int send_packets(const sockaddr_in& address, int packet_count, size_t packet_size)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    auto* buffer = (u8*)calloc(packet_size, 1);
+    for (int i = 0; i < packet_count; ++i) {
+        if (sendto(fd, buffer, packet_size, 0, (const sockaddr*)&address, sizeof(address)) < 0) {
+            perror("sendto");
+            return 1;
+        }
+    }
+    free(buffer);
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    bool receive_only = false;
+    int port = 8002;
+    int packet_count = 100000;
+    int packet_size = 64;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hrp:c:b:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'r':
+            receive_only = true;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'c':
+            packet_count = atoi(optarg);
+            break;
+        case 'b':
+            packet_size = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (port <= 0 || port > 65535 || packet_count < 1 || packet_size < 1 || packet_size > 65507)
+        exit_with_usage(1);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    // With -r, the packets come from outside (e.g. from the host through QEMU's port forwarding).
+    address.sin_addr.s_addr = htonl(receive_only ? INADDR_ANY : INADDR_LOOPBACK);
+    if (bind(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    pid_t sender_pid = 0;
+    if (!receive_only) {
+        sender_pid = fork();
+        if (sender_pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (sender_pid == 0) {
+            close(fd);
+            return send_packets(address, packet_count, packet_size);
+        }
+    }
+
+    static u8 buffer[64 * KB];
+    int packets_received = 0;
+    Core::ElapsedTimer timer;
+    int ms = 0;
+
+    // Packets can get dropped, so we're done once nothing has come in for a second.
+    for (;;) {
+        ssize_t nread = recv(fd, buffer, sizeof(buffer), 0);
+        if (nread < 0) {
+            if (errno == EAGAIN)
+                break;
+            perror("recv");
+            return 1;
+        }
+        if (!packets_received++) {
+            timer.start();
+            timeval timeout { 1, 0 };
+            if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+                perror("setsockopt");
+                return 1;
+            }
+        }
+        ms = timer.elapsed();
+        if (!receive_only && packets_received == packet_count)
+            break;
+    }
+    close(fd);
+    ms = max(ms, 1);
+
+    int status = 0;
+    if (sender_pid)
+        waitpid(sender_pid, &status, 0);
+
+    printf("%d packets of %d bytes in %d ms, %d packets/s\n", packets_received, packet_size, ms, (int)((u64)packets_received * 1000 / ms));
+    if (!receive_only && packets_received != packet_count)
+        printf("%d packets were dropped\n", packet_count - packets_received);
+    return WEXITSTATUS(status);
+}